@@ -0,0 +1,40 @@
+#ifndef LT_BENCH_H
+#define LT_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace lt::bench
+{
+
+/* Calls `f` until at least `minSeconds` have elapsed and returns the
+ * average seconds per call. */
+template <typename F> double timePerCall(F && f, double minSeconds = 0.25)
+{
+    using Clock = std::chrono::steady_clock;
+    // Warm up caches and lazily built tables
+    f();
+
+    std::size_t calls = 0;
+    Clock::time_point start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do
+    {
+        f();
+        ++calls;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < minSeconds);
+    return elapsed.count() / static_cast<double>(calls);
+}
+
+inline volatile uint64_t sink{0};
+
+// Keeps the compiler from discarding a computed value
+template <typename T> inline void keep(T value)
+{
+    sink = static_cast<uint64_t>(value);
+}
+
+} // namespace lt::bench
+
+#endif // LT_BENCH_H
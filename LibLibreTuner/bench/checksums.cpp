@@ -0,0 +1,63 @@
+#include "bench.h"
+
+#include "definition/checksum.h"
+#include "support/crc32.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+// Region sizes, from a small calibration block to a whole ROM
+constexpr int sizes[] = {4 * 1024, 64 * 1024, 1024 * 1024};
+
+const char * const algorithms[] = {"basic", "add16", "xor", "crc32",
+                                   "crc16-ccitt"};
+
+void report(const std::string & name, int size, double seconds)
+{
+    std::printf("%-24s %8d B %10.1f MB/s\n", name.c_str(), size,
+                size / seconds / 1e6);
+}
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(1);
+    std::vector<uint8_t> data(sizes[std::size(sizes) - 1]);
+    for (uint8_t & byte : data)
+        byte = static_cast<uint8_t>(rng());
+
+    for (int size : sizes)
+    {
+        report("crc32 (slicing-by-8)", size, bench::timePerCall([&] {
+                   bench::keep(crc32Slicing(data.data(), size));
+               }));
+        report("crc32 (dispatched)", size, bench::timePerCall([&] {
+                   bench::keep(crc32(data.data(), size));
+               }));
+
+        for (const char * algorithm : algorithms)
+        {
+            ChecksumPtr checksum =
+                ChecksumRegistry::instance().create(algorithm, 0, size, 0);
+            report(std::string(algorithm) + " compute", size,
+                   bench::timePerCall([&] {
+                       bench::keep(checksum->compute(data.data(), size));
+                   }));
+
+            // The last word is free to hold the correction
+            checksum->addModifiable(size - 4, 4);
+            report(std::string(algorithm) + " correct", size,
+                   bench::timePerCall(
+                       [&] { checksum->correct(data.data(), size); }));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
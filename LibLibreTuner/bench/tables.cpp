@@ -0,0 +1,158 @@
+#include "bench.h"
+
+#include "buffer/memorybuffer.h"
+#include "buffer/view.h"
+#include "rom/table.h"
+#include "rom/typedtable.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace lt;
+
+namespace
+{
+constexpr int table_count = 500;
+// Entries per table, e.g. a 16x16 map
+constexpr int table_entries = 256;
+
+struct TableInfo
+{
+    DataType type;
+    int offset;
+    int byteSize;
+};
+
+int entrySize(DataType type)
+{
+    switch (type)
+    {
+    case DataType::Uint8:
+    case DataType::Int8:
+        return 1;
+    case DataType::Uint16:
+    case DataType::Int16:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+void report(const char * name, double seconds)
+{
+    std::printf("%-28s %8.3f ms/pass %8.2f ns/entry\n", name, seconds * 1e3,
+                seconds * 1e9 / (table_count * table_entries));
+}
+} // namespace
+
+/* Reads and scales, then writes, every entry of hundreds of big endian
+ * tables of mixed types through the virtual per-entry Entries interface,
+ * its readAll()/writeAll() and visitTable(). */
+int main()
+{
+    const DataType types[] = {DataType::Uint8,  DataType::Uint16,
+                              DataType::Int16,  DataType::Uint32,
+                              DataType::Float};
+    std::mt19937 rng(1);
+
+    std::vector<TableInfo> infos;
+    int offset = 0;
+    for (int i = 0; i < table_count; ++i)
+    {
+        DataType type = types[rng() % std::size(types)];
+        int byteSize = table_entries * entrySize(type);
+        infos.push_back({type, offset, byteSize});
+        offset += byteSize;
+    }
+
+    // A MemoryBuffer view may not end at the last byte
+    std::vector<uint8_t> image(static_cast<std::size_t>(offset) + 1);
+    for (uint8_t & byte : image)
+        byte = static_cast<uint8_t>(rng());
+    // Keep floats finite
+    for (const TableInfo & info : infos)
+    {
+        if (info.type == DataType::Float)
+            std::fill_n(image.begin() + info.offset, info.byteSize, 0x3F);
+    }
+    MemoryBuffer buffer(std::move(image));
+
+    std::vector<EntriesPtr<double>> entries;
+    for (const TableInfo & info : infos)
+        entries.push_back(create_entries<double, Endianness::Big>(
+            info.type, View(buffer, info.offset, info.byteSize)));
+
+    const double scale = 0.5;
+    std::vector<double> values(table_entries);
+
+    report("Entries::get()", bench::timePerCall([&] {
+               double sum = 0;
+               for (const EntriesPtr<double> & table : entries)
+               {
+                   for (int i = 0; i < table->size(); ++i)
+                       sum += table->get(i) * scale;
+               }
+               bench::keep(sum);
+           }));
+
+    report("Entries::readAll()", bench::timePerCall([&] {
+               double sum = 0;
+               for (const EntriesPtr<double> & table : entries)
+               {
+                   table->readAll(values);
+                   for (double value : values)
+                       sum += value * scale;
+               }
+               bench::keep(sum);
+           }));
+
+    report("visitTable()", bench::timePerCall([&] {
+               double sum = 0;
+               for (const TableInfo & info : infos)
+               {
+                   visitTable(info.type, Endianness::Big,
+                              View(buffer, info.offset, info.byteSize),
+                              [&](auto table) {
+                                  for (int i = 0; i < table.size(); ++i)
+                                      sum += static_cast<double>(table.get(i)) *
+                                             scale;
+                              });
+               }
+               bench::keep(sum);
+           }));
+
+    // Writes store the same small values, which fit every type
+    std::vector<double> source(table_entries);
+    for (int i = 0; i < table_entries; ++i)
+        source[i] = i % 100;
+
+    report("Entries::set()", bench::timePerCall([&] {
+               for (const EntriesPtr<double> & table : entries)
+               {
+                   for (int i = 0; i < table->size(); ++i)
+                       table->set(i, source[i]);
+               }
+           }));
+
+    report("Entries::writeAll()", bench::timePerCall([&] {
+               for (const EntriesPtr<double> & table : entries)
+                   table->writeAll(source);
+           }));
+
+    report("visitTable() set", bench::timePerCall([&] {
+               for (const TableInfo & info : infos)
+               {
+                   visitTable(info.type, Endianness::Big,
+                              View(buffer, info.offset, info.byteSize),
+                              [&](auto table) {
+                                  using Table = decltype(table);
+                                  using T = typename Table::value_type;
+                                  for (int i = 0; i < table.size(); ++i)
+                                      table.set(i, static_cast<T>(source[i]));
+                              });
+               }
+           }));
+    return 0;
+}
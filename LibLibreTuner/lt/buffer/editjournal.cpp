@@ -0,0 +1,91 @@
+#include "editjournal.h"
+
+#include <cassert>
+
+namespace lt
+{
+
+void EditJournal::record(std::size_t offset, std::span<const uint8_t> before, std::span<const uint8_t> after)
+{
+    assert(before.size() == after.size());
+
+    // A new edit ends the redo history
+    if (cursor_ != edits_.size())
+    {
+        pool_.resize(edits_[cursor_].data);
+        edits_.resize(cursor_);
+    }
+
+    std::size_t group = depth_ != 0 ? openGroup_ : nextGroup_++;
+    edits_.push_back(Edit{offset, before.size(), pool_.size(), group});
+    pool_.insert(pool_.end(), before.begin(), before.end());
+    pool_.insert(pool_.end(), after.begin(), after.end());
+    cursor_ = edits_.size();
+}
+
+void EditJournal::beginGroup() noexcept
+{
+    if (depth_++ == 0)
+        openGroup_ = nextGroup_++;
+}
+
+void EditJournal::endGroup() noexcept
+{
+    assert(depth_ > 0);
+    --depth_;
+}
+
+std::span<const EditJournal::Edit> EditJournal::undo() noexcept
+{
+    if (cursor_ == 0)
+        return {};
+
+    std::size_t last = cursor_;
+    std::size_t group = edits_[last - 1].group;
+    while (cursor_ != 0 && edits_[cursor_ - 1].group == group)
+        --cursor_;
+    return std::span<const Edit>(edits_).subspan(cursor_, last - cursor_);
+}
+
+std::span<const EditJournal::Edit> EditJournal::redo() noexcept
+{
+    if (cursor_ == edits_.size())
+        return {};
+
+    std::size_t first = cursor_;
+    std::size_t group = edits_[first].group;
+    while (cursor_ != edits_.size() && edits_[cursor_].group == group)
+        ++cursor_;
+    return std::span<const Edit>(edits_).subspan(first, cursor_ - first);
+}
+
+std::span<const uint8_t> EditJournal::before(const Edit & edit) const noexcept
+{
+    return std::span<const uint8_t>(pool_).subspan(edit.data, edit.size);
+}
+
+std::span<const uint8_t> EditJournal::after(const Edit & edit) const noexcept
+{
+    return std::span<const uint8_t>(pool_).subspan(edit.data + edit.size, edit.size);
+}
+
+std::size_t EditJournal::revision() const noexcept
+{
+    // Group ids are never reused, so the last applied group is unique
+    return cursor_ != 0 ? edits_[cursor_ - 1].group : baseRevision_;
+}
+
+void EditJournal::clear() noexcept
+{
+    baseRevision_ = revision();
+    edits_.clear();
+    pool_.clear();
+    cursor_ = 0;
+}
+
+std::size_t EditJournal::memoryUsage() const noexcept
+{
+    return edits_.capacity() * sizeof(Edit) + pool_.capacity();
+}
+
+} // namespace lt
@@ -0,0 +1,77 @@
+#ifndef LT_EDITJOURNAL_H
+#define LT_EDITJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lt
+{
+
+/* Undo/redo history of writes to a byte range. Each edit stores the bytes
+ * before and after the write back to back in one pool, so the history
+ * costs twice the amount of bytes written plus a small record per edit.
+ *
+ * Edits made between beginGroup() and endGroup() are undone and redone as
+ * one step. */
+class EditJournal
+{
+public:
+    struct Edit
+    {
+        std::size_t offset;
+        std::size_t size;
+        // Position of the old bytes in the pool. The new bytes follow.
+        std::size_t data;
+        // Edits of the same group are undone together
+        std::size_t group;
+    };
+
+    // Records a write at `offset`. Discards anything that could be redone.
+    void record(std::size_t offset, std::span<const uint8_t> before, std::span<const uint8_t> after);
+
+    void beginGroup() noexcept;
+    void endGroup() noexcept;
+
+    /* Steps back one group and returns its edits in the order they were
+     * made; revert them in reverse. Empty if there is nothing to undo. */
+    std::span<const Edit> undo() noexcept;
+
+    /* Steps forward one group and returns its edits in the order they
+     * were made. Empty if there is nothing to redo. */
+    std::span<const Edit> redo() noexcept;
+
+    inline bool canUndo() const noexcept { return cursor_ != 0; }
+    inline bool canRedo() const noexcept { return cursor_ != edits_.size(); }
+
+    std::span<const uint8_t> before(const Edit & edit) const noexcept;
+    std::span<const uint8_t> after(const Edit & edit) const noexcept;
+
+    /* Identifies the current point in the history. Two equal revisions
+     * mean the data is the same, e.g. to tell if it changed since the last
+     * save. */
+    std::size_t revision() const noexcept;
+
+    // Forgets the history. The revision does not change.
+    void clear() noexcept;
+
+    // Bytes held by the history
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    std::vector<Edit> edits_;
+    std::vector<uint8_t> pool_;
+    // edits_[0, cursor_) are applied
+    std::size_t cursor_{0};
+
+    std::size_t nextGroup_{1};
+    std::size_t openGroup_{0};
+    int depth_{0};
+    // Revision after clear()
+    std::size_t baseRevision_{0};
+};
+
+} // namespace lt
+
+#endif // LT_EDITJOURNAL_H
@@ -0,0 +1,270 @@
+#include "pageoverlay.h"
+#include "view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace lt
+{
+
+PageOverlay::PageOverlay(std::span<const uint8_t> base, std::shared_ptr<const void> owner)
+    : base_(base), owner_(std::move(owner)), pages_((base.size() + page_size - 1) / page_size)
+{
+}
+
+void PageOverlay::read(std::size_t offset, std::span<uint8_t> dest) const
+{
+    checkRange(offset, dest.size());
+
+    std::size_t done = 0;
+    while (done < dest.size())
+    {
+        std::size_t position = offset + done;
+        std::size_t index = position / page_size;
+        std::size_t inPage = position % page_size;
+        std::size_t count = std::min(dest.size() - done, page_size - inPage);
+
+        const uint8_t * src = pages_[index] ? pages_[index]->data() + inPage : base_.data() + position;
+        std::memcpy(dest.data() + done, src, count);
+        done += count;
+    }
+}
+
+void PageOverlay::write(std::size_t offset, std::span<const uint8_t> src)
+{
+    checkRange(offset, src.size());
+
+    std::vector<uint8_t> before(src.size());
+    read(offset, before);
+    // Writing the same bytes changes nothing worth undoing
+    if (std::equal(before.begin(), before.end(), src.begin()))
+        return;
+
+    journal_.record(offset, before, src);
+    store(offset, src);
+    historyEvent_();
+}
+
+void PageOverlay::assign(std::span<const uint8_t> image)
+{
+    if (image.size() != size())
+    {
+        throw std::runtime_error("image size does not match overlay size (" + std::to_string(image.size()) +
+                                 " != " + std::to_string(size()) + ")");
+    }
+
+    for (std::size_t index = 0; index < pages_.size(); ++index)
+    {
+        std::size_t offset = index * page_size;
+        std::size_t count = std::min(page_size, size() - offset);
+        if (std::equal(image.begin() + offset, image.begin() + offset + count, base_.begin() + offset))
+        {
+            pages_[index].reset();
+            continue;
+        }
+
+        auto page = std::make_shared<Page>();
+        std::memcpy(page->data(), image.data() + offset, count);
+        pages_[index] = std::move(page);
+    }
+    journal_.clear();
+    ++generation_;
+    historyEvent_();
+}
+
+void PageOverlay::attach(std::span<const uint8_t> image, std::span<const uint8_t> pageMap,
+                         std::shared_ptr<const void> owner)
+{
+    if (image.size() < pages_.size() * page_size || pageMap.size() * 8 < pages_.size())
+        throw std::runtime_error("attached image does not cover the overlay");
+
+    for (std::size_t index = 0; index < pages_.size(); ++index)
+    {
+        if ((pageMap[index / 8] & (1u << (index % 8))) == 0)
+        {
+            pages_[index].reset();
+            continue;
+        }
+
+        /* Shares ownership with `owner`. attached_ holds another reference,
+         * so writablePage() always copies the page instead of writing to
+         * the image. */
+        auto * bytes = reinterpret_cast<Page *>(const_cast<uint8_t *>(image.data() + index * page_size));
+        pages_[index] = PagePtr(std::const_pointer_cast<void>(owner), bytes);
+    }
+    attached_.push_back(std::move(owner));
+    journal_.clear();
+    ++generation_;
+    historyEvent_();
+}
+
+void PageOverlay::detachImages()
+{
+    if (attached_.empty())
+        return;
+
+    for (PagePtr & page : pages_)
+    {
+        // Borrowed pages share ownership with their image
+        bool borrowed = std::any_of(attached_.begin(), attached_.end(), [&page](const auto & owner) {
+            return !page.owner_before(owner) && !owner.owner_before(page);
+        });
+        if (page && borrowed)
+            page = std::make_shared<Page>(*page);
+    }
+    attached_.clear();
+}
+
+std::vector<uint8_t> PageOverlay::pageMap() const
+{
+    std::vector<uint8_t> map((pages_.size() + 7) / 8, 0);
+    for (std::size_t index = 0; index < pages_.size(); ++index)
+    {
+        if (pages_[index])
+            map[index / 8] |= static_cast<uint8_t>(1u << (index % 8));
+    }
+    return map;
+}
+
+std::vector<std::size_t> PageOverlay::changedPages(const Snapshot & snapshot) const
+{
+    if (snapshot.pages_.size() != pages_.size())
+        throw std::runtime_error("snapshot does not belong to this overlay");
+
+    std::vector<std::size_t> changed;
+    for (std::size_t index = 0; index < pages_.size(); ++index)
+    {
+        // Pages are copied before every write, so an unchanged pointer
+        // means unchanged bytes
+        if (pages_[index] != snapshot.pages_[index])
+            changed.push_back(index);
+    }
+    return changed;
+}
+
+void PageOverlay::copyTo(std::span<uint8_t> dest) const
+{
+    if (dest.size() != size())
+        throw std::runtime_error("destination does not match overlay size");
+    read(0, dest);
+}
+
+bool PageOverlay::undo()
+{
+    std::span<const EditJournal::Edit> edits = journal_.undo();
+    if (edits.empty())
+        return false;
+
+    for (auto it = edits.rbegin(); it != edits.rend(); ++it)
+        store(it->offset, journal_.before(*it));
+    historyEvent_();
+    return true;
+}
+
+bool PageOverlay::redo()
+{
+    std::span<const EditJournal::Edit> edits = journal_.redo();
+    if (edits.empty())
+        return false;
+
+    for (const EditJournal::Edit & edit : edits)
+        store(edit.offset, journal_.after(edit));
+    historyEvent_();
+    return true;
+}
+
+PageOverlay::Snapshot PageOverlay::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.pages_ = pages_;
+    return snapshot;
+}
+
+void PageOverlay::restore(const Snapshot & snapshot)
+{
+    if (snapshot.pages_.size() != pages_.size())
+        throw std::runtime_error("snapshot does not belong to this overlay");
+
+    journal_.beginGroup();
+    for (std::size_t index = 0; index < pages_.size(); ++index)
+    {
+        const PagePtr & target = snapshot.pages_[index];
+        if (target == pages_[index])
+            continue;
+
+        std::span<const uint8_t> current = page(index);
+        std::span<const uint8_t> restored =
+            target ? std::span<const uint8_t>(target->data(), current.size()) : base_.subspan(index * page_size, current.size());
+        if (!std::equal(current.begin(), current.end(), restored.begin()))
+            journal_.record(index * page_size, current, restored);
+
+        // Share the snapshot's page again instead of copying its bytes
+        pages_[index] = target;
+    }
+    journal_.endGroup();
+    ++generation_;
+    historyEvent_();
+}
+
+std::span<const uint8_t> PageOverlay::page(std::size_t index) const noexcept
+{
+    std::size_t offset = index * page_size;
+    std::size_t count = std::min(page_size, size() - offset);
+    if (pages_[index])
+        return std::span<const uint8_t>(pages_[index]->data(), count);
+    return base_.subspan(offset, count);
+}
+
+std::size_t PageOverlay::memoryUsage() const noexcept
+{
+    std::size_t pages = std::count_if(pages_.begin(), pages_.end(), [](const PagePtr & page) { return page != nullptr; });
+    return pages * page_size + pages_.capacity() * sizeof(PagePtr) + journal_.memoryUsage();
+}
+
+View PageOverlay::view(int offset, int size) { return View(*this, offset, size); }
+
+void PageOverlay::store(std::size_t offset, std::span<const uint8_t> src)
+{
+    ++generation_;
+    std::size_t done = 0;
+    while (done < src.size())
+    {
+        std::size_t position = offset + done;
+        std::size_t inPage = position % page_size;
+        std::size_t count = std::min(src.size() - done, page_size - inPage);
+
+        std::memcpy(writablePage(position / page_size).data() + inPage, src.data() + done, count);
+        done += count;
+    }
+}
+
+PageOverlay::Page & PageOverlay::writablePage(std::size_t index)
+{
+    PagePtr & page = pages_[index];
+    if (!page)
+    {
+        page = std::make_shared<Page>();
+        std::size_t offset = index * page_size;
+        std::size_t count = std::min(page_size, size() - offset);
+        std::memcpy(page->data(), base_.data() + offset, count);
+    }
+    else if (page.use_count() != 1)
+    {
+        // Shared with a snapshot or borrowed from an attached image
+        page = std::make_shared<Page>(*page);
+    }
+    return *page;
+}
+
+void PageOverlay::checkRange(std::size_t offset, std::size_t size) const
+{
+    if (offset > this->size() || size > this->size() - offset)
+    {
+        throw std::runtime_error("range " + std::to_string(offset) + "+" + std::to_string(size) +
+                                 " exceeds overlay size " + std::to_string(this->size()));
+    }
+}
+
+} // namespace lt
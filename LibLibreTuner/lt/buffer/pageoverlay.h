@@ -0,0 +1,168 @@
+#ifndef LT_PAGEOVERLAY_H
+#define LT_PAGEOVERLAY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "../support/event.h"
+#include "editjournal.h"
+
+namespace lt
+{
+class View;
+
+/* Copy-on-write image over an immutable base. The image is split into
+ * pages; a page is copied from the base the first time it is written, so
+ * an overlay costs memory for the pages it changed rather than the whole
+ * image. Every write is recorded in an EditJournal for undo and redo.
+ *
+ * Snapshots share pages with the overlay and copy nothing until either
+ * side writes. Not thread-safe, including between an overlay and its
+ * snapshots. */
+class PageOverlay
+{
+public:
+    static constexpr std::size_t page_size = 1024;
+
+private:
+    using Page = std::array<uint8_t, page_size>;
+    using PagePtr = std::shared_ptr<Page>;
+
+public:
+    // Saved state of an overlay's pages. See snapshot().
+    class Snapshot
+    {
+    public:
+        Snapshot() = default;
+
+    private:
+        friend class PageOverlay;
+        std::vector<PagePtr> pages_;
+    };
+
+    PageOverlay() = default;
+
+    /* Overlays `base`, which must stay valid and unchanged for the life of
+     * the overlay. `owner`, if set, is kept alive to guarantee that. */
+    explicit PageOverlay(std::span<const uint8_t> base, std::shared_ptr<const void> owner = {});
+
+    PageOverlay(const PageOverlay &) = delete;
+    PageOverlay(PageOverlay &&) = default;
+    PageOverlay & operator=(const PageOverlay &) = delete;
+    PageOverlay & operator=(PageOverlay &&) = default;
+
+    inline std::size_t size() const noexcept { return base_.size(); }
+    inline std::span<const uint8_t> base() const noexcept { return base_; }
+
+    // Copies dest.size() bytes starting at `offset`. Throws if out of range.
+    void read(std::size_t offset, std::span<uint8_t> dest) const;
+
+    /* Writes `src` at `offset` and records it in the journal. Throws if out
+     * of range. */
+    void write(std::size_t offset, std::span<const uint8_t> src);
+
+    /* Replaces the whole image without recording it, e.g. after loading a
+     * saved image. Only pages that differ from the base are kept. Clears
+     * the journal. */
+    void assign(std::span<const uint8_t> image);
+
+    /* Uses the pages of `image` marked in the bit map `pageMap` (see
+     * pageMap()) in place of the base, without copying them. `image` must
+     * hold whole pages and stay unchanged while they are in use; `owner`
+     * keeps it alive. Clears the journal. */
+    void attach(std::span<const uint8_t> image, std::span<const uint8_t> pageMap, std::shared_ptr<const void> owner);
+
+    /* Copies the pages still borrowed from attached images and drops the
+     * overlay's references to the images, e.g. so their files can be
+     * replaced. Snapshots taken before keep the images alive. */
+    void detachImages();
+
+    // Returns a bit per page, least significant bit first, set for pages
+    // that were copied from the base
+    std::vector<uint8_t> pageMap() const;
+
+    // Returns the indices of the pages that changed since `snapshot`
+    std::vector<std::size_t> changedPages(const Snapshot & snapshot) const;
+
+    // Copies the whole image into `dest`, which must hold size() bytes
+    void copyTo(std::span<uint8_t> dest) const;
+
+    // Reverts the last group of writes. Returns false if there was none.
+    bool undo();
+
+    // Reapplies the last undone group. Returns false if there was none.
+    bool redo();
+
+    inline bool canUndo() const noexcept { return journal_.canUndo(); }
+    inline bool canRedo() const noexcept { return journal_.canRedo(); }
+
+    /* Calls `func` after every write, undo, redo and restore() and after
+     * assign() and attach(), once the bytes are in place. canUndo() and
+     * canRedo() may have changed. */
+    template <typename Func> Event<>::ConnectionPtr onHistoryChange(Func && func) noexcept
+    {
+        return historyEvent_.connect(std::forward<Func>(func));
+    }
+
+    // Writes between these are undone as one step. Calls may nest.
+    inline void beginGroup() noexcept { journal_.beginGroup(); }
+    inline void endGroup() noexcept { journal_.endGroup(); }
+
+    // See EditJournal::revision()
+    inline std::size_t revision() const noexcept { return journal_.revision(); }
+
+    /* Changes with every change to the bytes, including undo, redo,
+     * restore(), assign() and attach(). Unlike revision(), it never
+     * returns to an earlier value, so caches of decoded data can compare
+     * it to tell if they are stale. */
+    inline std::size_t generation() const noexcept { return generation_; }
+
+    inline const EditJournal & journal() const noexcept { return journal_; }
+
+    // Saves the current pages. Costs one pointer per page.
+    Snapshot snapshot() const;
+
+    /* Returns to the state of `snapshot`, which must come from an overlay
+     * of the same base. Recorded as one undoable step. */
+    void restore(const Snapshot & snapshot);
+
+    inline std::size_t pageCount() const noexcept { return pages_.size(); }
+
+    // Returns true if page `index` was copied from the base
+    inline bool pageModified(std::size_t index) const noexcept { return static_cast<bool>(pages_[index]); }
+
+    /* Returns the current bytes of page `index`. The last page may be
+     * shorter than page_size. */
+    std::span<const uint8_t> page(std::size_t index) const noexcept;
+
+    // Bytes held by copied pages and the journal
+    std::size_t memoryUsage() const noexcept;
+
+    View view(int offset, int size);
+
+private:
+    std::span<const uint8_t> base_;
+    std::shared_ptr<const void> owner_;
+    std::vector<PagePtr> pages_;
+    // Owners of attached images
+    std::vector<std::shared_ptr<const void>> attached_;
+    EditJournal journal_;
+    std::size_t generation_{0};
+    Event<> historyEvent_;
+
+    // Writes without recording, copying pages as needed
+    void store(std::size_t offset, std::span<const uint8_t> src);
+
+    // Returns page `index`, copied from the base or a shared page first
+    Page & writablePage(std::size_t index);
+
+    void checkRange(std::size_t offset, std::size_t size) const;
+};
+
+} // namespace lt
+
+#endif // LT_PAGEOVERLAY_H
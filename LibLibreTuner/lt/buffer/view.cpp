@@ -7,16 +7,40 @@ namespace lt
 {
 
 View::View(MemoryBuffer & buffer, int offset, int size)
-    : buffer_(buffer), offset_(offset), size_(size)
+    : buffer_(&buffer), offset_(offset), size_(size)
 {
     assert(offset_ >= 0);
     assert(size_ >= 0);
 
-    if (offset_ + size_ >= buffer_.size())
+    if (offset_ + size_ >= buffer_->size())
+        throw std::runtime_error("view range exceeds buffer size");
+}
+
+View::View(PageOverlay & overlay, int offset, int size)
+    : overlay_(&overlay), offset_(offset), size_(size)
+{
+    assert(offset_ >= 0);
+    assert(size_ >= 0);
+
+    if (static_cast<std::size_t>(offset_) + size_ > overlay_->size())
+        throw std::runtime_error("view range exceeds buffer size");
+}
+
+View::View(std::span<const uint8_t> memory, int offset, int size)
+    : memory_(memory), offset_(offset), size_(size)
+{
+    assert(offset_ >= 0);
+    assert(size_ >= 0);
+
+    if (static_cast<std::size_t>(offset_) + size_ > memory_.size())
         throw std::runtime_error("view range exceeds buffer size");
 }
 
 View View::view(int offset, int size) {
-    return View(buffer_, offset_ + offset, size);
+    if (overlay_ != nullptr)
+        return View(*overlay_, offset_ + offset, size);
+    if (buffer_ != nullptr)
+        return View(*buffer_, offset_ + offset, size);
+    return View(memory_, offset_ + offset, size);
+}
 }
-}
\ No newline at end of file
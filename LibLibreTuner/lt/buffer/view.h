@@ -3,34 +3,33 @@
 
 #include "../support/endianness.h"
 #include <cassert>
+#include <cstring>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
 #include "memorybuffer.h"
+#include "pageoverlay.h"
 
 namespace lt
 {
+// A range of a MemoryBuffer, a PageOverlay or read-only memory
 class View
 {
 public:
     View(MemoryBuffer & buffer, int offset, int size);
+    View(PageOverlay & overlay, int offset, int size);
+    // Writes to a view of read-only memory throw an exception
+    View(std::span<const uint8_t> memory, int offset, int size);
 
     template <typename T, Endianness endianness> T get(int offset = 0) const
     {
         if (offset + static_cast<int>(sizeof(T)) > size())
             throw std::runtime_error("TuneView::get(): index out of range");
-        auto it = std::next(buffer_.begin(), offset_ + offset);
 
         T val;
-        uint8_t * repr = reinterpret_cast<uint8_t *>(&val);
-
-        // Unroll this loop, compiler!
-        for (std::size_t i = 0; i < sizeof(T); ++i)
-        {
-            repr[i] = *it;
-            std::advance(it, 1);
-        }
+        read(std::span<uint8_t>(reinterpret_cast<uint8_t *>(&val), sizeof(T)), offset);
         return endian::convert<T, endianness, endian::current>(val);
     }
 
@@ -38,49 +37,94 @@ public:
     {
         if (offset + static_cast<int>(sizeof(T)) > size())
             throw std::runtime_error("TuneView::get(): index out of range");
-        auto it = std::next(buffer_.begin(), offset_ + offset);
 
         T val = endian::convert<T, endian::current, endianness>(t);
-        uint8_t * repr = reinterpret_cast<uint8_t *>(&val);
-        for (std::size_t i = 0; i < sizeof(T); ++i)
-        {
-            *it = repr[i];
-            std::advance(it, 1);
-        }
+        write(std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(&val), sizeof(T)), offset);
+    }
+
+    // Copies dest.size() bytes starting at `offset`
+    void read(std::span<uint8_t> dest, int offset = 0) const
+    {
+        assert(offset >= 0 && offset + static_cast<int>(dest.size()) <= size_);
+        if (overlay_ != nullptr)
+            overlay_->read(static_cast<std::size_t>(offset_ + offset), dest);
+        else if (!dest.empty())
+            std::memcpy(dest.data(), memory().data() + offset_ + offset, dest.size());
+    }
+
+    // Copies `src` to `offset`. Overlay writes are journaled.
+    void write(std::span<const uint8_t> src, int offset = 0)
+    {
+        assert(offset >= 0 && offset + static_cast<int>(src.size()) <= size_);
+        if (overlay_ != nullptr)
+            overlay_->write(static_cast<std::size_t>(offset_ + offset), src);
+        else if (buffer_ == nullptr)
+            throw std::runtime_error("attempt to write to a read-only view");
+        else if (!src.empty())
+            std::memcpy(buffer_->data() + offset_ + offset, src.data(), src.size());
+    }
+
+    /* Returns true if the bytes are in one block of memory. Only then are
+     * the iterators and data pointers below valid. */
+    inline bool contiguous() const noexcept { return buffer_ != nullptr; }
+
+    /* Changes whenever the bytes may have changed, see
+     * PageOverlay::generation(). Always 0 for views of a MemoryBuffer or
+     * read-only memory. */
+    inline std::size_t generation() const noexcept
+    {
+        return overlay_ != nullptr ? overlay_->generation() : 0;
     }
 
     inline int size() const { return size_; }
-    inline uint8_t * operator*() noexcept { return buffer_.data(); }
-    inline uint8_t & operator[](int index) { return buffer_[index]; }
+    inline uint8_t * operator*() noexcept { return buffer().data(); }
+    inline uint8_t & operator[](int index) { return buffer()[index]; }
     inline const uint8_t & operator[](int index) const
     {
-        return buffer_[index];
+        return buffer()[index];
     }
-    inline uint8_t * data() noexcept { return buffer_.data(); }
-    inline const uint8_t * data() const noexcept { return buffer_.data(); }
+    inline uint8_t * data() noexcept { return buffer().data(); }
+    inline const uint8_t * data() const noexcept { return buffer().data(); }
 
     MemoryBuffer::iterator begin()
     {
-        return std::next(buffer_.begin(), offset_);
+        return std::next(buffer().begin(), offset_);
     }
     MemoryBuffer::iterator end()
     {
-        return std::next(buffer_.begin(), offset_ + size_);
+        return std::next(buffer().begin(), offset_ + size_);
     }
     MemoryBuffer::const_iterator cbegin() const
     {
-        return std::next(buffer_.cbegin(), offset_);
+        return std::next(buffer().cbegin(), offset_);
     }
     MemoryBuffer::const_iterator cend() const
     {
-        return std::next(buffer_.cbegin(), offset_ + size_);
+        return std::next(buffer().cbegin(), offset_ + size_);
     }
 
     View view(int offset, int size);
 
 private:
-    MemoryBuffer & buffer_;
+    // At most one of these is set. Without either, the view is of
+    // memory_.
+    MemoryBuffer * buffer_{nullptr};
+    PageOverlay * overlay_{nullptr};
+    std::span<const uint8_t> memory_;
     int offset_, size_;
+
+    inline std::span<const uint8_t> memory() const noexcept
+    {
+        if (buffer_ != nullptr)
+            return {buffer_->data(), static_cast<std::size_t>(buffer_->size())};
+        return memory_;
+    }
+
+    inline MemoryBuffer & buffer() const noexcept
+    {
+        assert(buffer_ != nullptr);
+        return *buffer_;
+    }
 };
 
 } // namespace lt
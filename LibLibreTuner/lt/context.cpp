@@ -7,11 +7,13 @@ static LogCallback _logCallback;
 
 void setLogCallback(LogCallback && cb) { _logCallback = std::move(cb); }
 
-void log(const std::string & message)
+void log(const std::string & message) { log(LogLevel::Debug, message); }
+
+void log(LogLevel level, const std::string & message)
 {
     if (_logCallback)
     {
-        _logCallback(message);
+        _logCallback(level, message);
     }
 }
 
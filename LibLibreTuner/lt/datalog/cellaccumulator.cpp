@@ -0,0 +1,257 @@
+#include "cellaccumulator.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace lt
+{
+
+namespace
+{
+// Smallest share of a log worth giving to its own thread
+constexpr std::size_t min_entries_per_thread = 4096;
+
+/* Reads a channel at increasing points in time, interpolating between the
+ * entries around each point */
+class ChannelCursor
+{
+public:
+    // Entries appended to `log` after construction are not read
+    ChannelCursor(const PidLog & log, std::size_t time) noexcept : log_(log), size_(log.size())
+    {
+        next_ = log_.lowerBound(time, size_);
+    }
+
+    // Returns false if `time` is outside of the channel. `time` must not
+    // decrease between calls.
+    bool at(std::size_t time, double & value) noexcept
+    {
+        while (next_ < size_ && log_[next_].time < time)
+            ++next_;
+        if (next_ == size_)
+            return false;
+
+        const PidLogEntry after = log_[next_];
+        if (after.time == time)
+        {
+            value = after.value;
+            return true;
+        }
+        if (next_ == 0)
+            return false;
+
+        const PidLogEntry before = log_[next_ - 1];
+        double fraction = static_cast<double>(time - before.time) / static_cast<double>(after.time - before.time);
+        value = before.value + (after.value - before.value) * fraction;
+        return true;
+    }
+
+private:
+    const PidLog & log_;
+    std::size_t size_;
+    std::size_t next_;
+};
+} // namespace
+
+void CellStats::add(double value) noexcept
+{
+    ++count;
+    double delta = value - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (value - mean);
+}
+
+void CellStats::merge(const CellStats & other) noexcept
+{
+    if (other.count == 0)
+        return;
+    if (count == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    const double a = static_cast<double>(count);
+    const double b = static_cast<double>(other.count);
+    const double total = a + b;
+    const double delta = other.mean - mean;
+
+    mean += delta * b / total;
+    m2 += other.m2 + delta * delta * a * b / total;
+    count += other.count;
+}
+
+double CellStats::variance() const noexcept
+{
+    if (count < 2)
+        return 0.0;
+    return m2 / static_cast<double>(count - 1);
+}
+
+CellAccumulator::CellAccumulator(const Table & table)
+    : lookup_(table), cells_(static_cast<std::size_t>(table.width()) * table.height())
+{
+}
+
+void CellAccumulator::add(double x, double y, double error) noexcept
+{
+    auto [row, column] = lookup_.cell(x, y);
+    cells_[static_cast<std::size_t>(row) * width() + column].add(error);
+    ++samples_;
+}
+
+std::size_t CellAccumulator::add(const PidLog & x, const PidLog * y, const PidLog & error, std::size_t begin,
+                                 std::size_t end)
+{
+    end = std::min(end, error.size());
+    if (begin >= end)
+        return 0;
+
+    const std::size_t start = error[begin].time;
+    ChannelCursor xCursor(x, start);
+    std::optional<ChannelCursor> yCursor;
+    if (y != nullptr)
+        yCursor.emplace(*y, start);
+
+    std::size_t added = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const PidLogEntry entry = error[i];
+        double xValue, yValue = 0.0;
+        if (!xCursor.at(entry.time, xValue))
+            continue;
+        if (yCursor && !yCursor->at(entry.time, yValue))
+            continue;
+
+        add(xValue, yValue, entry.value);
+        ++added;
+    }
+    return added;
+}
+
+std::size_t CellAccumulator::add(const PidLog & x, const PidLog * y, const PidLog & error)
+{
+    return add(x, y, error, 0, error.size());
+}
+
+std::size_t CellAccumulator::add(const DataLog & log, const Pid & x, const Pid * y, const Pid & error)
+{
+    auto find = [&log](const Pid & pid) -> const PidLog & {
+        const PidLog * pidLog = log.pidLog(pid);
+        if (pidLog == nullptr)
+            throw std::runtime_error("datalog does not contain PID '" + pid.name + "'");
+        return *pidLog;
+    };
+
+    const PidLog & xLog = find(x);
+    const PidLog * yLog = y != nullptr ? &find(*y) : nullptr;
+    return add(xLog, yLog, find(error));
+}
+
+void CellAccumulator::merge(const CellAccumulator & other)
+{
+    if (other.width() != width() || other.height() != height())
+        throw std::runtime_error("cannot merge accumulators of different table sizes");
+
+    for (std::size_t i = 0; i < cells_.size(); ++i)
+        cells_[i].merge(other.cells_[i]);
+    samples_ += other.samples_;
+}
+
+void CellAccumulator::clear() noexcept
+{
+    std::fill(cells_.begin(), cells_.end(), CellStats{});
+    samples_ = 0;
+}
+
+const CellStats & CellAccumulator::stats(int row, int column) const
+{
+    if (row < 0 || row >= height() || column < 0 || column >= width())
+    {
+        throw std::runtime_error("cell (" + std::to_string(row) + ", " + std::to_string(column) +
+                                 ") is out of bounds");
+    }
+    return cells_[static_cast<std::size_t>(row) * width() + column];
+}
+
+std::vector<double> CellAccumulator::proposedDeltas(const Table & table, CorrectionMode mode, std::size_t minSamples,
+                                                    double gain) const
+{
+    checkTable(table);
+
+    std::vector<double> deltas(cells_.size(), 0.0);
+    std::span<const double> values = table.values();
+    for (std::size_t i = 0; i < cells_.size(); ++i)
+    {
+        const CellStats & cell = cells_[i];
+        if (cell.count == 0 || cell.count < minSamples)
+            continue;
+
+        deltas[i] = gain * cell.mean;
+        if (mode == CorrectionMode::Percent)
+            deltas[i] *= values[i] / 100.0;
+    }
+    return deltas;
+}
+
+std::size_t CellAccumulator::apply(Table & table, CorrectionMode mode, std::size_t minSamples, double gain) const
+{
+    std::vector<double> deltas = proposedDeltas(table, mode, minSamples, gain);
+
+    std::size_t changed = 0;
+    for (int row = 0; row < height(); ++row)
+    {
+        for (int column = 0; column < width(); ++column)
+        {
+            double delta = deltas[static_cast<std::size_t>(row) * width() + column];
+            if (delta == 0.0)
+                continue;
+            table.set(row, column, table.get(row, column) + delta);
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+CellAccumulator CellAccumulator::accumulate(const Table & table, const PidLog & x, const PidLog * y,
+                                            const PidLog & error, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::size_t count = error.size();
+    threads = static_cast<unsigned>(
+        std::clamp<std::size_t>(count / min_entries_per_thread, 1, threads));
+
+    std::vector<CellAccumulator> partials(threads, CellAccumulator(table));
+    const std::size_t share = (count + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        // Bounded by count, as the log may grow meanwhile
+        workers.emplace_back([&, i] { partials[i].add(x, y, error, i * share, std::min((i + 1) * share, count)); });
+    }
+    partials[0].add(x, y, error, 0, std::min(share, count));
+    for (std::thread & worker : workers)
+        worker.join();
+
+    for (unsigned i = 1; i < threads; ++i)
+        partials[0].merge(partials[i]);
+    return std::move(partials[0]);
+}
+
+void CellAccumulator::checkTable(const Table & table) const
+{
+    if (table.width() != width() || table.height() != height())
+    {
+        throw std::runtime_error("table size does not match accumulator (" + std::to_string(table.width()) + "x" +
+                                 std::to_string(table.height()) + " != " + std::to_string(width()) + "x" +
+                                 std::to_string(height()) + ")");
+    }
+}
+
+} // namespace lt
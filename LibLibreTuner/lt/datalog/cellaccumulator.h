@@ -0,0 +1,111 @@
+#ifndef LT_CELLACCUMULATOR_H
+#define LT_CELLACCUMULATOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../rom/interpolation.h"
+#include "../rom/table.h"
+#include "datalog.h"
+
+namespace lt
+{
+
+// Running count, mean and variance of the samples in one cell
+struct CellStats
+{
+    std::size_t count{0};
+    double mean{0.0};
+    // Sum of squared differences from the mean
+    double m2{0.0};
+
+    // Welford update
+    void add(double value) noexcept;
+
+    // Combines the statistics of two disjoint sample sets
+    void merge(const CellStats & other) noexcept;
+
+    // Sample variance. 0 with fewer than two samples.
+    double variance() const noexcept;
+};
+
+// How a cell's mean error is turned into a change of the cell
+enum class CorrectionMode
+{
+    // The mean error is added to the cell
+    Offset,
+    // The mean error is a percentage of the cell's value
+    Percent,
+};
+
+/* Bins datalog samples into the cells of a table and keeps the statistics of
+ * an error channel (e.g. a fuel trim or knock retard) per cell. Each sample
+ * goes to the cell nearest to its axis coordinates, like the active cell an
+ * ECU reports.
+ *
+ * One accumulator is not thread-safe. To use several threads, give each one
+ * its own accumulator over a part of the log and merge() them; see
+ * accumulate(). */
+class CellAccumulator
+{
+public:
+    explicit CellAccumulator(const Table & table);
+
+    // Adds one sample. `y` is ignored by one-dimensional tables.
+    void add(double x, double y, double error) noexcept;
+
+    /* Adds every entry of `error` from `begin` up to (not including) `end`.
+     * The x and y channels are linearly interpolated to the time of each
+     * entry; entries outside of their time span are skipped. `y` may be
+     * nullptr for one-dimensional tables. Entries must be in time order.
+     * Returns the amount of samples added. */
+    std::size_t add(const PidLog & x, const PidLog * y, const PidLog & error, std::size_t begin, std::size_t end);
+
+    // Adds all entries of `error`
+    std::size_t add(const PidLog & x, const PidLog * y, const PidLog & error);
+
+    /* Same as above, with the channels looked up in `log` by PID. Throws an
+     * exception if a channel is not in the log. */
+    std::size_t add(const DataLog & log, const Pid & x, const Pid * y, const Pid & error);
+
+    /* Merges the statistics of another accumulator of the same table. Throws
+     * an exception if the sizes do not match. */
+    void merge(const CellAccumulator & other);
+
+    // Discards all samples
+    void clear() noexcept;
+
+    const CellStats & stats(int row, int column) const;
+
+    /* Returns the proposed change of every cell, row-major. Cells with fewer
+     * than `minSamples` samples are left at 0. Percent corrections are
+     * relative to the values of `table`. */
+    std::vector<double> proposedDeltas(const Table & table, CorrectionMode mode, std::size_t minSamples,
+                                       double gain = 1.0) const;
+
+    /* Applies the proposed changes to `table` through Table::set. Returns the
+     * amount of cells changed. */
+    std::size_t apply(Table & table, CorrectionMode mode, std::size_t minSamples, double gain = 1.0) const;
+
+    /* Splits the entries of `error` across `threads` threads (0 uses the
+     * hardware concurrency) and merges the partial results. */
+    static CellAccumulator accumulate(const Table & table, const PidLog & x, const PidLog * y, const PidLog & error,
+                                      unsigned threads = 0);
+
+    inline int width() const noexcept { return lookup_.width(); }
+    inline int height() const noexcept { return lookup_.height(); }
+
+    // Total amount of samples added
+    inline std::size_t samples() const noexcept { return samples_; }
+
+private:
+    TableInterpolator lookup_;
+    std::vector<CellStats> cells_;
+    std::size_t samples_{0};
+
+    void checkTable(const Table & table) const;
+};
+
+} // namespace lt
+
+#endif // LT_CELLACCUMULATOR_H
@@ -18,9 +18,107 @@
 
 #include "datalog.h"
 
+#include <limits>
+#include <stdexcept>
+
 namespace lt
 {
 
+PidLog::PidLog(Pid pid, Precision precision)
+    : pid(std::move(pid)), precision_(precision)
+{
+}
+
+PidLog::~PidLog() = default;
+
+void PidLog::append(PidLogEntry entry)
+{
+    std::size_t index = size_.load(std::memory_order_relaxed);
+    if (index % chunk_size == 0)
+        addChunk(entry.time);
+
+    Chunk & chunk = *chunks_.back();
+    int64_t offset = static_cast<int64_t>(entry.time) -
+                     static_cast<int64_t>(chunk.baseTime);
+    if (offset < std::numeric_limits<int32_t>::min() ||
+        offset > std::numeric_limits<int32_t>::max())
+    {
+        throw std::runtime_error("log entry time is too far from the "
+                                 "entries before it");
+    }
+
+    std::size_t position = index % chunk_size;
+    chunk.offsets[position] = static_cast<int32_t>(offset);
+    if (chunk.floats)
+        chunk.floats[position] = static_cast<float>(entry.value);
+    else
+        chunk.doubles[position] = entry.value;
+
+    // Publishes the entry to readers
+    size_.store(index + 1, std::memory_order_release);
+}
+
+std::size_t PidLog::lowerBound(std::size_t time, std::size_t count) const
+    noexcept
+{
+    std::size_t first = 0;
+    while (count > 0)
+    {
+        std::size_t half = count / 2;
+        if ((*this)[first + half].time < time)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    return first;
+}
+
+std::size_t PidLog::memoryUsage() const noexcept
+{
+    std::size_t valueSize =
+        precision_ == Precision::Float ? sizeof(float) : sizeof(double);
+    std::size_t usage = chunks_.size() *
+                        (sizeof(Chunk) + chunk_size * (sizeof(int32_t) + valueSize));
+    for (const auto & directory : directories_)
+        usage += directory->capacity * sizeof(Chunk *);
+    return usage;
+}
+
+void PidLog::addChunk(std::size_t baseTime)
+{
+    auto chunk = std::make_unique<Chunk>();
+    chunk->baseTime = baseTime;
+    chunk->offsets = std::unique_ptr<int32_t[]>(new int32_t[chunk_size]);
+    if (precision_ == Precision::Float)
+        chunk->floats = std::unique_ptr<float[]>(new float[chunk_size]);
+    else
+        chunk->doubles = std::unique_ptr<double[]>(new double[chunk_size]);
+
+    Directory * directory = directories_.empty() ? nullptr : directories_.back().get();
+    if (directory == nullptr || chunks_.size() == directory->capacity)
+    {
+        // Readers keep using the old directory until they load the new one
+        auto larger = std::make_unique<Directory>();
+        larger->capacity = directory == nullptr ? 16 : directory->capacity * 2;
+        larger->chunks = std::make_unique<Chunk *[]>(larger->capacity);
+        for (std::size_t i = 0; i < chunks_.size(); ++i)
+            larger->chunks[i] = chunks_[i].get();
+        directories_.push_back(std::move(larger));
+        directory = directories_.back().get();
+    }
+
+    // Readers do not look past the chunks of published entries, so
+    // filling the next slot does not race with them
+    directory->chunks[chunks_.size()] = chunk.get();
+    chunks_.push_back(std::move(chunk));
+    directory_.store(directory, std::memory_order_release);
+}
+
 bool DataLog::add(const Pid & pid, PidLogEntry entry)
 {
     PidLog * log = pidLog(pid);
@@ -35,7 +133,7 @@ bool DataLog::add(const Pid & pid, PidLogEntry entry)
         beginTime_ = std::chrono::steady_clock::now();
     }
 
-    log->entries.emplace_back(entry);
+    log->append(entry);
     if (entry.time > maxTime_)
     {
         maxTime_ = entry.time;
@@ -63,11 +161,20 @@ PidLog * DataLog::pidLog(const Pid & pid) noexcept
     return &it->second;
 }
 
-PidLog & DataLog::addPid(const Pid & pid) noexcept
+const PidLog * DataLog::pidLog(const Pid & pid) const noexcept
+{
+    auto it = logs_.find(pid.code);
+    if (it == logs_.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+PidLog & DataLog::addPid(const Pid & pid)
 {
-    PidLog log{pid, {}};
-    logs_.emplace(pid.code, std::move(log));
-    return logs_.find(pid.code)->second;
+    // Nodes of the map do not move, so references to logs stay valid
+    return logs_.try_emplace(pid.code, pid, precision_).first->second;
 }
 
 bool DataLog::add(const Pid & pid, double value)
@@ -19,7 +19,9 @@
 #ifndef LT_DATALOG_H
 #define LT_DATALOG_H
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <unordered_map>
@@ -39,15 +41,99 @@ struct PidLogEntry
     std::size_t time;
 };
 
-struct PidLog
+/* Samples of one PID, stored in columns of fixed-size chunks. Each chunk
+ * holds the time of its first entry and the offsets of the others from
+ * it, and the values as double or, to halve their size, float. Chunks
+ * are never moved or reallocated, so appending costs no copies and one
+ * thread may read entries below size() while another appends. */
+class PidLog
 {
+public:
+    static constexpr std::size_t chunk_size = 4096;
+
+    enum class Precision
+    {
+        Double,
+        Float,
+    };
+
+    explicit PidLog(Pid pid, Precision precision = Precision::Double);
+    ~PidLog();
+
+    PidLog(const PidLog &) = delete;
+    PidLog & operator=(const PidLog &) = delete;
+
     Pid pid;
-    std::vector<PidLogEntry> entries;
+
+    /* Adds an entry. Throws an exception if its time is more than about
+     * 24 days from the first entry of its chunk. Not thread-safe with
+     * other calls to append(). */
+    void append(PidLogEntry entry);
+
+    // Amount of entries. Entries below it can be read while appending.
+    inline std::size_t size() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+    inline bool empty() const noexcept { return size() == 0; }
+
+    inline PidLogEntry operator[](std::size_t index) const noexcept
+    {
+        const Chunk & chunk = *directory_.load(std::memory_order_acquire)
+                                   ->chunks[index / chunk_size];
+        std::size_t offset = index % chunk_size;
+        return PidLogEntry{
+            chunk.floats ? chunk.floats[offset] : chunk.doubles[offset],
+            static_cast<std::size_t>(
+                static_cast<int64_t>(chunk.baseTime) + chunk.offsets[offset])};
+    }
+
+    inline Precision precision() const noexcept { return precision_; }
+
+    /* Returns the index of the first entry with a time of at least `time`
+     * among the first `count` entries, or `count` if there is none.
+     * Entries must be in time order. */
+    std::size_t lowerBound(std::size_t time, std::size_t count) const noexcept;
+
+    // Bytes allocated for entries
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    struct Chunk
+    {
+        std::size_t baseTime{0};
+        // Time of each entry minus baseTime, in milliseconds
+        std::unique_ptr<int32_t[]> offsets;
+        // Only one is allocated, depending on precision_
+        std::unique_ptr<double[]> doubles;
+        std::unique_ptr<float[]> floats;
+    };
+
+    // Pointers to the chunks. Replaced by a larger copy when full.
+    struct Directory
+    {
+        std::size_t capacity{0};
+        std::unique_ptr<Chunk *[]> chunks;
+    };
+
+    Precision precision_;
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    /* Every directory allocated. Readers may still hold a replaced one,
+     * so they are kept until the log is destroyed; together they take
+     * less space than the last. */
+    std::vector<std::unique_ptr<Directory>> directories_;
+    std::atomic<const Directory *> directory_{nullptr};
+    std::atomic<std::size_t> size_{0};
+
+    void addChunk(std::size_t baseTime);
 };
 
 class DataLog
 {
 public:
+    // Extension of datalog files, see DataLogWriter
+    static constexpr auto extension = ".ltl";
+
     using AddEvent = Event<const PidLog &, const PidLogEntry &>;
     using AddConnectionPtr = AddEvent::ConnectionPtr;
 
@@ -64,10 +150,23 @@ public:
     // Returns the PID log or nullptr if it does not exist. Add with
     // addPid()
     PidLog * pidLog(const Pid & pid) noexcept;
+    const PidLog * pidLog(const Pid & pid) const noexcept;
 
-    // Adds a PID to the log. Overwrites any previous logs with the same
-    // pid.
-    PidLog & addPid(const Pid & pid) noexcept;
+    // Logs of all PIDs by code
+    inline const std::unordered_map<uint32_t, PidLog> & pidLogs() const noexcept
+    {
+        return logs_;
+    }
+
+    // Adds a PID to the log. Returns the existing log if there is one
+    // with the same pid.
+    PidLog & addPid(const Pid & pid);
+
+    // Precision of the values of PIDs added after the call
+    inline void setPrecision(PidLog::Precision precision) noexcept
+    {
+        precision_ = precision;
+    }
 
     inline std::string name() const noexcept { return name_; }
     inline void setName(const std::string & name) noexcept { name_ = name; }
@@ -94,6 +193,7 @@ private:
     double minValue_{0};
     std::string name_;
     bool empty_{true};
+    PidLog::Precision precision_{PidLog::Precision::Double};
 
     AddEvent addEvent_;
 
@@ -0,0 +1,656 @@
+#include "datalogfile.h"
+
+#include "../support/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace lt
+{
+
+namespace
+{
+constexpr std::array<uint8_t, 4> log_magic{'L', 'T', 'L', 'G'};
+constexpr std::array<uint8_t, 4> trailer_magic{'L', 'T', 'L', 'X'};
+constexpr uint32_t log_version = 2;
+constexpr std::size_t header_size = 8;
+constexpr std::size_t record_header_size = 5;
+constexpr std::size_t trailer_size = 16;
+// Control byte of a value equal to the previous one
+constexpr uint8_t value_unchanged = 0x80;
+
+enum RecordKind : uint8_t
+{
+    record_name = 1,
+    record_pid = 2,
+    record_chunk = 3,
+    record_index = 4,
+};
+
+inline void put32(std::string & out, uint32_t value)
+{
+    uint8_t bytes[4];
+    SConverter<uint32_t, 4>::writeLE(value, bytes);
+    out.append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+inline void put64(std::string & out, uint64_t value)
+{
+    put32(out, static_cast<uint32_t>(value));
+    put32(out, static_cast<uint32_t>(value >> 32));
+}
+
+inline uint32_t get32(const uint8_t * src) { return SConverter<uint32_t, 4>::readLE(src); }
+
+inline uint64_t get64(const uint8_t * src)
+{
+    return static_cast<uint64_t>(get32(src)) | (static_cast<uint64_t>(get32(src + 4)) << 32);
+}
+
+void putVarint(std::string & out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void putString(std::string & out, const std::string & value)
+{
+    putVarint(out, value.size());
+    out += value;
+}
+
+void putPid(std::string & out, const Pid & pid)
+{
+    putVarint(out, pid.code);
+    putString(out, pid.name);
+    putString(out, pid.description);
+    putString(out, pid.formula);
+    putString(out, pid.unit);
+}
+
+inline uint64_t zigzag(int64_t value) noexcept
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) noexcept
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Stores the bytes of `bits` between its leading and trailing zero bytes
+void putValue(std::string & out, uint64_t bits)
+{
+    if (bits == 0)
+    {
+        out.push_back(static_cast<char>(value_unchanged));
+        return;
+    }
+
+    int leading = std::countl_zero(bits) / 8;
+    int trailing = std::countr_zero(bits) / 8;
+    out.push_back(static_cast<char>((leading << 4) | trailing));
+    for (int i = 7 - leading; i >= trailing; --i)
+        out.push_back(static_cast<char>(bits >> (i * 8)));
+}
+
+// Reads the parts of a record payload. Throws if they overrun it.
+class Decoder
+{
+public:
+    Decoder(const uint8_t * data, std::size_t size) : data_(data), end_(data + size) {}
+
+    uint8_t byte()
+    {
+        if (data_ == end_)
+            corrupt();
+        return *data_++;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t next = byte();
+            value |= static_cast<uint64_t>(next & 0x7F) << shift;
+            if ((next & 0x80) == 0)
+                return value;
+        }
+        corrupt();
+    }
+
+    std::string string()
+    {
+        uint64_t size = varint();
+        if (size > static_cast<uint64_t>(end_ - data_))
+            corrupt();
+        std::string value(reinterpret_cast<const char *>(data_), size);
+        data_ += size;
+        return value;
+    }
+
+    uint64_t value()
+    {
+        uint8_t control = byte();
+        if (control == value_unchanged)
+            return 0;
+
+        int leading = control >> 4;
+        int trailing = control & 0x0F;
+        if (leading + trailing >= 8)
+            corrupt();
+        uint64_t bits = 0;
+        for (int i = 7 - leading; i >= trailing; --i)
+            bits |= static_cast<uint64_t>(byte()) << (i * 8);
+        return bits;
+    }
+
+    [[noreturn]] static void corrupt() { throw std::runtime_error("datalog file is corrupt"); }
+
+private:
+    const uint8_t * data_;
+    const uint8_t * end_;
+};
+
+// Header fields of a chunk record
+struct ChunkHeader
+{
+    uint16_t code;
+    uint64_t count, minTime, maxTime;
+};
+
+Pid readPid(Decoder & decoder)
+{
+    Pid pid{};
+    pid.code = static_cast<uint16_t>(decoder.varint());
+    pid.name = decoder.string();
+    pid.description = decoder.string();
+    pid.formula = decoder.string();
+    pid.unit = decoder.string();
+    return pid;
+}
+
+ChunkHeader readChunkHeader(Decoder & decoder)
+{
+    ChunkHeader header;
+    header.code = static_cast<uint16_t>(decoder.varint());
+    header.count = decoder.varint();
+    header.minTime = decoder.varint();
+    header.maxTime = decoder.varint();
+    return header;
+}
+} // namespace
+
+DataLogWriter::DataLogWriter(const fs::path & path, const std::string & name)
+    : path_(path), file_(path, std::ios::binary | std::ios::out | std::ios::trunc), name_(name)
+{
+    if (!file_.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "' for writing");
+
+    std::string header(log_magic.begin(), log_magic.end());
+    put32(header, log_version);
+    file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    position_ = header.size();
+
+    std::string payload;
+    putString(payload, name_);
+    writeRecord(record_name, payload);
+    file_.flush();
+}
+
+DataLogWriter::~DataLogWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+void DataLogWriter::add(const Pid & pid, const PidLogEntry & entry)
+{
+    std::lock_guard lock(mutex_);
+    if (closed_)
+        throw std::runtime_error("datalog file is closed");
+
+    auto [it, inserted] = buffers_.try_emplace(pid.code);
+    if (inserted)
+    {
+        pids_.push_back(pid);
+        std::string payload;
+        putPid(payload, pid);
+        writeRecord(record_pid, payload);
+        it->second.reserve(entries_per_chunk);
+    }
+
+    it->second.push_back(entry);
+    if (it->second.size() == entries_per_chunk)
+    {
+        writeChunk(pid.code, it->second);
+        file_.flush();
+    }
+}
+
+void DataLogWriter::flush()
+{
+    std::lock_guard lock(mutex_);
+    if (!closed_)
+        flushLocked();
+}
+
+void DataLogWriter::close()
+{
+    std::lock_guard lock(mutex_);
+    if (closed_)
+        return;
+    closed_ = true;
+    flushLocked();
+
+    std::string payload;
+    putString(payload, name_);
+    putVarint(payload, pids_.size());
+    for (const Pid & pid : pids_)
+        putPid(payload, pid);
+    putVarint(payload, chunks_.size());
+    for (const ChunkInfo & chunk : chunks_)
+    {
+        putVarint(payload, chunk.offset);
+        putVarint(payload, chunk.code);
+        putVarint(payload, chunk.count);
+        putVarint(payload, chunk.minTime);
+        putVarint(payload, chunk.maxTime);
+    }
+
+    uint64_t indexOffset = position_;
+    writeRecord(record_index, payload);
+
+    std::string trailer;
+    put64(trailer, indexOffset);
+    trailer.append(trailer_magic.begin(), trailer_magic.end());
+    put32(trailer, 0);
+    file_.write(trailer.data(), static_cast<std::streamsize>(trailer.size()));
+    file_.close();
+    if (!file_)
+        throw std::runtime_error("failed to write '" + path_.string() + "'");
+}
+
+void DataLogWriter::writeRecord(uint8_t kind, const std::string & payload)
+{
+    std::string header(1, static_cast<char>(kind));
+    put32(header, static_cast<uint32_t>(payload.size()));
+    file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file_.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!file_)
+        throw std::runtime_error("failed to write '" + path_.string() + "'");
+    position_ += header.size() + payload.size();
+}
+
+void DataLogWriter::writeChunk(uint16_t code, std::vector<PidLogEntry> & entries)
+{
+    if (entries.empty())
+        return;
+
+    ChunkInfo info{position_, code, entries.size(), entries.front().time, entries.front().time};
+    for (const PidLogEntry & entry : entries)
+    {
+        info.minTime = std::min<uint64_t>(info.minTime, entry.time);
+        info.maxTime = std::max<uint64_t>(info.maxTime, entry.time);
+    }
+
+    std::string payload;
+    payload.reserve(16 + entries.size() * 4);
+    putVarint(payload, code);
+    putVarint(payload, info.count);
+    putVarint(payload, info.minTime);
+    putVarint(payload, info.maxTime);
+
+    uint64_t time = 0, bits = 0;
+    for (const PidLogEntry & entry : entries)
+    {
+        putVarint(payload, zigzag(static_cast<int64_t>(entry.time - time)));
+        uint64_t valueBits = std::bit_cast<uint64_t>(entry.value);
+        putValue(payload, valueBits ^ bits);
+        time = entry.time;
+        bits = valueBits;
+    }
+
+    writeRecord(record_chunk, payload);
+    chunks_.push_back(info);
+    entries.clear();
+}
+
+void DataLogWriter::flushLocked()
+{
+    // Written in the order the PIDs were first seen
+    for (const Pid & pid : pids_)
+        writeChunk(pid.code, buffers_[pid.code]);
+    file_.flush();
+}
+
+void saveDataLog(const DataLog & log, const fs::path & path)
+{
+    DataLogWriter writer(path, log.name());
+    for (const auto & [code, pidLog] : log.pidLogs())
+    {
+        std::size_t size = pidLog.size();
+        for (std::size_t i = 0; i < size; ++i)
+            writer.add(pidLog.pid, pidLog[i]);
+    }
+    writer.close();
+}
+
+DataLogReader::DataLogReader(const fs::path & path)
+    : file_(std::make_shared<MappedFile>(path, MappedFile::Mode::ReadOnly))
+{
+    std::span<const uint8_t> bytes = file_->bytes();
+    if (bytes.size() < header_size || !std::equal(log_magic.begin(), log_magic.end(), bytes.begin()))
+        throw std::runtime_error("'" + path.string() + "' is not a datalog file");
+    if (uint32_t version = get32(&bytes[4]); version != log_version)
+        throw std::runtime_error("unsupported datalog file version " + std::to_string(version));
+
+    beginTime_ = std::numeric_limits<std::size_t>::max();
+    complete_ = readIndex();
+    if (!complete_)
+    {
+        // The index is written last, so trust none of it
+        pids_.clear();
+        chunks_.clear();
+        beginTime_ = std::numeric_limits<std::size_t>::max();
+        endTime_ = 0;
+        scanRecords();
+    }
+    if (chunks_.empty())
+        beginTime_ = 0;
+}
+
+bool DataLogReader::readIndex()
+{
+    std::span<const uint8_t> bytes = file_->bytes();
+    if (bytes.size() < header_size + record_header_size + trailer_size)
+        return false;
+
+    const uint8_t * trailer = bytes.data() + bytes.size() - trailer_size;
+    if (!std::equal(trailer_magic.begin(), trailer_magic.end(), trailer + 8))
+        return false;
+
+    uint64_t indexOffset = get64(trailer);
+    uint64_t indexEnd = bytes.size() - trailer_size;
+    // Compared without adding to the offset, which may be anything
+    if (indexOffset < header_size || indexOffset > indexEnd - record_header_size ||
+        bytes[indexOffset] != record_index ||
+        get32(&bytes[indexOffset + 1]) != indexEnd - indexOffset - record_header_size)
+    {
+        return false;
+    }
+
+    try
+    {
+        Decoder decoder(&bytes[indexOffset + record_header_size], indexEnd - indexOffset - record_header_size);
+        name_ = decoder.string();
+        for (uint64_t i = decoder.varint(); i > 0; --i)
+            pids_.push_back(readPid(decoder));
+        for (uint64_t i = decoder.varint(); i > 0; --i)
+        {
+            ChunkInfo chunk;
+            chunk.offset = decoder.varint();
+            uint16_t code = static_cast<uint16_t>(decoder.varint());
+            chunk.count = decoder.varint();
+            chunk.minTime = decoder.varint();
+            chunk.maxTime = decoder.varint();
+            if (chunk.offset >= indexOffset)
+                Decoder::corrupt();
+            addChunk(code, chunk);
+        }
+    }
+    catch (const std::runtime_error &)
+    {
+        return false;
+    }
+    return true;
+}
+
+void DataLogReader::scanRecords()
+{
+    std::span<const uint8_t> bytes = file_->bytes();
+    std::size_t offset = header_size;
+    // A record cut short by a crash ends the scan
+    while (offset + record_header_size <= bytes.size())
+    {
+        uint8_t kind = bytes[offset];
+        std::size_t size = get32(&bytes[offset + 1]);
+        if (size > bytes.size() - offset - record_header_size)
+            break;
+
+        Decoder decoder(&bytes[offset + record_header_size], size);
+        try
+        {
+            switch (kind)
+            {
+            case record_name:
+                name_ = decoder.string();
+                break;
+            case record_pid:
+                pids_.push_back(readPid(decoder));
+                break;
+            case record_chunk:
+            {
+                ChunkHeader header = readChunkHeader(decoder);
+                addChunk(header.code, ChunkInfo{offset, header.count, header.minTime, header.maxTime});
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+            break;
+        }
+        offset += record_header_size + size;
+    }
+}
+
+void DataLogReader::addChunk(uint16_t code, const ChunkInfo & chunk)
+{
+    PidChunks & pid = chunks_[code];
+    if (!pid.chunks.empty() && chunk.minTime < pid.chunks.back().maxTime)
+        pid.ordered = false;
+    pid.chunks.push_back(chunk);
+
+    beginTime_ = std::min<std::size_t>(beginTime_, chunk.minTime);
+    endTime_ = std::max<std::size_t>(endTime_, chunk.maxTime);
+}
+
+std::size_t DataLogReader::size(uint16_t code) const noexcept
+{
+    auto it = chunks_.find(code);
+    if (it == chunks_.end())
+        return 0;
+
+    std::size_t size = 0;
+    for (const ChunkInfo & chunk : it->second.chunks)
+        size += chunk.count;
+    return size;
+}
+
+void DataLogReader::decodeChunk(const ChunkInfo & chunk, std::vector<PidLogEntry> & out) const
+{
+    std::span<const uint8_t> bytes = file_->bytes();
+    if (chunk.offset + record_header_size > bytes.size() || bytes[chunk.offset] != record_chunk)
+        Decoder::corrupt();
+    std::size_t size = get32(&bytes[chunk.offset + 1]);
+    if (size > bytes.size() - chunk.offset - record_header_size)
+        Decoder::corrupt();
+
+    Decoder decoder(&bytes[chunk.offset + record_header_size], size);
+    ChunkHeader header = readChunkHeader(decoder);
+    if (header.count > size)
+        Decoder::corrupt();
+
+    out.clear();
+    out.reserve(header.count);
+    uint64_t time = 0, bits = 0;
+    for (uint64_t i = 0; i < header.count; ++i)
+    {
+        time += static_cast<uint64_t>(unzigzag(decoder.varint()));
+        bits ^= decoder.value();
+        out.push_back(PidLogEntry{std::bit_cast<double>(bits), static_cast<std::size_t>(time)});
+    }
+}
+
+DataLogReader::Cursor::Cursor(const DataLogReader & reader, const std::vector<ChunkInfo> * chunks, bool ordered,
+                              std::size_t begin, std::size_t end)
+    : reader_(reader), chunks_(chunks), ordered_(ordered), begin_(begin), end_(end)
+{
+    if (chunks_ != nullptr && ordered_)
+    {
+        // Skips the chunks that end before `begin`
+        chunk_ = static_cast<std::size_t>(
+            std::partition_point(chunks_->begin(), chunks_->end(),
+                                 [begin](const ChunkInfo & chunk) { return chunk.maxTime < begin; }) -
+            chunks_->begin());
+    }
+}
+
+bool DataLogReader::Cursor::next(PidLogEntry & entry)
+{
+    for (;;)
+    {
+        while (position_ < decoded_.size())
+        {
+            const PidLogEntry & next = decoded_[position_++];
+            if (next.time >= begin_ && next.time < end_)
+            {
+                entry = next;
+                return true;
+            }
+        }
+
+        if (chunks_ == nullptr || chunk_ == chunks_->size())
+            return false;
+
+        const ChunkInfo & chunk = (*chunks_)[chunk_++];
+        if (ordered_ && chunk.minTime >= end_)
+        {
+            chunk_ = chunks_->size();
+            return false;
+        }
+        if (chunk.maxTime < begin_ || chunk.minTime >= end_)
+            continue;
+
+        reader_.decodeChunk(chunk, decoded_);
+        position_ = 0;
+    }
+}
+
+DataLogReader::Cursor DataLogReader::cursor(uint16_t code, std::size_t begin, std::size_t end) const
+{
+    auto it = chunks_.find(code);
+    if (it == chunks_.end())
+        return Cursor(*this, nullptr, true, begin, end);
+    return Cursor(*this, &it->second.chunks, it->second.ordered, begin, end);
+}
+
+std::vector<PidLogEntry> DataLogReader::read(uint16_t code, std::size_t begin, std::size_t end) const
+{
+    std::vector<PidLogEntry> entries;
+    Cursor entryCursor = cursor(code, begin, end);
+    PidLogEntry entry;
+    while (entryCursor.next(entry))
+        entries.push_back(entry);
+    return entries;
+}
+
+DataLogPtr DataLogReader::load() const
+{
+    auto log = std::make_shared<DataLog>();
+    log->setName(name_);
+    for (const Pid & pid : pids_)
+    {
+        log->addPid(pid);
+        Cursor entryCursor = cursor(pid.code);
+        PidLogEntry entry;
+        while (entryCursor.next(entry))
+            log->add(pid, entry);
+    }
+    return log;
+}
+
+void exportCsv(const DataLogReader & reader, std::ostream & out, std::size_t begin, std::size_t end)
+{
+    const std::vector<Pid> & pids = reader.pids();
+
+    out << "time";
+    for (const Pid & pid : pids)
+    {
+        // Quotes double inside quoted fields
+        std::string name = pid.unit.empty() ? pid.name : pid.name + " (" + pid.unit + ")";
+        for (std::size_t i = name.find('"'); i != std::string::npos; i = name.find('"', i + 2))
+            name.insert(i, 1, '"');
+        out << ",\"" << name << '"';
+    }
+    out << '\n';
+
+    std::vector<DataLogReader::Cursor> cursors;
+    std::vector<PidLogEntry> next(pids.size());
+    std::vector<bool> more(pids.size());
+    cursors.reserve(pids.size());
+    for (std::size_t i = 0; i < pids.size(); ++i)
+    {
+        cursors.push_back(reader.cursor(pids[i].code, begin, end));
+        more[i] = cursors[i].next(next[i]);
+    }
+
+    // Shortest text that reads back to the same double
+    std::array<char, 32> number;
+    auto write = [&out, &number](double value) {
+        auto result = std::to_chars(number.data(), number.data() + number.size(), value);
+        out.write(number.data(), result.ptr - number.data());
+    };
+
+    for (;;)
+    {
+        std::size_t time = std::numeric_limits<std::size_t>::max();
+        bool any = false;
+        for (std::size_t i = 0; i < pids.size(); ++i)
+        {
+            if (more[i])
+            {
+                time = std::min(time, next[i].time);
+                any = true;
+            }
+        }
+        if (!any)
+            break;
+
+        write(static_cast<double>(time) / 1000.0);
+        for (std::size_t i = 0; i < pids.size(); ++i)
+        {
+            out << ',';
+            if (more[i] && next[i].time == time)
+            {
+                write(next[i].value);
+                more[i] = cursors[i].next(next[i]);
+            }
+        }
+        out << '\n';
+    }
+
+    if (!out)
+        throw std::runtime_error("failed to write CSV");
+}
+
+} // namespace lt
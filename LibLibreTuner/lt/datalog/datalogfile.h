@@ -0,0 +1,188 @@
+#ifndef LT_DATALOGFILE_H
+#define LT_DATALOGFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../support/mappedfile.h"
+#include "datalog.h"
+
+namespace lt
+{
+
+/* Datalog files are append-only. All integers are little endian:
+ *   "LTLG" version:u32
+ *   records: kind:u8 size:u32 payload[size]
+ *   trailer: indexOffset:u64 "LTLX" reserved:u32
+ *
+ * Record payloads use LEB128 varints (v) and length-prefixed strings (s):
+ *   Name:  s
+ *   Pid:   code:v name:s description:s formula:s unit:s
+ *   Chunk: code:v count:v minTime:v maxTime:v entries
+ *   Index: name:s pidCount:v (Pid payload)... chunkCount:v
+ *          (offset:v code:v count:v minTime:v maxTime:v)...
+ *
+ * Chunk entries hold the time as a zigzag varint delta from the previous
+ * entry and the value XORed with the bits of the previous value, stored
+ * as a byte giving the zero bytes on each side (0x80 for no change)
+ * followed by the bytes between them. The index and trailer are written
+ * on close. A file without them, e.g. after a crash, is recovered by
+ * scanning the record headers. */
+
+/* Writes a datalog file while logging. Entries are buffered per PID and
+ * written as a chunk of entries_per_chunk entries; at most that many per
+ * PID are lost if the program stops without closing the writer.
+ * Thread-safe. */
+class DataLogWriter
+{
+public:
+    static constexpr std::size_t entries_per_chunk = 1024;
+
+    // Creates the file at `path`, replacing any existing file
+    DataLogWriter(const std::filesystem::path & path, const std::string & name);
+
+    // Closes the file. Errors are ignored; call close() to see them.
+    ~DataLogWriter();
+
+    DataLogWriter(const DataLogWriter &) = delete;
+    DataLogWriter & operator=(const DataLogWriter &) = delete;
+
+    // Adds an entry. Throws an exception after close().
+    void add(const Pid & pid, const PidLogEntry & entry);
+
+    // Writes the buffered entries of all PIDs as chunks
+    void flush();
+
+    // Flushes and writes the index. Calls after the first do nothing.
+    void close();
+
+    inline const std::filesystem::path & path() const noexcept { return path_; }
+
+private:
+    struct ChunkInfo
+    {
+        uint64_t offset;
+        uint16_t code;
+        uint64_t count, minTime, maxTime;
+    };
+
+    std::mutex mutex_;
+    std::filesystem::path path_;
+    std::ofstream file_;
+    uint64_t position_{0};
+    std::string name_;
+    std::vector<Pid> pids_;
+    std::unordered_map<uint16_t, std::vector<PidLogEntry>> buffers_;
+    std::vector<ChunkInfo> chunks_;
+    bool closed_{false};
+
+    void writeRecord(uint8_t kind, const std::string & payload);
+    void writeChunk(uint16_t code, std::vector<PidLogEntry> & entries);
+    void flushLocked();
+};
+
+// Writes every entry of `log` to a new datalog file at `path`
+void saveDataLog(const DataLog & log, const std::filesystem::path & path);
+
+/* Reads a datalog file. The file is mapped, and only the index, or the
+ * record headers of an unclosed file, is read on opening; entries are
+ * decoded one chunk at a time as they are read. */
+class DataLogReader
+{
+public:
+    // Throws an exception if the file is not a datalog file
+    explicit DataLogReader(const std::filesystem::path & path);
+
+    inline const std::string & name() const noexcept { return name_; }
+    inline const std::vector<Pid> & pids() const noexcept { return pids_; }
+
+    // False if the file was not closed and its index was rebuilt
+    inline bool complete() const noexcept { return complete_; }
+
+    // Times of the first and last entries of all PIDs. Zero if empty.
+    inline std::size_t beginTime() const noexcept { return beginTime_; }
+    inline std::size_t endTime() const noexcept { return endTime_; }
+
+    // Amount of entries of PID `code`
+    std::size_t size(uint16_t code) const noexcept;
+
+    struct ChunkInfo
+    {
+        uint64_t offset;
+        uint64_t count, minTime, maxTime;
+    };
+
+    // Reads the entries of one PID with times in [begin, end) in order
+    class Cursor
+    {
+    public:
+        // Returns false after the last entry
+        bool next(PidLogEntry & entry);
+
+    private:
+        friend class DataLogReader;
+        Cursor(const DataLogReader & reader, const std::vector<ChunkInfo> * chunks, bool ordered, std::size_t begin,
+               std::size_t end);
+
+        const DataLogReader & reader_;
+        const std::vector<ChunkInfo> * chunks_;
+        bool ordered_;
+        std::size_t begin_, end_;
+        std::size_t chunk_{0};
+        std::vector<PidLogEntry> decoded_;
+        std::size_t position_{0};
+    };
+
+    /* Returns a cursor over the entries of PID `code` with times in
+     * [begin, end). Chunks before `begin` are skipped without decoding.
+     * An unknown PID has no entries. */
+    Cursor cursor(uint16_t code, std::size_t begin = 0,
+                  std::size_t end = std::numeric_limits<std::size_t>::max()) const;
+
+    // Same as cursor(), collected into a vector
+    std::vector<PidLogEntry> read(uint16_t code, std::size_t begin = 0,
+                                  std::size_t end = std::numeric_limits<std::size_t>::max()) const;
+
+    // Loads the whole file into a new DataLog
+    DataLogPtr load() const;
+
+private:
+    struct PidChunks
+    {
+        std::vector<ChunkInfo> chunks;
+        // True if every chunk starts at or after the end of the last
+        bool ordered{true};
+    };
+
+    MappedFilePtr file_;
+    std::string name_;
+    std::vector<Pid> pids_;
+    std::unordered_map<uint16_t, PidChunks> chunks_;
+    std::size_t beginTime_{0}, endTime_{0};
+    bool complete_{false};
+
+    bool readIndex();
+    void scanRecords();
+    void addChunk(uint16_t code, const ChunkInfo & chunk);
+    void decodeChunk(const ChunkInfo & chunk, std::vector<PidLogEntry> & out) const;
+};
+
+/* Writes the entries of `reader` with times in [begin, end) as CSV: a
+ * row per distinct time, in seconds, with a column per PID, headed by its
+ * name and unit, that is empty where the PID has no entry at that time.
+ * Streams one chunk per PID at a time. Entries of each PID must be in time
+ * order. */
+void exportCsv(const DataLogReader & reader, std::ostream & out, std::size_t begin = 0,
+               std::size_t end = std::numeric_limits<std::size_t>::max());
+
+} // namespace lt
+
+#endif // LT_DATALOGFILE_H
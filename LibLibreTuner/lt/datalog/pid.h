@@ -8,7 +8,7 @@ namespace lt
 {
 struct Pid
 {
-    uint16_t code;
+    uint16_t code{0};
     std::string name;
     std::string description;
     std::string formula;
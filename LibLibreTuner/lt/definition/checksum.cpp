@@ -16,10 +16,16 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <stdexcept>
 
 #include "checksum.h"
+#include "support/crc16.h"
+#include "support/crc32.h"
+#include "support/parallelfor.h"
 #include "support/util.hpp"
+#include "support/wordsum.h"
 
 namespace lt
 {
@@ -29,9 +35,7 @@ void Checksum::addModifiable(int offset, int size)
     modifiable_.emplace_back(offset, size);
 }
 
-Checksum::~Checksum() = default;
-
-uint32_t ChecksumBasic::compute(const uint8_t * data, int size, bool * ok) const
+uint32_t Checksum::compute(const uint8_t * data, int size, bool * ok) const
 {
     assert(size >= 0);
     if (size < offset_ + size_)
@@ -41,45 +45,66 @@ uint32_t ChecksumBasic::compute(const uint8_t * data, int size, bool * ok) const
         return 0;
     }
 
-    data += offset_;
-    size -= offset_;
-
-    uint32_t sum = 0;
-    // Add up the big endian int32s
-    for (int i = 0; i < size_ / 4; ++i, data += 4)
-    {
-        sum += readBE<int32_t>(data, data + size);
-    }
-
     if (ok != nullptr)
     {
         *ok = true;
     }
-    return sum;
+    return finish(partial(data + offset_, static_cast<std::size_t>(size_)));
 }
 
-void ChecksumBasic::correct(uint8_t * data, int size) const
+ChecksumResult Checksum::verify(const uint8_t * data, int size) const
+{
+    ChecksumResult result;
+    result.target = target_;
+    result.value = compute(data, size, &result.inRange);
+    return result;
+}
+
+void Checksum::checkRegion(int size) const
 {
     assert(size >= 0);
     if (size < offset_ + size_)
         throw std::runtime_error("checksum region exceeds the rom size.");
+}
 
-    bool foundMod = false;
-    int modifiableOffset{0};
+void Checksum::checkCorrected(const uint8_t * data, int size) const
+{
+    if (compute(data, size, nullptr) != target_)
+    {
+        throw std::runtime_error(
+            "checksum does not equal target after correction");
+    }
+}
 
-    // Find a usable modifiable region
-    for (const auto & it : modifiable_)
+int Checksum::findModifiable(int width, int alignment) const
+{
+    assert(alignment > 0);
+    for (const auto & [offset, size] : modifiable_)
     {
-        if (it.second >= 4)
-        {
-            modifiableOffset = it.first;
-            foundMod = true;
-            break;
-        }
+        if (offset < 0)
+            continue;
+        int aligned = (offset + alignment - 1) / alignment * alignment;
+        if (aligned + width <= offset + size && aligned + width <= size_)
+            return aligned;
     }
-    if (!foundMod)
-        throw std::runtime_error("failed to find a usable modifiable region "
-                                 "for checksum correction.");
+    throw std::runtime_error("failed to find a usable modifiable region "
+                             "for checksum correction.");
+}
+
+Checksum::~Checksum() = default;
+
+uint32_t ChecksumBasic::partial(const uint8_t * data, std::size_t size) const
+    noexcept
+{
+    // Add up the big endian int32s
+    return sumBE32(data, size / 4);
+}
+
+void ChecksumBasic::correct(uint8_t * data, int size) const
+{
+    checkRegion(size);
+    // An aligned word is one term of the sum
+    int modifiableOffset = findModifiable(4, 4);
 
     // Zero the region
     writeBE<int32_t>(0, &data[offset_ + modifiableOffset], data + size);
@@ -90,12 +115,105 @@ void ChecksumBasic::correct(uint8_t * data, int size) const
     uint32_t val = target_ - oSum;
     writeBE<int32_t>(val, &data[offset_ + modifiableOffset], data + size);
 
-    // Check if the correction was successful
-    if (compute(data, size, nullptr) != target_)
-    {
-        throw std::runtime_error(
-            "checksum does not equal target after correction");
-    }
+#ifndef NDEBUG
+    checkCorrected(data, size);
+#endif
+}
+
+uint32_t ChecksumAdd16::partial(const uint8_t * data, std::size_t size) const
+    noexcept
+{
+    return sumBE16(data, size / 2);
+}
+
+void ChecksumAdd16::correct(uint8_t * data, int size) const
+{
+    checkRegion(size);
+    int modifiableOffset = findModifiable(2, 2);
+
+    writeBE<uint16_t>(0, &data[offset_ + modifiableOffset], data + size);
+    uint32_t val = target_ - compute(data, size, nullptr);
+    writeBE<uint16_t>(static_cast<uint16_t>(val),
+                      &data[offset_ + modifiableOffset], data + size);
+
+#ifndef NDEBUG
+    checkCorrected(data, size);
+#endif
+}
+
+uint32_t ChecksumXor::partial(const uint8_t * data, std::size_t size) const
+    noexcept
+{
+    return xorBE32(data, size / 4);
+}
+
+void ChecksumXor::correct(uint8_t * data, int size) const
+{
+    checkRegion(size);
+    int modifiableOffset = findModifiable(4, 4);
+
+    writeBE<int32_t>(0, &data[offset_ + modifiableOffset], data + size);
+    uint32_t val = target_ ^ compute(data, size, nullptr);
+    writeBE<int32_t>(val, &data[offset_ + modifiableOffset], data + size);
+
+#ifndef NDEBUG
+    checkCorrected(data, size);
+#endif
+}
+
+uint32_t ChecksumCrc32::partial(const uint8_t * data, std::size_t size) const
+    noexcept
+{
+    return crc32(data, size);
+}
+
+void ChecksumCrc32::correct(uint8_t * data, int size) const
+{
+    checkRegion(size);
+    int modifiableOffset = findModifiable(4);
+    uint8_t * region = data + offset_;
+    uint8_t * word = region + modifiableOffset;
+    uint8_t * rest = word + 4;
+
+    /* The CRC register after the word must be the one that the remaining
+     * bytes turn into the target. Running the register back over four
+     * zero bytes gives the register that, XORed with the word, produces
+     * it from the register before the word. */
+    uint32_t before = crc32(region, modifiableOffset);
+    uint32_t after = crc32Rewind(rest, size_ - modifiableOffset - 4, target_);
+    const uint8_t zeros[4] = {};
+    uint32_t val = before ^ crc32Rewind(zeros, 4, after);
+    SConverter<uint32_t, 4>::writeLE(val, word);
+
+    checkCorrected(data, size);
+}
+
+uint32_t ChecksumCrc16::partial(const uint8_t * data, std::size_t size) const
+    noexcept
+{
+    return crc16Ccitt(data, size);
+}
+
+void ChecksumCrc16::correct(uint8_t * data, int size) const
+{
+    checkRegion(size);
+    if (target_ > 0xFFFF)
+        throw std::runtime_error("CRC-16 checksum target exceeds 16 bits");
+    int modifiableOffset = findModifiable(2);
+    uint8_t * region = data + offset_;
+    uint8_t * word = region + modifiableOffset;
+    uint8_t * rest = word + 2;
+
+    // Solved the same way as ChecksumCrc32, but the register is not
+    // reflected, so the word is big endian
+    uint16_t before = crc16Ccitt(region, modifiableOffset);
+    uint16_t after = crc16CcittRewind(rest, size_ - modifiableOffset - 2,
+                                      static_cast<uint16_t>(target_));
+    const uint8_t zeros[2] = {};
+    uint16_t val = before ^ crc16CcittRewind(zeros, 2, after);
+    writeBE<uint16_t>(val, word, data + size);
+
+    checkCorrected(data, size);
 }
 
 void Checksums::correct(uint8_t * data, size_t size)
@@ -106,4 +224,56 @@ void Checksums::correct(uint8_t * data, size_t size)
     }
 }
 
+std::vector<ChecksumResult> Checksums::verify(const uint8_t * data,
+                                              size_t size) const
+{
+    std::vector<ChecksumResult> results(checksums_.size());
+    std::size_t bytes = 0;
+    for (const ChecksumPtr & checksum : checksums_)
+        bytes += static_cast<std::size_t>(std::max(checksum->size(), 0));
+    parallelFor(checksums_.size(), bytes, [&](std::size_t i) {
+        results[i] = checksums_[i]->verify(data, static_cast<int>(size));
+    });
+    return results;
+}
+
+namespace
+{
+template <typename T> ChecksumFactory factory()
+{
+    return [](int offset, int size, uint32_t target) -> ChecksumPtr {
+        return std::make_unique<T>(offset, size, target);
+    };
+}
+} // namespace
+
+ChecksumRegistry::ChecksumRegistry()
+{
+    add("basic", factory<ChecksumBasic>());
+    add("add16", factory<ChecksumAdd16>());
+    add("xor", factory<ChecksumXor>());
+    add("crc32", factory<ChecksumCrc32>());
+    add("crc16-ccitt", factory<ChecksumCrc16>());
+}
+
+ChecksumRegistry & ChecksumRegistry::instance()
+{
+    static ChecksumRegistry registry;
+    return registry;
+}
+
+void ChecksumRegistry::add(const std::string & name, ChecksumFactory factory)
+{
+    factories_[name] = std::move(factory);
+}
+
+ChecksumPtr ChecksumRegistry::create(const std::string & name, int offset,
+                                     int size, uint32_t target) const
+{
+    auto it = factories_.find(name);
+    if (it == factories_.end())
+        throw std::runtime_error("invalid mode for checksum: " + name);
+    return it->second(offset, size, target);
+}
+
 } // namespace lt
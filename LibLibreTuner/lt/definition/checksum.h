@@ -20,16 +20,39 @@
 #define LT_CHECKSUM_H
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace lt
 {
 
+// Outcome of verifying one checksum
+struct ChecksumResult
+{
+    // Computed value. Zero if the region exceeds the data.
+    uint32_t value{0};
+    uint32_t target{0};
+    bool inRange{false};
+
+    inline bool ok() const noexcept { return inRange && value == target; }
+};
+
 class Checksum
 {
 public:
+    // How the partial() values of consecutive pieces of a region combine
+    enum class Combine
+    {
+        // Only the whole region can be computed
+        None,
+        // Sum modulo 2^32
+        Add,
+        Xor,
+    };
+
     Checksum(int offset, int size, uint32_t target)
         : offset_(offset), size_(size), target_(target)
     {
@@ -44,7 +67,26 @@ public:
     /* Returns the computed checksum. If length is too small,
      * returns 0 and sets ok to false.*/
     virtual uint32_t compute(const uint8_t * data, int size,
-                             bool * ok = nullptr) const = 0;
+                             bool * ok = nullptr) const;
+
+    // Computes the checksum and compares it to the target
+    ChecksumResult verify(const uint8_t * data, int size) const;
+
+    /* Returns the value of `size` bytes of the region starting at `data`.
+     * finish() of the value of the whole region is the checksum. Unless
+     * combine() is None, pieces can be computed separately and combined;
+     * each must start a multiple of 4 bytes into the region. */
+    virtual uint32_t partial(const uint8_t * data, std::size_t size) const
+        noexcept = 0;
+
+    virtual Combine combine() const noexcept { return Combine::None; }
+
+    // Maps the combined partial() values to the checksum
+    virtual uint32_t finish(uint32_t value) const noexcept { return value; }
+
+    inline int offset() const noexcept { return offset_; }
+    inline int size() const noexcept { return size_; }
+    inline uint32_t target() const noexcept { return target_; }
 
     virtual ~Checksum();
 
@@ -54,10 +96,22 @@ protected:
     uint32_t target_;
 
     std::vector<std::pair<int, int>> modifiable_;
+
+    // Throws an exception if the region exceeds `size` bytes of data
+    void checkRegion(int size) const;
+
+    /* Throws an exception if a correction missed the target. The sums
+     * derive the word exactly and only check in debug builds. */
+    void checkCorrected(const uint8_t * data, int size) const;
+
+    /* Returns the first offset, relative to the region and a multiple of
+     * `alignment`, of `width` modifiable bytes inside the region. Throws an
+     * exception if there is none. */
+    int findModifiable(int width, int alignment = 1) const;
 };
 using ChecksumPtr = std::unique_ptr<Checksum>;
 
-/* Basic type checksum */
+/* Basic type checksum: the sum of the big endian 32-bit words */
 class ChecksumBasic : public Checksum
 {
 public:
@@ -66,9 +120,67 @@ public:
     {
     }
 
-    uint32_t compute(const uint8_t * data, int size, bool * ok) const override;
+    void correct(uint8_t * data, int size) const override;
+
+    uint32_t partial(const uint8_t * data, std::size_t size) const
+        noexcept override;
+    Combine combine() const noexcept override { return Combine::Add; }
+};
+
+/* The sum of the big endian 16-bit words, truncated to 16 bits */
+class ChecksumAdd16 : public Checksum
+{
+public:
+    using Checksum::Checksum;
+
+    void correct(uint8_t * data, int size) const override;
+
+    uint32_t partial(const uint8_t * data, std::size_t size) const
+        noexcept override;
+    Combine combine() const noexcept override { return Combine::Add; }
+    uint32_t finish(uint32_t value) const noexcept override
+    {
+        return value & 0xFFFF;
+    }
+};
+
+/* The XOR of the big endian 32-bit words */
+class ChecksumXor : public Checksum
+{
+public:
+    using Checksum::Checksum;
+
+    void correct(uint8_t * data, int size) const override;
+
+    uint32_t partial(const uint8_t * data, std::size_t size) const
+        noexcept override;
+    Combine combine() const noexcept override { return Combine::Xor; }
+};
+
+/* CRC-32 of the region as computed by crc32(). Corrected by solving for
+ * a 4-byte modifiable section. */
+class ChecksumCrc32 : public Checksum
+{
+public:
+    using Checksum::Checksum;
 
     void correct(uint8_t * data, int size) const override;
+
+    uint32_t partial(const uint8_t * data, std::size_t size) const
+        noexcept override;
+};
+
+/* CRC-16/CCITT of the region as computed by crc16Ccitt(). Corrected by
+ * solving for a 2-byte modifiable section. */
+class ChecksumCrc16 : public Checksum
+{
+public:
+    using Checksum::Checksum;
+
+    void correct(uint8_t * data, int size) const override;
+
+    uint32_t partial(const uint8_t * data, std::size_t size) const
+        noexcept override;
 };
 
 /**
@@ -87,10 +199,49 @@ public:
      * Returns (false, errmsg) on failure and (true, "") on success. */
     void correct(uint8_t * data, size_t size);
 
+    /* Computes every checksum without modifying the data. Returns one
+     * result per checksum, in order. The regions are computed in
+     * parallel. */
+    std::vector<ChecksumResult> verify(const uint8_t * data,
+                                       size_t size) const;
+
+    inline std::size_t size() const noexcept { return checksums_.size(); }
+    inline const Checksum & operator[](std::size_t index) const
+    {
+        return *checksums_[index];
+    }
+
 private:
     std::vector<ChecksumPtr> checksums_;
 };
 
+using ChecksumFactory =
+    std::function<ChecksumPtr(int offset, int size, uint32_t target)>;
+
+/* Checksum algorithms by the "mode" name definitions use for them. The
+ * built-in algorithms are "basic", "add16", "xor", "crc32" and
+ * "crc16-ccitt". */
+class ChecksumRegistry
+{
+public:
+    // The registry used when loading definitions
+    static ChecksumRegistry & instance();
+
+    /* Adds or replaces an algorithm. Not thread-safe; register algorithms
+     * before loading definitions. */
+    void add(const std::string & name, ChecksumFactory factory);
+
+    /* Creates a checksum of algorithm `name`. Throws an exception if the
+     * name is unknown. */
+    ChecksumPtr create(const std::string & name, int offset, int size,
+                       uint32_t target) const;
+
+private:
+    ChecksumRegistry();
+
+    std::unordered_map<std::string, ChecksumFactory> factories_;
+};
+
 } // namespace lt
 
 #endif // LT_CHECKSUM_H
@@ -0,0 +1,136 @@
+#include "definitioncache.h"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace lt
+{
+
+namespace
+{
+// Bumped when the cache layout changes
+constexpr uint32_t cache_version = 1;
+} // namespace
+
+DefinitionCache::DefinitionCache(fs::path path) : path_(std::move(path))
+{
+    if (path_.empty())
+        return;
+
+    std::ifstream file(path_, std::ios::binary | std::ios::in);
+    if (!file.is_open())
+        return;
+
+    try
+    {
+        cereal::BinaryInputArchive archive(file);
+        uint32_t version = 0;
+        archive(version);
+        if (version == cache_version)
+            archive(entries_);
+    }
+    catch (const std::exception &)
+    {
+        // A damaged cache is rebuilt from the definitions
+        entries_.clear();
+    }
+}
+
+json DefinitionCache::parse(const fs::path & file)
+{
+    if (!fs::is_regular_file(file))
+    {
+        throw std::runtime_error("file '" + file.string() +
+                                 "' does not exist or LibreTuner does not have "
+                                 "permission to open it.");
+    }
+
+    const std::string key = file.string();
+    const uint64_t size = fs::file_size(file);
+    const int64_t modified = static_cast<int64_t>(fs::last_write_time(file).time_since_epoch().count());
+
+    if (!path_.empty())
+    {
+        const std::vector<uint8_t> * cbor = nullptr;
+        {
+            std::lock_guard lock(mutex_);
+            if (auto it = entries_.find(key);
+                it != entries_.end() && it->second.size == size && it->second.modified == modified)
+            {
+                it->second.used = true;
+                cbor = &it->second.cbor;
+            }
+        }
+        // Adding entries for other files does not move this one
+        if (cbor != nullptr)
+            return json::from_cbor(*cbor);
+    }
+
+    std::ifstream stream(file);
+    if (!stream.is_open())
+        throw std::runtime_error("failed to open '" + file.string() + "'");
+    json parsed = json::parse(stream);
+
+    if (!path_.empty())
+    {
+        Entry entry;
+        entry.size = size;
+        entry.modified = modified;
+        entry.cbor = json::to_cbor(parsed);
+        entry.used = true;
+
+        std::lock_guard lock(mutex_);
+        entries_[key] = std::move(entry);
+        changed_ = true;
+    }
+    return parsed;
+}
+
+void DefinitionCache::save()
+{
+    if (path_.empty())
+        return;
+
+    std::lock_guard lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        if (it->second.used)
+            ++it;
+        else
+        {
+            it = entries_.erase(it);
+            changed_ = true;
+        }
+    }
+    if (!changed_)
+        return;
+
+    // The cache only saves time. If it cannot be written, the next start
+    // parses the definitions again.
+    std::error_code ec;
+    fs::create_directories(path_.parent_path(), ec);
+    fs::path temporary = path_;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            return;
+        cereal::BinaryOutputArchive archive(file);
+        archive(cache_version, entries_);
+        if (!file.flush())
+            return;
+    }
+    fs::rename(temporary, path_, ec);
+    changed_ = false;
+}
+
+} // namespace lt
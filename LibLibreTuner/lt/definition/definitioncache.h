@@ -0,0 +1,53 @@
+#ifndef LT_DEFINITIONCACHE_H
+#define LT_DEFINITIONCACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace lt
+{
+
+/* Parsed definition files stored as CBOR, which loads several times faster
+ * than JSON text. Files are matched by path, size and modification time,
+ * so an edited file is parsed again and the rest come from the cache. */
+class DefinitionCache
+{
+public:
+    // Loads the cache at `path` if it exists. An empty path disables it.
+    explicit DefinitionCache(std::filesystem::path path);
+
+    /* Returns the parsed JSON of `file`. Throws an exception if it cannot
+     * be read or parsed. May be called from several threads. */
+    nlohmann::json parse(const std::filesystem::path & file);
+
+    /* Writes the cache if a file was parsed from text. Drops the entries
+     * of files that were not asked for since loading. */
+    void save();
+
+private:
+    struct Entry
+    {
+        uint64_t size{0};
+        int64_t modified{0};
+        std::vector<uint8_t> cbor;
+        bool used{false};
+
+        template <class Archive> void serialize(Archive & archive) { archive(size, modified, cbor); }
+    };
+
+    std::filesystem::path path_;
+    std::mutex mutex_;
+    // Keyed by file path
+    std::unordered_map<std::string, Entry> entries_;
+    bool changed_{false};
+};
+
+} // namespace lt
+
+#endif // LT_DEFINITIONCACHE_H
@@ -0,0 +1,85 @@
+#include "identifierindex.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace lt
+{
+
+namespace
+{
+using PositionKey = std::pair<uint32_t, std::size_t>;
+
+inline PositionKey positionOf(const Identifier & identifier) { return {identifier.offset(), identifier.size()}; }
+
+inline std::string_view bytesOf(const uint8_t * data, std::size_t size)
+{
+    return std::string_view(reinterpret_cast<const char *>(data), size);
+}
+} // namespace
+
+IdentifierIndex::IdentifierIndex(const std::vector<ModelPtr> & models) : models_(models)
+{
+    // How many models use each position
+    std::map<PositionKey, std::size_t> uses;
+    for (const ModelPtr & model : models_)
+    {
+        for (const Identifier & identifier : model->identifiers)
+            ++uses[positionOf(identifier)];
+    }
+
+    std::map<PositionKey, std::size_t> indices;
+    for (std::size_t index = 0; index < models_.size(); ++index)
+    {
+        const std::vector<Identifier> & identifiers = models_[index]->identifiers;
+        // Unidentifiable
+        if (identifiers.empty())
+            continue;
+
+        // File the model under the most common position, so most models
+        // share a few positions
+        const Identifier & key = *std::max_element(
+            identifiers.begin(), identifiers.end(), [&uses](const Identifier & a, const Identifier & b) {
+                return uses[positionOf(a)] < uses[positionOf(b)];
+            });
+
+        auto [it, inserted] = indices.emplace(positionOf(key), positions_.size());
+        if (inserted)
+            positions_.push_back(Position{key.offset(), key.size(), {}});
+        positions_[it->second].models[std::string(bytesOf(key.data(), key.size()))].push_back(index);
+    }
+}
+
+ModelPtr IdentifierIndex::identify(const uint8_t * data, std::size_t size) const noexcept
+{
+    // Models are returned in their original order, so the candidate with
+    // the lowest index wins
+    std::size_t best = models_.size();
+    for (const Position & position : positions_)
+    {
+        if (position.offset + position.size > size)
+            continue;
+
+        auto it = position.models.find(bytesOf(data + position.offset, position.size));
+        if (it == position.models.end())
+            continue;
+
+        for (std::size_t index : it->second)
+        {
+            if (index >= best)
+                break;
+            if (models_[index]->isModel(data, size))
+            {
+                best = index;
+                break;
+            }
+        }
+    }
+
+    if (best == models_.size())
+        return ModelPtr();
+    return models_[best];
+}
+
+} // namespace lt
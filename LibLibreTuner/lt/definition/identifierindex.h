@@ -0,0 +1,64 @@
+#ifndef LT_IDENTIFIERINDEX_H
+#define LT_IDENTIFIERINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "model.h"
+
+namespace lt
+{
+
+/* Finds the model that matches some data without comparing every model.
+ * Each model is filed under the one of its identifiers whose position
+ * (offset and size) the most models use, which keeps the number of
+ * distinct positions small. Identifying is then one hash lookup per
+ * position plus a full check of the candidates found. */
+class IdentifierIndex
+{
+public:
+    IdentifierIndex() = default;
+
+    /* Indexes `models`. The index keeps its own copy of the identifier
+     * bytes, but results are only right while the models' identifiers are
+     * unchanged. */
+    explicit IdentifierIndex(const std::vector<ModelPtr> & models);
+
+    /* Returns the first model, in the order given to the constructor,
+     * that matches `data`. Returns nullptr if none match. */
+    ModelPtr identify(const uint8_t * data, std::size_t size) const noexcept;
+
+    // Returns true if the index was built from exactly `models`
+    inline bool indexes(const std::vector<ModelPtr> & models) const noexcept { return models_ == models; }
+
+    // Number of hash lookups per identify() call
+    inline std::size_t positionCount() const noexcept { return positions_.size(); }
+
+private:
+    // Lets the maps be searched with a string_view of the data
+    struct KeyHash
+    {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key); }
+    };
+
+    struct Position
+    {
+        uint32_t offset;
+        std::size_t size;
+        // Identifier bytes to indices of models_
+        std::unordered_map<std::string, std::vector<std::size_t>, KeyHash, std::equal_to<>> models;
+    };
+
+    std::vector<ModelPtr> models_;
+    std::vector<Position> positions_;
+};
+
+} // namespace lt
+
+#endif // LT_IDENTIFIERINDEX_H
@@ -3,7 +3,7 @@
 namespace lt
 {
 
-const TableDefinition * Model::getTable(const std::string & tableId) const
+const ModelTable * Model::getTable(const std::string & tableId) const
 {
     if (auto it = tables.find(tableId); it != tables.end())
     {
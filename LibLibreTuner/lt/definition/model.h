@@ -36,6 +36,14 @@ private:
     std::vector<uint8_t> data_;
 };
 
+/* A platform table placed at a model's offset. The definition belongs to
+ * the platform, so models share it instead of each holding a copy. */
+struct ModelTable
+{
+    const TableDefinition * definition;
+    int offset;
+};
+
 /* Model definition. Includes the table locations */
 struct Model
 {
@@ -50,8 +58,8 @@ public:
     std::string name;
     Checksums checksums;
 
-    /* Tables */
-    std::unordered_map<std::string, TableDefinition> tables;
+    /* Tables. The definitions are valid while the platform exists. */
+    std::unordered_map<std::string, ModelTable> tables;
 
     // TODO: inheritance-based system like tables.
     std::unordered_map<std::string, std::size_t> axisOffsets;
@@ -59,9 +67,9 @@ public:
     // Identifiers are unique to each model in a platform.
     std::vector<Identifier> identifiers;
 
-    /* Gets the table definition with id `id`. Returns
+    /* Gets the table with id `id`. Returns
      * nullptr if the table does not exist. */
-    const TableDefinition * getTable(const std::string & id) const;
+    const ModelTable * getTable(const std::string & id) const;
 
     std::size_t getAxisOffset(const std::string & id) const noexcept;
 
@@ -1,6 +1,9 @@
 #include "platform.h"
+#include "../support/parallelfor.h"
 #include "../support/util.hpp"
+#include "definitioncache.h"
 
+#include <algorithm>
 #include <fstream>
 #include <nlohmann/json.hpp>
 
@@ -19,11 +22,8 @@ struct adl_serializer<lt::ChecksumPtr>
         const auto size = j.at("size").get<std::size_t>();
         const auto target = j.at("target").get<std::size_t>();
 
-        lt::ChecksumPtr sum;
-        if (mode == "basic")
-            sum = lt::ChecksumPtr(new lt::ChecksumBasic(offset, size, target));
-        else
-            throw std::runtime_error("invalid mode for checksum");
+        lt::ChecksumPtr sum = lt::ChecksumRegistry::instance().create(
+            mode, offset, size, target);
 
         if (auto it = j.find("modify"); it != j.end())
         {
@@ -169,6 +169,21 @@ void from_json(const json & j, lt::Platform & platform)
             lt::lowercase_string(platform.downloadMode);
         }
         transfer->at("serverid").get_to(platform.serverId);
+        if (auto it = transfer->find("downloadchunksize");
+            it != transfer->end())
+            it->get_to(platform.downloadChunkSize);
+        if (auto it = transfer->find("rxblocksize"); it != transfer->end())
+            it->get_to(platform.rxBlockSize);
+        // In microseconds
+        if (auto it = transfer->find("rxseparationtime");
+            it != transfer->end())
+            platform.rxSeparationTime =
+                std::chrono::microseconds(it->get<uint32_t>());
+        if (auto it = transfer->find("adaptiveflowcontrol");
+            it != transfer->end())
+            it->get_to(platform.adaptiveFlowControl);
+        if (auto it = transfer->find("crcroutine"); it != transfer->end())
+            it->get_to(platform.flashCrcRoutine);
     }
 
     // Authentication
@@ -228,6 +243,8 @@ void from_json(const json & j, lt::Platform & platform)
     {
         fr->at("size").get_to(platform.flashSize);
         fr->at("offset").get_to(platform.flashOffset);
+        if (auto it = fr->find("sectorsize"); it != fr->end())
+            it->get_to(platform.flashSectorSize);
     }
 
     if (auto it = j.find("pids"); it != j.end())
@@ -259,8 +276,14 @@ const AxisDefinition * Platform::getAxis(const std::string & id) const noexcept
     return nullptr;
 }
 
+void Platform::indexModels() { identifierIndex = IdentifierIndex(models); }
+
 ModelPtr Platform::identify(const uint8_t * data, size_t size) const noexcept
 {
+    // An index of other models would miss or return stale models
+    if (identifierIndex.indexes(models))
+        return identifierIndex.identify(data, size);
+
     for (const ModelPtr & model : models)
     {
         if (model->isModel(data, size))
@@ -279,18 +302,9 @@ const Pid * Platform::getPid(uint32_t code) const noexcept
     return nullptr;
 }
 
-PlatformPtr load_main(const fs::path & path)
+PlatformPtr load_main(const fs::path & path, DefinitionCache & cache)
 {
-    std::ifstream file(path);
-    if (!file.is_open())
-    {
-        throw std::runtime_error("file '" + path.string() +
-                                 "' does not exist or LibreTuner does not have "
-                                 "permission to open it.");
-    }
-
-    json root;
-    file >> root;
+    json root = cache.parse(path);
     return std::make_shared<Platform>(root.get<Platform>());
 }
 
@@ -316,10 +330,8 @@ void decodeModel(const json & j,
             if (const TableDefinition * platformTable = platform->getTable(id);
                 platformTable != nullptr)
             {
-                // Copy table and set offset
-                TableDefinition table(*platformTable);
-                table.offset = offset;
-                model.tables.emplace(id, std::move(table));
+                model.tables.emplace(
+                    id, ModelTable{platformTable, offset.get<int>()});
             }
             else
             {
@@ -349,29 +361,56 @@ void decodeModel(const json & j,
     }
 }
 
-PlatformPtr Platform::loadDirectory(const std::filesystem::path & base_path)
+namespace
+{
+/* Loads a platform from each directory. The main files are parsed first,
+ * then the models of all platforms together, so a platform with many
+ * models does not hold up the rest. */
+std::vector<PlatformPtr> loadPlatforms(const std::vector<fs::path> & directories, DefinitionCache & cache)
 {
-    // Load main.json
-    PlatformPtr platform = load_main(base_path / "main.json");
+    std::vector<PlatformPtr> platforms(directories.size());
+    parallelFor(directories.size(),
+                [&](std::size_t i) { platforms[i] = load_main(directories[i] / "main.json", cache); });
 
-    // Load models
-    for (auto & entry : fs::directory_iterator(base_path))
+    struct ModelFile
     {
-        const fs::path & path = entry.path();
-        if (path.extension() != ".json" || path.filename() == "main.json" ||
-            !entry.is_regular_file())
+        std::size_t platform;
+        fs::path path;
+        ModelPtr model;
+    };
+    std::vector<ModelFile> files;
+    for (std::size_t i = 0; i < directories.size(); ++i)
+    {
+        for (auto & entry : fs::directory_iterator(directories[i]))
         {
-            continue;
+            const fs::path & path = entry.path();
+            if (path.extension() != ".json" || path.filename() == "main.json" || !entry.is_regular_file())
+            {
+                continue;
+            }
+            files.push_back(ModelFile{i, path, ModelPtr()});
         }
-        std::ifstream file(path);
-        json j;
-        file >> j;
-
-        auto model = std::make_shared<Model>(platform);
-        decodeModel(j, *model);
-        platform->models.emplace_back(std::move(model));
     }
-    return platform;
+
+    // Models only read their platform, which is complete by now
+    parallelFor(files.size(), [&](std::size_t i) {
+        auto model = std::make_shared<Model>(platforms[files[i].platform]);
+        decodeModel(cache.parse(files[i].path), *model);
+        files[i].model = std::move(model);
+    });
+
+    for (ModelFile & file : files)
+        platforms[file.platform]->models.emplace_back(std::move(file.model));
+    for (const PlatformPtr & platform : platforms)
+        platform->indexModels();
+    return platforms;
+}
+} // namespace
+
+PlatformPtr Platform::loadDirectory(const std::filesystem::path & base_path)
+{
+    DefinitionCache cache{fs::path()};
+    return loadPlatforms({base_path}, cache).front();
 }
 
 PlatformPtr Platforms::find(const std::string & id) const noexcept
@@ -386,16 +425,21 @@ PlatformPtr Platforms::find(const std::string & id) const noexcept
     return *it;
 }
 
-void Platforms::loadDirectory(const std::filesystem::path & path)
+void Platforms::loadDirectory(const std::filesystem::path & path,
+                              const std::filesystem::path & cachePath)
 {
+    std::vector<fs::path> directories;
     for (auto & entry : fs::directory_iterator(path))
     {
         if (entry.is_directory())
-        {
-            // Convert to shared_ptr and store
-            platforms_.emplace_back(Platform::loadDirectory(entry.path()));
-        }
+            directories.push_back(entry.path());
     }
+
+    DefinitionCache cache(cachePath);
+    std::vector<PlatformPtr> platforms = loadPlatforms(directories, cache);
+    cache.save();
+
+    platforms_.insert(platforms_.end(), platforms.begin(), platforms.end());
 }
 
 PlatformPtr Platforms::first() const noexcept
@@ -415,4 +459,14 @@ ModelPtr Platforms::find(const std::string & platformId,
     return platform->findModel(modelId);
 }
 
+ModelPtr Platforms::identify(const uint8_t * data, size_t size) const noexcept
+{
+    for (const PlatformPtr & platform : platforms_)
+    {
+        if (ModelPtr model = platform->identify(data, size))
+            return model;
+    }
+    return ModelPtr();
+}
+
 } // namespace lt
@@ -1,6 +1,7 @@
 #ifndef LT_PLATFORM_H
 #define LT_PLATFORM_H
 
+#include <chrono>
 #include <filesystem>
 #include <regex>
 #include <string>
@@ -10,6 +11,7 @@
 #include "../auth/auth.h"
 #include "../datalog/pid.h"
 #include "../support/types.h"
+#include "identifierindex.h"
 #include "model.h"
 #include "table.h"
 
@@ -36,8 +38,23 @@ struct Platform
     /* Server ID for ISO-TP reqeusts */
     unsigned serverId{0x7e0};
 
+    /* Bytes requested per download transfer */
+    std::size_t downloadChunkSize{0xFFE};
+
+    /* ISO-TP flow control advertised when receiving. See
+     * network::IsoTpOptions. */
+    uint8_t rxBlockSize{0};
+    std::chrono::microseconds rxSeparationTime{0};
+    bool adaptiveFlowControl{false};
+
     /* Flash region */
-    size_t flashOffset, flashSize;
+    size_t flashOffset{0}, flashSize{0};
+    /* Erase sector size of the flash. 0 if unknown, which disables
+     * partial flashing. */
+    size_t flashSectorSize{0};
+    /* RoutineControl identifier returning the CRC-32 of a memory range.
+     * See FlashOptions::crcRoutine. */
+    uint16_t flashCrcRoutine{0};
 
     Endianness endianness{Endianness::Big};
 
@@ -52,6 +69,13 @@ struct Platform
     std::vector<ModelPtr> models;
     std::vector<std::regex> vins;
 
+    // Built by indexModels()
+    IdentifierIndex identifierIndex;
+
+    /* Rebuilds identifierIndex. Must be called after changing models;
+     * until then, identify() compares every model. */
+    void indexModels();
+
     /* Returns true if the supplied VIN matches any pattern in vins */
     bool matchVin(const std::string & vin) const noexcept;
 
@@ -96,8 +120,12 @@ public:
      *      main.json    // Platform definition
      *      model1.json  // Model definition
      *      model2.json
-     */
-    void loadDirectory(const std::filesystem::path & path);
+     * Files are parsed in parallel. If `cachePath` is set, parsed files
+     * are cached there and unchanged files are read from the cache on the
+     * next load. */
+    void loadDirectory(const std::filesystem::path & path,
+                       const std::filesystem::path & cachePath =
+                           std::filesystem::path());
 
     /* Searches for a platform with id `id`. Returns
      * a null pointer if the search fails. */
@@ -109,6 +137,11 @@ public:
     ModelPtr find(const std::string & platformId,
                   const std::string & modelId) const noexcept;
 
+    /* Attempts to determine the model of the data when the platform is
+     * unknown. Platforms are tried in order. Returns nullptr if no
+     * model of any platform matches. */
+    ModelPtr identify(const uint8_t * data, size_t size) const noexcept;
+
     inline std::size_t size() const noexcept { return platforms_.size(); }
 
     /* Returns the first platform in the database. Returns PlatformPtr() if
@@ -59,9 +59,6 @@ struct TableDefinition
     std::string axisX;
     std::string axisY;
 
-    // Offsets only show up in models
-    std::optional<int> offset;
-
     inline int byteSize() const noexcept
     {
         return static_cast<int>(dataTypeSize(storedDataType)) * width * height;
@@ -21,7 +21,12 @@
 
 #include "../auth/auth.h"
 #include "../support/asyncroutine.h"
+#include "regionmap.h"
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -33,12 +38,63 @@ namespace download
 struct Options
 {
     auth::Options auth;
+    // ROM size
     std::size_t size;
+    // Bytes requested per transfer
+    std::size_t chunkSize{0xFFE};
+    // Memory to download. Empty downloads the whole ROM.
+    std::vector<AddressRange> ranges;
+    // If set, progress is kept in a RegionMap at this path and a later
+    // download with the same path resumes from it, provided the ECU
+    // reports the same VIN and calibration ID
+    std::filesystem::path resumePath;
+};
+
+// Throughput of a download in progress
+struct DownloadStats
+{
+    std::size_t bytes{0};
+    std::size_t chunks{0};
+    // Time since the first request (excludes authentication)
+    std::chrono::nanoseconds elapsed{0};
+
+    // Request to response time of each chunk
+    std::chrono::nanoseconds lastLatency{0};
+    std::chrono::nanoseconds minLatency{std::chrono::nanoseconds::max()};
+    std::chrono::nanoseconds maxLatency{0};
+    std::chrono::nanoseconds totalLatency{0};
+
+    inline double bytesPerSecond() const noexcept
+    {
+        return elapsed.count() == 0
+                   ? 0.0
+                   : static_cast<double>(bytes) * 1e9 / elapsed.count();
+    }
+
+    inline std::chrono::nanoseconds averageLatency() const noexcept
+    {
+        if (chunks == 0)
+            return std::chrono::nanoseconds(0);
+        return totalLatency /
+               static_cast<std::chrono::nanoseconds::rep>(chunks);
+    }
+
+    void addChunk(std::size_t size, std::chrono::nanoseconds latency) noexcept
+    {
+        bytes += size;
+        ++chunks;
+        lastLatency = latency;
+        minLatency = std::min(minLatency, latency);
+        maxLatency = std::max(maxLatency, latency);
+        totalLatency += latency;
+    }
 };
 
 class Downloader : public AsyncRoutine
 {
 public:
+    using StatsCallback = std::function<void(const DownloadStats & stats)>;
+
     virtual ~Downloader() = default;
 
     /* Starts downloading. Calls updateProgress if possible.
@@ -48,8 +104,28 @@ public:
     /* Cancels the active download */
     virtual void cancel() = 0;
 
-    /* Returns the downloaded data */
+    /* Returns the downloaded data. Memory outside of the requested
+     * ranges is zeroed. */
     virtual std::pair<const uint8_t *, size_t> data() = 0;
+
+    /* Called from the downloading thread after each chunk, together with
+     * the progress callback */
+    inline void setStatsCallback(StatsCallback && cb)
+    {
+        statsCallback_ = std::move(cb);
+    }
+
+protected:
+    inline void notifyStats(const DownloadStats & stats)
+    {
+        if (statsCallback_)
+        {
+            statsCallback_(stats);
+        }
+    }
+
+private:
+    StatsCallback statsCallback_;
 };
 using DownloaderPtr = std::unique_ptr<Downloader>;
 
@@ -0,0 +1,296 @@
+#include "regionmap.h"
+
+#include "definition/platform.h"
+#include "support/crc32.h"
+#include "support/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace lt::download
+{
+
+namespace
+{
+/* Map file layout, all integers little endian:
+ *   "LTRM" version:u32 romSize:u32 identitySize:u32 identity[identitySize]
+ *   (address:u32 length:u32 crc:u32)... */
+constexpr std::array<char, 4> map_magic{'L', 'T', 'R', 'M'};
+constexpr uint32_t map_version = 2;
+constexpr std::size_t header_size = 16;
+constexpr std::size_t record_size = 12;
+
+inline void putLE(uint32_t value, char * dest)
+{
+    SConverter<uint32_t, 4>::writeLE(value, reinterpret_cast<uint8_t *>(dest));
+}
+
+inline uint32_t getLE(const char * src)
+{
+    return SConverter<uint32_t, 4>::readLE(
+        reinterpret_cast<const uint8_t *>(src));
+}
+} // namespace
+
+std::vector<AddressRange> normalizeRanges(std::vector<AddressRange> ranges,
+                                          std::size_t limit)
+{
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                                [limit](const AddressRange & range) {
+                                    return range.size == 0 ||
+                                           range.offset >= limit;
+                                }),
+                 ranges.end());
+    std::sort(ranges.begin(), ranges.end(),
+              [](const AddressRange & a, const AddressRange & b) {
+                  return a.offset < b.offset;
+              });
+
+    std::vector<AddressRange> merged;
+    for (AddressRange range : ranges)
+    {
+        range.size = std::min(range.end(), limit) - range.offset;
+        if (!merged.empty() && range.offset <= merged.back().end())
+        {
+            AddressRange & last = merged.back();
+            last.size = std::max(last.end(), range.end()) - last.offset;
+            continue;
+        }
+        merged.push_back(range);
+    }
+    return merged;
+}
+
+std::vector<AddressRange> calibrationRanges(const Platform & platform)
+{
+    std::vector<AddressRange> ranges;
+    if (platform.flashSize != 0)
+        ranges.push_back({platform.flashOffset, platform.flashSize});
+
+    for (const ModelPtr & model : platform.models)
+    {
+        for (const auto & [id, table] : model->tables)
+        {
+            if (table.offset >= 0)
+            {
+                ranges.push_back(
+                    {static_cast<std::size_t>(table.offset),
+                     static_cast<std::size_t>(table.definition->byteSize())});
+            }
+        }
+
+        for (const auto & [id, offset] : model->axisOffsets)
+        {
+            const AxisDefinition * axis = platform.getAxis(id);
+            if (axis == nullptr)
+                continue;
+            if (const auto * memory =
+                    std::get_if<MemoryAxisDefinition>(&axis->def))
+            {
+                ranges.push_back(
+                    {offset, static_cast<std::size_t>(memory->size) *
+                                 dataTypeSize(axis->dataType)});
+            }
+        }
+
+        // Needed to identify the downloaded ROM
+        for (const Identifier & identifier : model->identifiers)
+            ranges.push_back({identifier.offset(), identifier.size()});
+    }
+    return normalizeRanges(std::move(ranges), platform.romsize);
+}
+
+RegionMap::RegionMap(fs::path path, std::size_t romSize,
+                     std::string identity)
+    : path_(std::move(path)), romSize_(romSize), identity_(std::move(identity))
+{
+    mapPath_ = path_;
+    mapPath_ += map_extension;
+
+    load();
+    openImage();
+}
+
+void RegionMap::load()
+{
+    std::ifstream file(mapPath_, std::ios::binary | std::ios::in);
+    std::array<char, header_size> header;
+    bool valid = file.is_open() && file.read(header.data(), header.size()) &&
+                 std::equal(map_magic.begin(), map_magic.end(), header.begin()) &&
+                 getLE(&header[4]) == map_version && getLE(&header[8]) == romSize_ &&
+                 getLE(&header[12]) == identity_.size();
+    if (valid)
+    {
+        std::string identity(identity_.size(), '\0');
+        valid = file.read(identity.data(), identity.size()) && identity == identity_;
+    }
+    if (!valid)
+    {
+        file.close();
+        reset();
+        return;
+    }
+
+    // A partially written trailing record is ignored
+    std::array<char, record_size> record;
+    while (file.read(record.data(), record.size()))
+    {
+        Region region{getLE(&record[0]), getLE(&record[4]), getLE(&record[8])};
+        if (static_cast<std::size_t>(region.address) + region.length <=
+            romSize_)
+        {
+            regions_.push_back(region);
+        }
+    }
+    file.close();
+
+    writeMap();
+}
+
+void RegionMap::reset()
+{
+    regions_.clear();
+    image_.close();
+    std::error_code ec;
+    fs::remove(path_, ec);
+    writeMap();
+}
+
+void RegionMap::writeMap()
+{
+    map_.close();
+    map_.open(mapPath_, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!map_.is_open())
+        throw std::runtime_error("failed to open download map '" +
+                                 mapPath_.string() + "'");
+
+    std::array<char, header_size> header;
+    std::copy(map_magic.begin(), map_magic.end(), header.begin());
+    putLE(map_version, &header[4]);
+    putLE(static_cast<uint32_t>(romSize_), &header[8]);
+    putLE(static_cast<uint32_t>(identity_.size()), &header[12]);
+    map_.write(header.data(), header.size());
+    map_.write(identity_.data(), identity_.size());
+
+    for (const Region & region : regions_)
+        writeRecord(region);
+    map_.flush();
+}
+
+void RegionMap::writeRecord(const Region & region)
+{
+    std::array<char, record_size> record;
+    putLE(region.address, &record[0]);
+    putLE(region.length, &record[4]);
+    putLE(region.crc, &record[8]);
+    map_.write(record.data(), record.size());
+}
+
+void RegionMap::openImage()
+{
+    if (!fs::exists(path_))
+        std::ofstream(path_, std::ios::binary | std::ios::out);
+
+    image_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!image_.is_open())
+        throw std::runtime_error("failed to open download image '" +
+                                 path_.string() + "'");
+}
+
+std::size_t RegionMap::restore(std::span<uint8_t> image)
+{
+    assert(image.size() >= romSize_);
+
+    std::vector<Region> valid;
+    std::size_t restored = 0;
+    for (const Region & region : regions_)
+    {
+        uint8_t * dest = image.data() + region.address;
+        image_.seekg(region.address);
+        image_.read(reinterpret_cast<char *>(dest), region.length);
+        if (!image_ || crc32(dest, region.length) != region.crc)
+        {
+            image_.clear();
+            std::fill_n(dest, region.length, 0);
+            continue;
+        }
+        valid.push_back(region);
+        restored += region.length;
+    }
+
+    if (valid.size() != regions_.size())
+    {
+        regions_ = std::move(valid);
+        writeMap();
+    }
+    return restored;
+}
+
+std::vector<AddressRange>
+RegionMap::missing(const std::vector<AddressRange> & ranges) const
+{
+    std::vector<AddressRange> done;
+    done.reserve(regions_.size());
+    for (const Region & region : regions_)
+        done.push_back({region.address, region.length});
+    done = normalizeRanges(std::move(done), romSize_);
+
+    std::vector<AddressRange> result;
+    for (const AddressRange & range : normalizeRanges(ranges, romSize_))
+    {
+        std::size_t cursor = range.offset;
+        for (const AddressRange & region : done)
+        {
+            if (region.end() <= cursor)
+                continue;
+            if (region.offset >= range.end())
+                break;
+            if (region.offset > cursor)
+                result.push_back({cursor, region.offset - cursor});
+            cursor = region.end();
+        }
+        if (cursor < range.end())
+            result.push_back({cursor, range.end() - cursor});
+    }
+    return result;
+}
+
+void RegionMap::record(uint32_t address, std::span<const uint8_t> data)
+{
+    assert(address + data.size() <= romSize_);
+
+    // The data must be written before the record that describes it
+    image_.seekp(address);
+    image_.write(reinterpret_cast<const char *>(data.data()), data.size());
+    image_.flush();
+    if (!image_)
+        throw std::runtime_error("failed to write download image '" +
+                                 path_.string() + "'");
+
+    Region region{address, static_cast<uint32_t>(data.size()),
+                  crc32(data.data(), data.size())};
+    writeRecord(region);
+    map_.flush();
+    if (!map_)
+        throw std::runtime_error("failed to write download map '" +
+                                 mapPath_.string() + "'");
+    regions_.push_back(region);
+}
+
+void RegionMap::remove()
+{
+    image_.close();
+    map_.close();
+    regions_.clear();
+
+    std::error_code ec;
+    fs::remove(path_, ec);
+    fs::remove(mapPath_, ec);
+}
+
+} // namespace lt::download
@@ -0,0 +1,108 @@
+#ifndef LT_REGIONMAP_H
+#define LT_REGIONMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lt
+{
+struct Platform;
+
+namespace download
+{
+
+// Contiguous range of ECU memory
+struct AddressRange
+{
+    std::size_t offset;
+    std::size_t size;
+
+    inline std::size_t end() const noexcept { return offset + size; }
+};
+
+/* Sorts `ranges`, clips them to [0, `limit`) and merges ranges that
+ * overlap or touch. */
+std::vector<AddressRange> normalizeRanges(std::vector<AddressRange> ranges,
+                                          std::size_t limit);
+
+/* Returns the memory needed to identify and tune a ROM of `platform`: the
+ * flash region, every model's table and memory axis locations and the
+ * model identifiers. The rest of an image downloaded from these ranges is
+ * zero, so it must not be used as a ROM or flash base. */
+std::vector<AddressRange> calibrationRanges(const Platform & platform);
+
+// A downloaded chunk
+struct Region
+{
+    uint32_t address;
+    uint32_t length;
+    // CRC-32 of the data
+    uint32_t crc;
+};
+
+/* Persists download progress so an interrupted download can resume.
+ * Received data is written to `path` at its ROM offset and each chunk is
+ * then appended to `path`.map as (address, length, CRC-32). The data is
+ * flushed before its record, so a record always describes written data;
+ * the CRC catches anything else (e.g. a truncated image file). */
+class RegionMap
+{
+public:
+    /* Opens or creates the files at `path`. `identity` names the ECU the
+     * data comes from (e.g. its VIN and calibration ID). Progress recorded
+     * for a different ROM size or identity is discarded, so data from
+     * another ECU is never merged into the image. */
+    RegionMap(std::filesystem::path path, std::size_t romSize,
+              std::string identity);
+
+    /* Reads the recorded regions into `image`, which must hold the whole
+     * ROM. Regions that fail the CRC are forgotten. Returns the amount of
+     * bytes restored. */
+    std::size_t restore(std::span<uint8_t> image);
+
+    // Returns the parts of `ranges` that have not been downloaded
+    std::vector<AddressRange>
+    missing(const std::vector<AddressRange> & ranges) const;
+
+    // Writes a downloaded chunk. Throws an exception on IO errors.
+    void record(uint32_t address, std::span<const uint8_t> data);
+
+    // Deletes both files. Called once the download has completed.
+    void remove();
+
+    inline const std::vector<Region> & regions() const noexcept
+    {
+        return regions_;
+    }
+
+    // Extension appended to the image path for the map
+    static constexpr auto map_extension = ".map";
+
+private:
+    std::filesystem::path path_;
+    std::filesystem::path mapPath_;
+    std::size_t romSize_;
+    std::string identity_;
+    std::vector<Region> regions_;
+
+    std::fstream image_;
+    std::ofstream map_;
+
+    void load();
+    // Forgets all regions and deletes the image
+    void reset();
+    // Rewrites the map from regions_
+    void writeMap();
+    void writeRecord(const Region & region);
+    void openImage();
+};
+
+} // namespace download
+} // namespace lt
+
+#endif // LT_REGIONMAP_H
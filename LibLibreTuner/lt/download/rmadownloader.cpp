@@ -18,10 +18,15 @@
 
 #include "rmadownloader.h"
 #include "auth/udsauthenticator.h"
+#include "diagnostics/vehicle_info.h"
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -30,9 +35,36 @@ namespace lt
 namespace download
 {
 
+// An ISO-TP packet holds 4095 bytes, one of which is the response SID
+constexpr std::size_t max_chunk_size = 0xFFE;
+
+namespace
+{
+// Names the ECU for RegionMap. Empty if the ECU reports neither its VIN
+// nor its calibration ID.
+std::string ecuIdentity(network::Uds & uds)
+{
+    try
+    {
+        vehicle_info info =
+            request_vehicle_info(uds, ScanPids::VIN | ScanPids::CalibrationID);
+        if (info.vin.empty() && info.calibration_id.empty())
+            return std::string();
+        return info.vin + '\n' + info.calibration_id;
+    }
+    catch (const std::runtime_error &)
+    {
+        return std::string();
+    }
+}
+} // namespace
+
 RMADownloader::RMADownloader(network::UdsPtr && uds, Options && options)
     : uds_(std::move(uds)), authOptions_(std::move(options.auth)),
-      totalSize_(options.size)
+      totalSize_(options.size),
+      chunkSize_(std::clamp<std::size_t>(options.chunkSize, 1, max_chunk_size)),
+      ranges_(std::move(options.ranges)),
+      resumePath_(std::move(options.resumePath))
 {
     if (!uds_)
     {
@@ -41,40 +73,109 @@ RMADownloader::RMADownloader(network::UdsPtr && uds, Options && options)
     }
 }
 
-bool RMADownloader::update_progress()
+void RMADownloader::update_progress()
 {
-    notifyProgress((1.0f - (static_cast<float>(downloadSize_) / totalSize_)));
-    return downloadSize_ > 0;
+    if (requestedSize_ != 0)
+    {
+        notifyProgress(1.0f - (static_cast<float>(downloadSize_) /
+                               static_cast<float>(requestedSize_)));
+    }
+    notifyStats(stats_);
 }
 
 bool RMADownloader::download()
 {
+    using Clock = std::chrono::steady_clock;
+
     canceled_ = false;
-    downloadOffset_ = 0;
-    downloadSize_ = totalSize_;
+    downloadData_.assign(totalSize_, 0);
+    stats_ = DownloadStats();
 
-    // Authenticate
-    auth::UdsAuthenticator auth(*uds_, authOptions_);
-    auth.auth();
+    std::vector<AddressRange> ranges = normalizeRanges(
+        ranges_.empty() ? std::vector<AddressRange>{{0, totalSize_}} : ranges_,
+        totalSize_);
 
-    do
+    // Skip whatever an earlier, interrupted download already read
+    std::optional<RegionMap> regionMap;
+    std::vector<AddressRange> pending;
+    // Progress is only kept for an ECU that identifies itself, so an
+    // interrupted download is never completed with another ECU's data
+    std::string identity =
+        resumePath_.empty() ? std::string() : ecuIdentity(*uds_);
+    if (!identity.empty())
+    {
+        regionMap.emplace(resumePath_, totalSize_, std::move(identity));
+        regionMap->restore(downloadData_);
+        pending = regionMap->missing(ranges);
+    }
+    else
     {
-        size_t to_download =
-            std::min<std::size_t>(static_cast<size_t>(downloadSize_), 0xFFE);
-        std::vector<uint8_t> data = uds_->requestReadMemoryAddress(
-            static_cast<uint32_t>(downloadOffset_),
-            static_cast<uint16_t>(to_download));
+        pending = ranges;
+    }
+
+    requestedSize_ = 0;
+    for (const AddressRange & range : ranges)
+        requestedSize_ += range.size;
+    downloadSize_ = 0;
+    for (const AddressRange & range : pending)
+        downloadSize_ += range.size;
+    update_progress();
 
-        if (data.empty())
+    if (downloadSize_ != 0)
+    {
+        // Authenticate
+        auth::UdsAuthenticator auth(*uds_, authOptions_);
+        auth.auth();
+    }
+
+    /* ReadMemoryByAddress allows one outstanding request per server, so
+     * the requests cannot overlap on the bus. Instead, nothing is done
+     * between a response and the next request except bookkeeping: the
+     * response is copied straight into its place in downloadData_ by the
+     * UDS layer, which reuses its buffers. */
+    const Clock::time_point start = Clock::now();
+    for (const AddressRange & range : pending)
+    {
+        downloadOffset_ = range.offset;
+        while (downloadOffset_ < range.end() && !canceled_)
         {
-            throw std::runtime_error("received 0 bytes in download packet");
+            std::size_t toDownload =
+                std::min(range.end() - downloadOffset_, chunkSize_);
+            std::span<uint8_t> chunk(downloadData_.data() + downloadOffset_,
+                                     toDownload);
+
+            const Clock::time_point requested = Clock::now();
+            std::size_t received = uds_->requestReadMemoryAddress(
+                static_cast<uint32_t>(downloadOffset_), chunk);
+            const Clock::time_point now = Clock::now();
+
+            if (received == 0)
+            {
+                throw std::runtime_error(
+                    "received 0 bytes in download packet");
+            }
+
+            if (regionMap)
+            {
+                regionMap->record(static_cast<uint32_t>(downloadOffset_),
+                                  chunk.first(received));
+            }
+
+            downloadOffset_ += received;
+            downloadSize_ -= received;
+
+            stats_.addChunk(received, now - requested);
+            stats_.elapsed = now - start;
+            update_progress();
         }
+    }
+
+    if (canceled_)
+        return false;
 
-        downloadData_.insert(downloadData_.end(), data.begin(), data.end());
-        downloadOffset_ += data.size();
-        downloadSize_ -= data.size();
-    } while (!canceled_ && update_progress());
-    return !canceled_;
+    if (regionMap)
+        regionMap->remove();
+    return true;
 }
 
 void RMADownloader::cancel() { canceled_ = true; }
@@ -17,6 +17,9 @@ public:
     void cancel() override;
     virtual std::pair<const uint8_t *, size_t> data() override;
 
+    // Stats of the current or last download
+    inline const DownloadStats & stats() const noexcept { return stats_; }
+
 private:
     network::UdsPtr uds_;
 
@@ -26,14 +29,24 @@ private:
     size_t downloadOffset_{};
     /* Amount of data left to be transfered */
     size_t downloadSize_{};
-    /* Total size to be transfered. Used for progress updates */
+    /* Size of the ROM */
     size_t totalSize_;
-
+    /* Size of all requested ranges, including resumed data. Used for
+     * progress updates */
+    size_t requestedSize_{};
+    /* Bytes requested per ReadMemoryByAddress */
+    size_t chunkSize_;
+    std::vector<AddressRange> ranges_;
+    std::filesystem::path resumePath_;
+
+    /* Allocated for totalSize_ before the first request; responses are
+     * read directly into place */
     std::vector<uint8_t> downloadData_;
+    DownloadStats stats_;
 
     std::atomic<bool> canceled_;
 
-    bool update_progress();
+    void update_progress();
 };
 
 } // namespace lt::download
\ No newline at end of file
@@ -20,8 +20,12 @@
 #define LT_FLASHER_H
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "../auth/auth.h"
 #include "../support/asyncroutine.h"
@@ -35,6 +39,9 @@ namespace lt
 struct FlashOptions
 {
     auth::Options auth;
+    /* RoutineControl identifier of a routine that returns the CRC-32 of a
+     * memory range. 0 if the ECU has none. */
+    uint16_t crcRoutine{0};
 };
 
 /**
@@ -48,6 +55,19 @@ public:
     /* Flash map. Returns false if canceled. */
     virtual bool flash(const FlashMap & flashable) = 0;
 
+    /* Returns true if the flasher can erase sectors individually and read
+     * their CRCs, and therefore accepts partial maps (see
+     * FlashMap::deltaFromTune) */
+    virtual bool supportsPartial() const noexcept { return false; }
+
+    /* Reads the CRC-32 (see crc32()) of each of `sectors` from the ECU.
+     * Throws an exception if the flasher does not support partial maps. */
+    virtual std::vector<uint32_t>
+    sectorCrcs(std::span<const FlashRange> /*sectors*/)
+    {
+        throw std::runtime_error("the flasher cannot read sector CRCs");
+    }
+
     /* Cancels the active flash */
     virtual void cancel() = 0;
 };
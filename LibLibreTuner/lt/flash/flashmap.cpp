@@ -19,61 +19,139 @@
 #include "flashmap.h"
 #include "../definition/platform.h"
 #include "../rom/rom.h"
+#include "../support/crc32.h"
 
+#include <algorithm>
 #include <cassert>
-#include <utility>
+#include <stdexcept>
+#include <string>
 
 namespace lt
 {
 
 FlashMap::FlashMap(const std::vector<uint8_t> & data, std::size_t offset)
-    : data_(data), offset_(offset)
+    : blocks_{FlashBlock{offset, data}}, partial_(false)
 {
 }
 
 FlashMap::FlashMap(std::vector<uint8_t> && data, std::size_t offset)
-    : data_(std::move(data)), offset_(offset)
+    : blocks_{FlashBlock{offset, std::move(data)}}, partial_(false)
 {
 }
 
-FlashMap FlashMap::fromTune(Tune & tune)
+FlashMap::FlashMap(std::vector<FlashBlock> && blocks)
+    : blocks_(std::move(blocks)), partial_(true)
 {
-    const lt::RomPtr & rom = tune.base();
+}
+
+std::size_t FlashMap::size() const
+{
+    std::size_t size = 0;
+    for (const FlashBlock & block : blocks_)
+        size += block.data.size();
+    return size;
+}
 
-    const lt::ModelPtr & model = rom->model();
-    lt::PlatformPtr platform = model->platform();
+namespace
+{
+PlatformPtr tunePlatform(const Tune & tune)
+{
+    lt::PlatformPtr platform = tune.base()->model()->platform();
     if (!platform)
         throw std::runtime_error("model does not have a valid platform. (did "
                                  "the reference expire?)");
+    return platform;
+}
+} // namespace
 
-    std::size_t offset = platform->flashOffset;
+FlashRange FlashMap::flashRegion(const Platform & platform)
+{
+    // Without a size, the region extends to the end of the ROM
+    return {platform.flashOffset, platform.flashSize != 0
+                                      ? platform.flashOffset + platform.flashSize
+                                      : platform.romsize};
+}
 
-    std::vector<uint8_t> new_rom(rom->data(),
-                              rom->data() + rom->size());
+std::vector<FlashRange> FlashMap::sectors(const Platform & platform)
+{
+    std::vector<FlashRange> sectors;
+    const std::size_t sector = platform.flashSectorSize;
+    if (sector == 0)
+        return sectors;
 
-    // Try each table
-    /*for (const auto & [id, definition] : model->tables)
+    const auto [offset, end] = flashRegion(platform);
+    for (std::size_t start = offset; start < end;)
     {
-        Table * table = tune.getTable(id, false);
-        if (table == nullptr)
-        {
-            continue;
-        }
+        // Sector boundaries are absolute; the region may start mid-sector
+        std::size_t next = std::min(end, (start / sector + 1) * sector);
+        sectors.push_back(FlashRange{start, next});
+        start = next;
+    }
+    return sectors;
+}
+
+FlashMap FlashMap::fromTune(Tune & tune)
+{
+    lt::PlatformPtr platform = tunePlatform(tune);
+    const auto [offset, end] = flashRegion(*platform);
+
+    // The tune's data holds its edits; the base ROM does not
+    std::vector<uint8_t> image = tune.image();
+    if (image.size() < end)
+        throw std::runtime_error("tune is smaller than the flash region");
+
+    // Correct and verify checksums
+    tune.base()->model()->checksums.correct(image.data(), image.size());
+
+    std::vector<uint8_t> flash_region(image.begin() + offset,
+                                      image.begin() + end);
+    return FlashMap(std::move(flash_region), offset);
+}
+
+FlashMap FlashMap::deltaFromTune(Tune & tune,
+                                 std::span<const uint32_t> ecuCrcs)
+{
+    lt::PlatformPtr platform = tunePlatform(tune);
+    if (platform->flashSectorSize == 0)
+        throw std::runtime_error("platform '" + platform->id +
+                                 "' does not define a flash sector size");
 
-        std::vector<uint8_t> serialized =
-            table->intoBytes(platform->endianness);
+    std::vector<FlashRange> ranges = sectors(*platform);
+    if (ecuCrcs.size() != ranges.size())
+        throw std::runtime_error("expected a CRC for each of the " +
+                                 std::to_string(ranges.size()) +
+                                 " flash sectors");
 
-        std::copy(serialized.begin(), serialized.end(),
-                  data.begin() + definition.offset.value() - offset);
-    }*/
+    std::vector<uint8_t> image = tune.image();
+    if (image.size() < flashRegion(*platform).end)
+        throw std::runtime_error("tune is smaller than the flash region");
 
     // Correct and verify checksums
-    model->checksums.correct(new_rom.data(), new_rom.size());
+    tune.base()->model()->checksums.correct(image.data(), image.size());
 
-    std::vector<uint8_t> flash_region(new_rom.data() + offset,
-                              new_rom.data() + new_rom.size() - offset);
+    std::vector<FlashBlock> blocks;
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        const auto [start, next] = ranges[i];
+        if (crc32(&image[start], next - start) == ecuCrcs[i])
+            continue;
 
-    return FlashMap(std::move(flash_region), offset);
+        if (!blocks.empty() &&
+            blocks.back().offset + blocks.back().data.size() == start)
+        {
+            blocks.back().data.insert(blocks.back().data.end(),
+                                      image.begin() + start,
+                                      image.begin() + next);
+        }
+        else
+        {
+            blocks.push_back(FlashBlock{
+                start, std::vector<uint8_t>(image.begin() + start,
+                                            image.begin() + next)});
+        }
+    }
+
+    return FlashMap(std::move(blocks));
 }
 
 } // namespace lt
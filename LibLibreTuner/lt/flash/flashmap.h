@@ -19,7 +19,10 @@
 #ifndef FLASHMAP_H
 #define FLASHMAP_H
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -27,26 +30,65 @@ namespace lt
 {
 
 class Tune;
+struct Platform;
+
+// Contiguous block of flash memory to be written
+struct FlashBlock
+{
+    // The address offset the data should be flashed to
+    std::size_t offset;
+    std::vector<uint8_t> data;
+};
+
+// [offset, end) range of flash memory
+struct FlashRange
+{
+    std::size_t offset, end;
+};
 
-/**
- * Describes regions of memory to be reprogrammed
- */
 class FlashMap
 {
 public:
+    // Map of the whole flash region
     FlashMap(const std::vector<uint8_t> & data, std::size_t offset);
     FlashMap(std::vector<uint8_t> && data, std::size_t offset);
 
+    // Partial map. Each block must be erased and written on its own.
+    explicit FlashMap(std::vector<FlashBlock> && blocks);
+
     static FlashMap fromTune(Tune & tune);
 
-    // The address offset the data should be flashed to
-    size_t offset() const { return offset_; }
+    /* Builds a partial map of the erase sectors in the flash region whose
+     * CRC-32 differs from `ecuCrcs`, the CRCs of sectors() as read from
+     * the ECU right before flashing. The tune's base ROM is no substitute;
+     * the ECU may hold anything. Adjacent sectors are merged into one
+     * block. The map is empty if nothing changed. Throws an exception if
+     * the platform does not define a sector size or there is not one CRC
+     * per sector. */
+    static FlashMap deltaFromTune(Tune & tune,
+                                  std::span<const uint32_t> ecuCrcs);
+
+    // Returns the flash region of `platform`
+    static FlashRange flashRegion(const Platform & platform);
+
+    /* Returns the erase sectors of the flash region of `platform`, the
+     * first and last clipped to the region. Empty if the platform does not
+     * define a sector size. */
+    static std::vector<FlashRange> sectors(const Platform & platform);
+
+    inline const std::vector<FlashBlock> & blocks() const { return blocks_; }
+
+    // Returns true if the map does not cover the whole flash region
+    inline bool partial() const { return partial_; }
+
+    inline bool empty() const { return blocks_.empty(); }
 
-    const std::vector<uint8_t> & data() const { return data_; }
+    // Total amount of bytes to be flashed
+    std::size_t size() const;
 
 private:
-    std::vector<uint8_t> data_;
-    std::size_t offset_;
+    std::vector<FlashBlock> blocks_;
+    bool partial_;
 };
 
 } // namespace lt
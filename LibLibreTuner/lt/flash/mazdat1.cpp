@@ -5,6 +5,8 @@
 
 #include <array>
 #include <cassert>
+#include <span>
+#include <stdexcept>
 
 namespace lt
 {
@@ -17,8 +19,14 @@ MazdaT1Flasher::MazdaT1Flasher(network::UdsPtr && uds, FlashOptions && options)
 
 bool MazdaT1Flasher::flash(const FlashMap & flashmap)
 {
+    // The erase request clears the whole flash, so anything but a map of
+    // the whole region would leave parts of the ECU blank
+    if (flashmap.partial() || flashmap.blocks().size() != 1)
+        throw std::runtime_error("the MazdaT1 flasher only supports flashing "
+                                 "the whole flash region");
+
     canceled_ = false;
-    flash_ = &flashmap;
+    block_ = &flashmap.blocks().front();
 
     auth::UdsAuthenticator auth(*uds_, authOptions_);
     // auth_.auth(*uds_, auth::Options{key_, 0x85});
@@ -47,8 +55,8 @@ bool MazdaT1Flasher::do_request_download()
 {
     // Send address...size
     std::array<uint8_t, 8> msg{};
-    writeBE<int32_t>(flash_->offset(), msg.begin(), msg.end());
-    writeBE<int32_t>(flash_->data().size(), msg.begin() + 4, msg.end());
+    writeBE<int32_t>(block_->offset, msg.begin(), msg.end());
+    writeBE<int32_t>(block_->data.size(), msg.begin() + 4, msg.end());
 
     // Send download request
     network::UdsPacket _response =
@@ -61,7 +69,7 @@ bool MazdaT1Flasher::do_request_download()
 
     // Start uploading
     sent_ = 0;
-    left_ = flash_->data().size();
+    left_ = block_->data.size();
     return sendLoad();
 }
 
@@ -70,17 +78,14 @@ bool MazdaT1Flasher::sendLoad()
     while (left_ != 0)
     {
         size_t toSend = std::min<size_t>(left_, 0xFFE);
-        std::vector<uint8_t> data;
-        data.assign(flash_->data().begin() + sent_,
-                    flash_->data().begin() + sent_ + toSend);
+        std::span<const uint8_t> data(block_->data.data() + sent_, toSend);
 
         sent_ += toSend;
         left_ -= toSend;
 
-        network::UdsPacket res = uds_->request(network::UDS_REQ_TRANSFERDATA,
-                                               data.data(), data.size());
+        uds_->requestView(network::UDS_REQ_TRANSFERDATA, data);
 
-        notifyProgress(static_cast<double>(sent_) / flash_->data().size());
+        notifyProgress(static_cast<double>(sent_) / block_->data.size());
         if (canceled_)
         {
             return false;
@@ -18,7 +18,7 @@ public:
 private:
     network::UdsPtr uds_;
 
-    const FlashMap * flash_;
+    const FlashBlock * block_;
     std::atomic<bool> canceled_;
 
     size_t left_{}, sent_{};
@@ -0,0 +1,150 @@
+#include "udsflasher.h"
+
+#include "auth/udsauthenticator.h"
+#include "support/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+
+namespace lt
+{
+
+namespace
+{
+// eraseMemory routine identifier
+constexpr uint16_t erase_routine = 0xFF00;
+// addressAndLengthFormatIdentifier: 4 byte size, 4 byte address
+constexpr uint8_t address_format = 0x44;
+// Largest ISO-TP message, which includes the SID and sequence counter
+constexpr std::size_t max_transfer = 0xFFF;
+
+// Returns addressAndLengthFormatIdentifier, address and size
+std::array<uint8_t, 9> memoryRange(std::size_t offset, std::size_t size)
+{
+    if (offset > UINT32_MAX || size > UINT32_MAX)
+        throw std::runtime_error("flash range does not fit in 4 bytes");
+
+    std::array<uint8_t, 9> range{address_format};
+    writeBE<uint32_t>(static_cast<uint32_t>(offset), range.begin() + 1,
+                      range.end());
+    writeBE<uint32_t>(static_cast<uint32_t>(size), range.begin() + 5,
+                      range.end());
+    return range;
+}
+} // namespace
+
+UdsFlasher::UdsFlasher(network::UdsPtr && uds, FlashOptions && options)
+    : uds_(std::move(uds)), options_(std::move(options))
+{
+    assert(uds_);
+}
+
+bool UdsFlasher::supportsPartial() const noexcept
+{
+    return options_.crcRoutine != 0;
+}
+
+void UdsFlasher::authenticate()
+{
+    // The session stays unlocked between reading CRCs and flashing
+    if (authenticated_)
+        return;
+    auth::UdsAuthenticator auth(*uds_, options_.auth);
+    auth.auth();
+    authenticated_ = true;
+}
+
+std::vector<uint32_t>
+UdsFlasher::sectorCrcs(std::span<const FlashRange> sectors)
+{
+    if (!supportsPartial())
+        return Flasher::sectorCrcs(sectors);
+
+    authenticate();
+
+    std::vector<uint32_t> crcs;
+    crcs.reserve(sectors.size());
+    for (const FlashRange & sector : sectors)
+    {
+        std::vector<uint8_t> status = uds_->startRoutine(
+            options_.crcRoutine,
+            memoryRange(sector.offset, sector.end - sector.offset));
+        if (status.size() < 4)
+            throw std::runtime_error("CRC routine returned no CRC");
+        crcs.push_back(readBE<uint32_t>(status.end() - 4, status.end()));
+    }
+    return crcs;
+}
+
+bool UdsFlasher::flash(const FlashMap & flashmap)
+{
+    canceled_ = false;
+    authenticate();
+
+    sent_ = 0;
+    total_ = flashmap.size();
+    for (const FlashBlock & block : flashmap.blocks())
+    {
+        if (canceled_ || !flashBlock(block))
+            return false;
+    }
+    return true;
+}
+
+bool UdsFlasher::flashBlock(const FlashBlock & block)
+{
+    std::array<uint8_t, 9> range = memoryRange(block.offset, block.data.size());
+    uds_->startRoutine(erase_routine, range);
+    if (canceled_)
+        return false;
+
+    // dataFormatIdentifier 0: neither compressed nor encrypted
+    std::array<uint8_t, 10> download{0x00};
+    std::copy(range.begin(), range.end(), download.begin() + 1);
+    network::UdsPacket res = uds_->request(network::UDS_REQ_REQUESTDOWNLOAD,
+                                           download.data(), download.size());
+
+    // lengthFormatIdentifier, then maxNumberOfBlockLength
+    std::size_t lengthSize = res.data.empty() ? 0 : res.data[0] >> 4;
+    if (lengthSize == 0 || res.data.size() < 1 + lengthSize)
+        throw std::runtime_error("invalid request download response");
+    std::size_t blockLength = 0;
+    for (std::size_t i = 1; i <= lengthSize; ++i)
+        blockLength = (blockLength << 8) | res.data[i];
+    blockLength = std::min(blockLength, max_transfer);
+    if (blockLength <= 2)
+        throw std::runtime_error("ECU accepts no data per transfer");
+    // The length includes the SID and the sequence counter
+    const std::size_t chunkSize = blockLength - 2;
+
+    std::vector<uint8_t> transfer;
+    transfer.reserve(chunkSize + 1);
+    uint8_t sequence = 1;
+    for (std::size_t offset = 0; offset < block.data.size();
+         offset += chunkSize, ++sequence)
+    {
+        std::size_t size = std::min(chunkSize, block.data.size() - offset);
+        transfer.assign(1, sequence);
+        transfer.insert(transfer.end(), block.data.begin() + offset,
+                        block.data.begin() + offset + size);
+
+        std::span<const uint8_t> ack =
+            uds_->requestView(network::UDS_REQ_TRANSFERDATA, transfer);
+        if (ack.empty() || ack[0] != sequence)
+            throw std::runtime_error("transfer data sequence mismatch");
+
+        sent_ += size;
+        notifyProgress(static_cast<float>(sent_) / total_);
+        if (canceled_)
+            return false;
+    }
+
+    uds_->requestView(network::UDS_REQ_TRANSFEREXIT, {});
+    return true;
+}
+
+void UdsFlasher::cancel() { canceled_ = true; }
+
+} // namespace lt
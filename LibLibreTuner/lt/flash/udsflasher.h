@@ -0,0 +1,41 @@
+#ifndef LT_UDSFLASHER_H
+#define LT_UDSFLASHER_H
+
+#include "../network/uds/uds.h"
+#include "flasher.h"
+
+namespace lt
+{
+
+/* Flashes through the ISO 14229 programming services: each block is
+ * erased with the eraseMemory routine (0xFF00), then written with
+ * RequestDownload, TransferData and RequestTransferExit. Addresses and
+ * sizes are sent as 4 bytes each. Accepts partial maps if the ECU has a
+ * routine returning the CRC-32 of a memory range (FlashOptions::crcRoutine),
+ * whose status record ends with the big endian CRC. */
+class UdsFlasher : public Flasher
+{
+public:
+    UdsFlasher(network::UdsPtr && uds, FlashOptions && options);
+
+    bool flash(const FlashMap & flashmap) override;
+    bool supportsPartial() const noexcept override;
+    std::vector<uint32_t>
+    sectorCrcs(std::span<const FlashRange> sectors) override;
+    void cancel() override;
+
+private:
+    network::UdsPtr uds_;
+    FlashOptions options_;
+    std::atomic<bool> canceled_{false};
+    bool authenticated_{false};
+
+    std::size_t sent_{0}, total_{0};
+
+    void authenticate();
+    bool flashBlock(const FlashBlock & block);
+};
+
+} // namespace lt
+
+#endif // LT_UDSFLASHER_H
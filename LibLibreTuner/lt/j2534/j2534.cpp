@@ -126,6 +126,16 @@ void J2534::startMsgFilter(uint32_t channel, uint32_t type,
     }
 }
 
+void J2534::stopMsgFilter(uint32_t channel, uint32_t msgID)
+{
+    assert(initialized());
+    int32_t res = PassThruStopMsgFilter(channel, msgID);
+    if (res != 0)
+    {
+        throw Error(lastError());
+    }
+}
+
 void J2534::disconnect(uint32_t channel)
 {
     assert(initialized());
@@ -277,6 +287,12 @@ void Channel::startMsgFilter(uint32_t type, const PASSTHRU_MSG * pMaskMsg,
                            pFlowControlMsg, pMsgID);
 }
 
+void Channel::stopMsgFilter(uint32_t msgID)
+{
+    assert(valid());
+    j2534_->stopMsgFilter(channel_, msgID);
+}
+
 std::vector<Info> detect_interfaces()
 {
     std::vector<Info> interfaces;
@@ -223,6 +223,9 @@ public:
                         const PASSTHRU_MSG * pFlowControlMsg,
                         uint32_t & pMsgID);
 
+    // Stops a filter started with startMsgFilter
+    void stopMsgFilter(uint32_t msgID);
+
     /* Disconnects the channel from the j2534 device. The object
      * is in an invalid state after calling this method */
     void disconnect();
@@ -304,6 +307,7 @@ public:
                         const PASSTHRU_MSG * pPatternMsg,
                         const PASSTHRU_MSG * pFlowControlMsg,
                         uint32_t & pMsgID);
+    void stopMsgFilter(uint32_t channel, uint32_t msgID);
 
     // Disconnects a logical communication channel
     void disconnect(uint32_t channel);
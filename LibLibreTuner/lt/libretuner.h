@@ -2,14 +2,22 @@
 #define LT_LIBRETUNER_H
 
 #include <functional>
+#include <string>
 
 namespace lt
 {
 
-using LogCallback = std::function<void(const std::string & message)>;
+enum class LogLevel
+{
+    Debug,
+    Warning,
+};
+
+using LogCallback = std::function<void(LogLevel level, const std::string & message)>;
 
 void setLogCallback(LogCallback && cb);
 void log(const std::string & message);
+void log(LogLevel level, const std::string & message);
 
 } // namespace lt
 
@@ -3,6 +3,7 @@
 #include "../diagnostics/uds.h"
 #include "../download/rmadownloader.h"
 #include "../flash/mazdat1.h"
+#include "../flash/udsflasher.h"
 #include "../network/can/canlog.h"
 #include "../network/isotp/isotpcan.h"
 #include "../network/uds/isotpuds.h"
@@ -27,8 +28,15 @@ network::CanPtr PlatformLink::can()
 
 network::IsoTpPtr PlatformLink::isotp()
 {
-    network::IsoTpPtr isotp = datalink_.isotp(
-        network::IsoTpOptions{platform_.serverId, platform_.serverId + 8, platform_.baudrate});
+    network::IsoTpOptions options;
+    options.sourceId = platform_.serverId;
+    options.destId = platform_.serverId + 8;
+    options.baudrate = platform_.baudrate;
+    options.rxBlockSize = platform_.rxBlockSize;
+    options.rxSeparationTime = platform_.rxSeparationTime;
+    options.adaptiveFlowControl = platform_.adaptiveFlowControl;
+
+    network::IsoTpPtr isotp = datalink_.isotp(options);
     if (!isotp)
     {
         throw std::runtime_error(
@@ -54,16 +62,27 @@ FlasherPtr PlatformLink::flasher()
         return std::make_unique<MazdaT1Flasher>(
             uds(), FlashOptions{platform_.flashAuthOptions});
     }
+    if (platform_.flashMode == "uds")
+    {
+        return std::make_unique<UdsFlasher>(
+            uds(), FlashOptions{platform_.flashAuthOptions,
+                                platform_.flashCrcRoutine});
+    }
     throw std::runtime_error("invalid flash mode: " + platform_.flashMode);
 }
 
-download::DownloaderPtr PlatformLink::downloader()
+download::DownloaderPtr
+PlatformLink::downloader(std::filesystem::path resumePath,
+                         std::vector<download::AddressRange> ranges)
 {
     if (platform_.downloadMode == "mazda23")
     {
         return std::make_unique<download::RMADownloader>(
             uds(), download::Options{platform_.downloadAuthOptions,
-                                     platform_.romsize});
+                                     platform_.romsize,
+                                     platform_.downloadChunkSize,
+                                     std::move(ranges),
+                                     std::move(resumePath)});
     }
     throw std::runtime_error("invalid download mode: " +
                              platform_.downloadMode);
@@ -38,7 +38,12 @@ public:
 
     DtcScannerPtr dtcScanner();
     FlasherPtr flasher();
-    download::DownloaderPtr downloader();
+    /* See download::Options for `resumePath` and `ranges`. Empty ranges
+     * download the whole ROM. */
+    download::DownloaderPtr
+    downloader(std::filesystem::path resumePath = std::filesystem::path(),
+               std::vector<download::AddressRange> ranges =
+                   std::vector<download::AddressRange>());
     DataLoggerPtr datalogger(DataLog & log);
 
     inline void setCanLog(network::CanLogPtr log) noexcept
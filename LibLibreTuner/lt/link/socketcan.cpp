@@ -5,6 +5,7 @@
 #include <utility>
 
 #include "../network/can/socketcan.h"
+#include "../network/isotp/isotpsocketcan.h"
 
 namespace lt
 {
@@ -18,6 +19,23 @@ network::CanPtr SocketCanLink::can(uint32_t /*baudrate*/)
     return std::make_unique<network::SocketCan>(device_);
 }
 
+network::IsoTpPtr SocketCanLink::isotp(const network::IsoTpOptions & options)
+{
+    if (kernelIsoTp_)
+    {
+        try
+        {
+            return std::make_unique<network::IsoTpSocketCan>(device_, options);
+        }
+        catch (const std::runtime_error &)
+        {
+            // CAN_ISOTP is not available (e.g. can-isotp is not loaded).
+            // Fall back to our ISO-TP stack
+        }
+    }
+    return DataLink::isotp(options);
+}
+
 DataLinkFlags SocketCanLink::flags() const noexcept
 {
     return DataLinkFlags::Port;
@@ -16,6 +16,14 @@ public:
 
     network::CanPtr can(uint32_t baudrate) override;
 
+    // Uses the kernel's CAN_ISOTP sockets if enabled and available, otherwise
+    // the user-space stack on top of can()
+    network::IsoTpPtr isotp(const network::IsoTpOptions & options) override;
+
+    // Enables the kernel ISO-TP transport (enabled by default)
+    void setKernelIsoTp(bool enabled) noexcept { kernelIsoTp_ = enabled; }
+    bool kernelIsoTp() const noexcept { return kernelIsoTp_; }
+
     NetworkProtocol supportedProtocols() const override
     {
         return NetworkProtocol::Can;
@@ -32,6 +40,7 @@ public:
 
 private:
     std::string device_;
+    bool kernelIsoTp_{true};
 
     // void check_interface();
 };
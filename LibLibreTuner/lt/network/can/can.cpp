@@ -15,6 +15,15 @@ void Can::send(uint32_t id, const uint8_t * data, size_t length)
     return send(CanMessage(id, data, static_cast<uint8_t>(length)));
 }
 
+std::size_t Can::recvBatch(CanMessage * messages, std::size_t max,
+                           std::chrono::milliseconds timeout)
+{
+    assert(messages != nullptr);
+    if (max == 0 || !recv(messages[0], timeout))
+        return 0;
+    return 1;
+}
+
 CanMessage::CanMessage(uint32_t id, const uint8_t * message, uint8_t length)
 {
     setMessage(id, message, length);
@@ -6,7 +6,9 @@
 #include <chrono>
 #include <cstdint>
 #include <memory>
-#include <queue>
+#include <vector>
+
+#include "../../support/ringbuffer.h"
 
 namespace lt
 {
@@ -24,6 +26,13 @@ enum class CanError
 // Constants
 constexpr std::size_t max_can_id = (1 << 30) - 1;
 
+// Matches messages where (message id & mask) == (id & mask)
+struct CanFilter
+{
+    uint32_t id;
+    uint32_t mask{0x1FFFFFFF};
+};
+
 class CanMessage
 {
 public:
@@ -71,47 +80,60 @@ public:
     // Adds trailing zeros after last byte
     void pad() noexcept;
 
+    // Time the frame was received, as reported by the interface (e.g. the
+    // kernel's SO_TIMESTAMPING clock). Zero if no timestamp is available.
+    inline std::chrono::nanoseconds timestamp() const noexcept
+    {
+        return timestamp_;
+    }
+    inline void setTimestamp(std::chrono::nanoseconds timestamp) noexcept
+    {
+        timestamp_ = timestamp;
+    }
+
 private:
     std::array<uint8_t, 8> message_{0};
     uint8_t length_;
     uint32_t id_ = 0;
+    std::chrono::nanoseconds timestamp_{0};
 };
 
+// Buffers received messages between a single producer (e.g. a receiver
+// thread) and a single consumer.
 class CanMessageBuffer
 {
 public:
-    CanMessageBuffer(std::size_t limit = 2048) : limit_(limit) {}
-
-    void add(const CanMessage & message)
+    explicit CanMessageBuffer(std::size_t capacity = 2048,
+                              RingPolicy policy = RingPolicy::OverwriteOldest)
+        : ring_(capacity, policy)
     {
-        buffer_.emplace(message);
-        if (buffer_.size() > limit_)
-            buffer_.pop();
     }
 
-    void add(CanMessage && message)
+    // Producer side. Returns false if the buffer is full and the policy
+    // is RingPolicy::Block.
+    bool add(const CanMessage & message) noexcept
     {
-        buffer_.emplace(std::move(message));
-        if (buffer_.size() > limit_)
-            buffer_.pop();
+        return ring_.push(message);
     }
 
-    bool pop(CanMessage & message)
-    {
-        if (buffer_.empty())
-            return false;
-        CanMessage front = buffer_.front();
-        buffer_.pop();
+    // Producer side. Counts a message add() rejected that is given up on.
+    void discard() noexcept { ring_.discard(); }
 
-        message = std::move(front);
-        return true;
-    }
+    // Consumer side. Returns false if the buffer is empty.
+    bool pop(CanMessage & message) noexcept { return ring_.pop(message); }
+
+    // Consumer side
+    void clear() noexcept { ring_.clear(); }
+
+    bool empty() const noexcept { return ring_.empty(); }
 
-    void clear() { buffer_ = std::queue<CanMessage>(); }
+    std::size_t size() const noexcept { return ring_.size(); }
+
+    // Messages dropped or discarded because the buffer was full
+    std::size_t overruns() const noexcept { return ring_.overruns(); }
 
 private:
-    std::queue<CanMessage> buffer_;
-    std::size_t limit_{20};
+    SpscRing<CanMessage> ring_;
 };
 
 class Can
@@ -131,7 +153,21 @@ public:
     virtual bool recv(CanMessage & message,
                       std::chrono::milliseconds timeout) = 0;
 
+    // Receives up to `max` messages into `messages`, waiting at most
+    // `timeout` for the first one. Returns the amount of messages read.
+    virtual std::size_t recvBatch(CanMessage * messages, std::size_t max,
+                                  std::chrono::milliseconds timeout);
+
     virtual void clearBuffer() noexcept {}
+
+    // Asks the interface to only deliver messages matching any filter in
+    // `filters`. An empty list accepts all messages. Interfaces that cannot
+    // filter ignore this, so receivers must still check message ids.
+    virtual void setFilters(const std::vector<CanFilter> & /*filters*/) {}
+
+    // Returns the amount of received messages lost before they could be
+    // read because a buffer in the receive path was full.
+    virtual std::size_t overruns() const noexcept { return 0; }
 };
 
 using CanPtr = std::unique_ptr<Can>;
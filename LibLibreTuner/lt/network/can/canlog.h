@@ -71,8 +71,30 @@ public:
         return res;
     }
 
+    std::size_t recvBatch(CanMessage * messages, std::size_t max,
+                          std::chrono::milliseconds timeout) override
+    {
+        std::size_t count = can_->recvBatch(messages, max, timeout);
+        if (log_)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                log_->emplace_back(
+                    CanLogEntry{CanMessageDirection::Inbound, messages[i]});
+            }
+        }
+        return count;
+    }
+
     void clearBuffer() noexcept override { can_->clearBuffer(); }
 
+    void setFilters(const std::vector<CanFilter> & filters) override
+    {
+        can_->setFilters(filters);
+    }
+
+    std::size_t overruns() const noexcept override { return can_->overruns(); }
+
 private:
     CanPtr can_;
     CanLogPtr log_;
@@ -30,23 +30,55 @@ namespace network
 J2534Can::J2534Can(const j2534::DevicePtr & device, uint32_t baudrate)
     : channel_(device->connect(j2534::Protocol::CAN, CAN_ID_BOTH, baudrate))
 {
-    // Setup the filter
-    j2534::PASSTHRU_MSG msgMask{};
-    msgMask.ProtocolID = static_cast<uint32_t>(j2534::Protocol::CAN);
-    msgMask.RxStatus = 0;
-    msgMask.TxFlags = 0; // ISO15765_FRAME_PAD;
-    msgMask.Timestamp = 0;
-    msgMask.DataSize = 5;
-    msgMask.ExtraDataIndex = 0;
-    msgMask.Data[0] = 0;
-    msgMask.Data[1] = 0;
-    msgMask.Data[2] = 0;
-    msgMask.Data[3] = 0;
-    msgMask.Data[4] = 0;
-    j2534::PASSTHRU_MSG msgPattern = msgMask;
-
-    uint32_t msgId;
-    channel_.startMsgFilter(PASS_FILTER, &msgMask, &msgPattern, nullptr, msgId);
+    // Pass everything until a client narrows it down
+    setFilters({});
+}
+
+void J2534Can::setFilters(const std::vector<CanFilter> & filters)
+{
+    std::vector<CanFilter> passing = filters;
+    if (passing.empty())
+    {
+        // A zero mask matches every message
+        passing.push_back(CanFilter{0, 0});
+    }
+
+    // Start the new filters before stopping the old ones so matching
+    // messages are not dropped in between
+    std::vector<uint32_t> filterIds;
+    for (const CanFilter & filter : passing)
+    {
+        j2534::PASSTHRU_MSG msgMask{};
+        msgMask.ProtocolID = static_cast<uint32_t>(j2534::Protocol::CAN);
+        msgMask.RxStatus = 0;
+        msgMask.TxFlags = 0; // ISO15765_FRAME_PAD;
+        msgMask.Timestamp = 0;
+        msgMask.DataSize = 4;
+        msgMask.ExtraDataIndex = 0;
+        j2534::PASSTHRU_MSG msgPattern = msgMask;
+
+        msgMask.Data[0] = (filter.mask & 0xFF000000U) >> 24U;
+        msgMask.Data[1] = (filter.mask & 0xFF0000U) >> 16U;
+        msgMask.Data[2] = (filter.mask & 0xFF00U) >> 8U;
+        msgMask.Data[3] = filter.mask & 0xFFU;
+
+        uint32_t id = filter.id & filter.mask;
+        msgPattern.Data[0] = (id & 0xFF000000U) >> 24U;
+        msgPattern.Data[1] = (id & 0xFF0000U) >> 16U;
+        msgPattern.Data[2] = (id & 0xFF00U) >> 8U;
+        msgPattern.Data[3] = id & 0xFFU;
+
+        uint32_t msgId;
+        channel_.startMsgFilter(PASS_FILTER, &msgMask, &msgPattern, nullptr,
+                                msgId);
+        filterIds.push_back(msgId);
+    }
+
+    for (uint32_t msgId : filterIds_)
+    {
+        channel_.stopMsgFilter(msgId);
+    }
+    filterIds_ = std::move(filterIds);
 }
 
 J2534Can::~J2534Can() = default;
@@ -22,6 +22,7 @@
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include "can.h"
 #include "j2534/j2534.h"
@@ -46,8 +47,18 @@ public:
     virtual bool recv(CanMessage & message,
                       std::chrono::milliseconds timeout) override;
 
+    // Replaces the channel's PASS_FILTERs
+    void setFilters(const std::vector<CanFilter> & filters) override;
+
+    std::size_t overruns() const noexcept override
+    {
+        return buffer_.overruns();
+    }
+
 private:
     j2534::Channel channel_;
+    // Ids of active message filters
+    std::vector<uint32_t> filterIds_;
 
     CanMessageBuffer buffer_;
 };
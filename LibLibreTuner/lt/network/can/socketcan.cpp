@@ -10,24 +10,30 @@
 
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <vector>
 
 namespace lt
 {
 namespace network
 {
 
-bool SocketCanReceiver::recv(CanMessage & message,
-                             std::chrono::milliseconds timeout)
+bool SocketCanReceiver::waitForMessages(std::chrono::milliseconds timeout)
 {
-    std::chrono::steady_clock::time_point start =
-        std::chrono::steady_clock::now();
-    while ((std::chrono::steady_clock::now() - start) < timeout)
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    std::unique_lock lk(mutex_);
+    while (buffer_.empty())
     {
         if (!running_)
         {
+            lk.unlock();
             if (result_.valid())
             {
                 result_.get();
@@ -36,37 +42,149 @@ bool SocketCanReceiver::recv(CanMessage & message,
             throw std::runtime_error("SocketCAN receiver thread is inactive");
         }
 
-        if (buffer_.pop(message))
+        if (received_.wait_until(lk, deadline) == std::cv_status::timeout)
         {
-            return true;
+            // Timed out
+            return !buffer_.empty();
         }
+    }
+    return true;
+}
+
+bool SocketCanReceiver::recv(CanMessage & message,
+                             std::chrono::milliseconds timeout)
+{
+    if (!waitForMessages(timeout))
+    {
+        return false;
+    }
+    return buffer_.pop(message);
+}
+
+std::size_t SocketCanReceiver::recvBatch(CanMessage * messages,
+                                         std::size_t max,
+                                         std::chrono::milliseconds timeout)
+{
+    if (max == 0 || !waitForMessages(timeout))
+    {
+        return 0;
+    }
 
-        std::unique_lock lk(mutex_);
-        received_.wait_for(lk, timeout -
-                                   (std::chrono::steady_clock::now() - start));
+    std::size_t count = 0;
+    while (count < max && buffer_.pop(messages[count]))
+    {
+        ++count;
     }
-    // Timed out
-    return false;
+    return count;
 }
 
 SocketCanReceiver::~SocketCanReceiver() { stop(); }
 
+namespace
+{
+// Control message space for SO_TIMESTAMPING and SO_RXQ_OVFL
+struct alignas(cmsghdr) ControlBuffer
+{
+    char data[CMSG_SPACE(sizeof(scm_timestamping)) +
+              CMSG_SPACE(sizeof(uint32_t))];
+};
+
+inline std::chrono::nanoseconds toNanoseconds(const timespec & ts)
+{
+    return std::chrono::seconds(ts.tv_sec) +
+           std::chrono::nanoseconds(ts.tv_nsec);
+}
+} // namespace
+
 void SocketCanReceiver::work()
 {
+    std::array<can_frame, batch_size> frames;
+    std::array<iovec, batch_size> iovecs;
+    std::array<ControlBuffer, batch_size> control;
+    std::array<mmsghdr, batch_size> headers;
+
     while (!stop_)
     {
-        can_frame frame;
+        for (std::size_t i = 0; i < batch_size; ++i)
+        {
+            iovecs[i].iov_base = &frames[i];
+            iovecs[i].iov_len = sizeof(can_frame);
+
+            headers[i] = mmsghdr{};
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+            headers[i].msg_hdr.msg_control = control[i].data;
+            headers[i].msg_hdr.msg_controllen = sizeof(ControlBuffer::data);
+        }
 
-        int nbytes = socket_.recv(&frame, sizeof(can_frame), 0);
-        if (nbytes == 0)
+        // Blocks for the first frame (up to SO_RCVTIMEO), then takes
+        // whatever else is already queued.
+        std::size_t count =
+            socket_.recvmmsg(headers.data(), batch_size, MSG_WAITFORONE);
+        if (count == 0)
         {
             // Timed out
             continue;
         }
 
-        // TODO: remove EFF/RTR/ERR flags
-        buffer_.add(CanMessage(frame.can_id, frame.data, frame.can_dlc));
-        received_.notify_all();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (headers[i].msg_len < sizeof(can_frame))
+            {
+                continue;
+            }
+
+            const can_frame & frame = frames[i];
+            // TODO: remove EFF/RTR/ERR flags
+            CanMessage message(frame.can_id, frame.data, frame.can_dlc);
+
+            msghdr & hdr = headers[i].msg_hdr;
+            for (cmsghdr * cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr;
+                 cmsg = CMSG_NXTHDR(&hdr, cmsg))
+            {
+                if (cmsg->cmsg_level != SOL_SOCKET)
+                {
+                    continue;
+                }
+
+                if (cmsg->cmsg_type == SO_TIMESTAMPING)
+                {
+                    scm_timestamping ts;
+                    std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    // Prefer the raw hardware timestamp if the
+                    // controller supports it
+                    const timespec & stamp =
+                        (ts.ts[2].tv_sec != 0 || ts.ts[2].tv_nsec != 0)
+                            ? ts.ts[2]
+                            : ts.ts[0];
+                    message.setTimestamp(toNanoseconds(stamp));
+                }
+                else if (cmsg->cmsg_type == SO_RXQ_OVFL)
+                {
+                    // Running total of dropped frames for this socket
+                    uint32_t dropped;
+                    std::memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+                    dropped_ = dropped;
+                }
+            }
+
+            // With RingPolicy::Block, hold the frame until the consumer
+            // makes room. The kernel queue absorbs (and counts) the backlog.
+            while (!buffer_.add(message))
+            {
+                if (stop_)
+                {
+                    buffer_.discard();
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        // waitForMessages() checks the buffer under the mutex, so notifying
+        // under it as well cannot fall between its check and its wait
+        std::lock_guard lk(mutex_);
+        received_.notify_one();
     }
 }
 
@@ -94,7 +212,10 @@ void SocketCanReceiver::start()
 
         result_ = task.get_future();
         task();
+        // Wake any waiters so they can observe the result
+        std::lock_guard lk(mutex_);
         running_ = false;
+        received_.notify_all();
     });
 }
 
@@ -102,8 +223,8 @@ void SocketCanReceiver::clearBuffer() { buffer_.clear(); }
 
 SocketCan::~SocketCan() {}
 
-SocketCan::SocketCan(const std::string & ifname)
-    : socket_(AF_CAN, SOCK_RAW, CAN_RAW), receiver_(socket_)
+SocketCan::SocketCan(const std::string & ifname, RingPolicy policy)
+    : socket_(AF_CAN, SOCK_RAW, CAN_RAW), receiver_(socket_, policy)
 {
     sockaddr_can addr = {};
     ifreq ifr;
@@ -122,6 +243,15 @@ SocketCan::SocketCan(const std::string & ifname)
     tv.tv_usec = 0;
     socket_.setsockopt(SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
+    // Request kernel receive timestamps and the dropped frame counter
+    int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                       SOF_TIMESTAMPING_RX_HARDWARE |
+                       SOF_TIMESTAMPING_RAW_HARDWARE;
+    socket_.setsockopt(SOL_SOCKET, SO_TIMESTAMPING, &timestamping,
+                       sizeof(timestamping));
+    int overflow = 1;
+    socket_.setsockopt(SOL_SOCKET, SO_RXQ_OVFL, &overflow, sizeof(overflow));
+
     receiver_.start();
 }
 
@@ -142,6 +272,49 @@ bool SocketCan::recv(CanMessage & message, std::chrono::milliseconds timeout)
     return receiver_.recv(message, timeout);
 }
 
+void SocketCan::setFilters(const std::vector<CanFilter> & filters)
+{
+    std::vector<can_filter> kernelFilters;
+    kernelFilters.reserve(std::max<std::size_t>(filters.size(), 1));
+    for (const CanFilter & filter : filters)
+    {
+        can_filter & kf = kernelFilters.emplace_back();
+        // Match the frame format as well so 11-bit filters do not pass
+        // 29-bit frames with the same low bits, and drop remote frames.
+        if (filter.id > CAN_SFF_MASK)
+        {
+            kf.can_id = (filter.id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+            kf.can_mask = (filter.mask & CAN_EFF_MASK);
+        }
+        else
+        {
+            kf.can_id = filter.id;
+            kf.can_mask = (filter.mask & CAN_SFF_MASK);
+        }
+        kf.can_mask |= CAN_EFF_FLAG | CAN_RTR_FLAG;
+    }
+
+    if (kernelFilters.empty())
+    {
+        // Accept everything
+        kernelFilters.push_back(can_filter{0, 0});
+    }
+
+    socket_.setsockopt(SOL_CAN_RAW, CAN_RAW_FILTER, kernelFilters.data(),
+                       kernelFilters.size() * sizeof(can_filter));
+}
+
+std::size_t SocketCan::overruns() const noexcept
+{
+    return receiver_.overruns() + receiver_.droppedFrames();
+}
+
+std::size_t SocketCan::recvBatch(CanMessage * messages, std::size_t max,
+                                 std::chrono::milliseconds timeout)
+{
+    return receiver_.recvBatch(messages, max, timeout);
+}
+
 void SocketCan::clearBuffer() noexcept { receiver_.clearBuffer(); }
 
 } // namespace network
@@ -18,10 +18,18 @@ namespace lt
 namespace network
 {
 
+// Drains the socket on a worker thread. Frames are read in batches of up to
+// `batch_size` with recvmmsg() and stamped with the kernel receive time.
 class SocketCanReceiver
 {
 public:
-    SocketCanReceiver(os::Socket & socket) : socket_(socket) {}
+    static constexpr std::size_t batch_size = 32;
+
+    explicit SocketCanReceiver(os::Socket & socket,
+                               RingPolicy policy = RingPolicy::OverwriteOldest)
+        : socket_(socket), buffer_(2048, policy)
+    {
+    }
 
     ~SocketCanReceiver();
 
@@ -29,21 +37,37 @@ public:
     // If the worker thread has thrown an exception, passes it here.
     bool recv(CanMessage & message, std::chrono::milliseconds timeout);
 
+    // Pops up to `max` buffered messages, waiting if the buffer is empty.
+    // Returns the amount of messages read or 0 on timeout.
+    std::size_t recvBatch(CanMessage * messages, std::size_t max,
+                          std::chrono::milliseconds timeout);
+
     void start();
     void stop();
 
     void clearBuffer();
 
+    // Returns the amount of frames the kernel dropped because the socket
+    // receive queue was full (SO_RXQ_OVFL).
+    inline uint32_t droppedFrames() const noexcept { return dropped_; }
+
+    // Returns the amount of frames lost because the receive buffer was full
+    inline std::size_t overruns() const noexcept { return buffer_.overruns(); }
+
 private:
     os::Socket & socket_;
 
     void work();
+    // Waits until the buffer is non-empty or the timeout expires
+    bool waitForMessages(std::chrono::milliseconds timeout);
 
     std::thread receiver_;
     std::condition_variable received_;
     std::atomic<bool> stop_{false};
     std::atomic<bool> running_{false};
+    std::atomic<uint32_t> dropped_{0};
     std::future<void> result_;
+    // Only guards the condition variable; the buffer itself is lock-free
     std::mutex mutex_;
 
     CanMessageBuffer buffer_;
@@ -58,7 +82,8 @@ public:
 
     ~SocketCan() override;
 
-    SocketCan(const std::string & ifname);
+    explicit SocketCan(const std::string & ifname,
+                       RingPolicy policy = RingPolicy::OverwriteOldest);
 
     // Can interface
 public:
@@ -68,8 +93,23 @@ public:
     virtual bool recv(CanMessage & message,
                       std::chrono::milliseconds timeout) override;
 
+    virtual std::size_t recvBatch(CanMessage * messages, std::size_t max,
+                                  std::chrono::milliseconds timeout) override;
+
     virtual void clearBuffer() noexcept override;
 
+    // Installs the filters in the kernel with CAN_RAW_FILTER
+    virtual void setFilters(const std::vector<CanFilter> & filters) override;
+
+    // Buffer overruns plus frames dropped by the kernel
+    virtual std::size_t overruns() const noexcept override;
+
+    // Frames dropped by the kernel before they could be read
+    inline uint32_t droppedFrames() const noexcept
+    {
+        return receiver_.droppedFrames();
+    }
+
 private:
     os::Socket socket_;
     SocketCanReceiver receiver_;
@@ -1,28 +1,111 @@
 #include "isotp.h"
 
+#include <algorithm>
+#include <cassert>
+
 namespace lt::network
 {
 
-IsoTpPacket::IsoTpPacket() = default;
+namespace detail
+{
+uint8_t calculate_st(std::chrono::microseconds time)
+{
+    assert(time.count() >= 0);
+    if (time.count() == 0)
+        return 0;
+
+    if (time >= std::chrono::milliseconds(1))
+    {
+        return static_cast<uint8_t>(std::min<std::chrono::milliseconds::rep>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
+            127));
+    }
+    uint8_t count = static_cast<uint8_t>(
+        std::max<std::chrono::milliseconds::rep>(time.count() / 100, 1));
+    return count + 0xF0;
+}
+
+std::chrono::microseconds calculate_time(uint8_t st)
+{
+    if (st <= 127)
+        return std::chrono::milliseconds(st);
+    if (st >= 0xF1 && st <= 0xF9)
+        return std::chrono::microseconds((st - 0xF0) * 100);
+    return std::chrono::microseconds(0);
+}
+} // namespace detail
+
+IsoTpPacket::IsoTpPacket() : data_(headroom), offset_(headroom) {}
+
+IsoTpPacket::IsoTpPacket(const uint8_t * data, size_t size) : IsoTpPacket()
+{
+    append(data, size);
+}
+
+IsoTpPacket::IsoTpPacket(std::span<const uint8_t> data)
+    : IsoTpPacket(data.data(), data.size())
+{
+}
+
+IsoTpPacket::IsoTpPacket(IsoTpPacket && other) noexcept
+    : data_(std::move(other.data_)), offset_(other.offset_)
+{
+    other.data_.assign(headroom, 0);
+    other.offset_ = headroom;
+}
 
-IsoTpPacket::IsoTpPacket(const uint8_t * data, size_t size)
-    : data_(data, data + size)
+IsoTpPacket & IsoTpPacket::operator=(IsoTpPacket && other) noexcept
 {
+    if (this != &other)
+    {
+        data_ = std::move(other.data_);
+        offset_ = other.offset_;
+        other.data_.assign(headroom, 0);
+        other.offset_ = headroom;
+    }
+    return *this;
 }
 
 void IsoTpPacket::setData(const uint8_t * data, size_t size)
 {
-    data_.assign(data, data + size);
+    clear();
+    append(data, size);
 }
 
 void IsoTpPacket::moveInto(std::vector<uint8_t> & data)
 {
+    data_.erase(data_.begin(), data_.begin() + offset_);
     data = std::move(data_);
+    data_.assign(headroom, 0);
+    offset_ = headroom;
 }
 
 void IsoTpPacket::append(const uint8_t * data, size_t size)
 {
-    data_.insert(data_.begin() + data_.size(), data, data + size);
+    data_.insert(data_.end(), data, data + size);
+}
+
+void IsoTpPacket::prepend(uint8_t byte)
+{
+    if (offset_ == 0)
+    {
+        data_.insert(data_.begin(), byte);
+        return;
+    }
+    data_[--offset_] = byte;
+}
+
+void IsoTpPacket::reserve(std::size_t size)
+{
+    data_.reserve(offset_ + size);
+}
+
+void IsoTpPacket::resize(std::size_t size) { data_.resize(offset_ + size); }
+
+void IsoTpPacket::clear()
+{
+    data_.resize(headroom);
+    offset_ = headroom;
 }
 
 } // namespace lt::network
@@ -5,6 +5,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace lt::network
@@ -15,46 +16,105 @@ struct IsoTpOptions
     uint32_t sourceId = 0x7E0, destId = 0x7E8;
     uint32_t baudrate = 500000;
     std::chrono::milliseconds timeout{6000};
+
+    // Flow control advertised when receiving. A block size of 0 lets the
+    // sender transmit every consecutive frame without waiting.
+    uint8_t rxBlockSize = 0;
+    std::chrono::microseconds rxSeparationTime{0};
+    // Lowers the block size and raises the separation time when receives
+    // fail or the CAN receive buffer overruns
+    bool adaptiveFlowControl = false;
 };
 
+namespace detail
+{
+// Encodes a separation time as an STmin byte
+uint8_t calculate_st(std::chrono::microseconds time);
+// Decodes an STmin byte
+std::chrono::microseconds calculate_time(uint8_t st);
+} // namespace detail
+
+// Largest payload a (non-FD) ISO-TP first frame can announce
+constexpr std::size_t isotp_max_size = 4095;
+
+/* ISO-TP payload buffer. A few bytes of headroom are kept in front of the
+ * payload so upper layers can prepend their header (the UDS SID) without
+ * moving the data. Clearing or resetting the packet keeps the allocation,
+ * so one packet can be reused for every transfer of a session. */
 class IsoTpPacket
 {
 public:
+    static constexpr std::size_t headroom = 1;
+
     IsoTpPacket();
     IsoTpPacket(const uint8_t * data, size_t size);
+    explicit IsoTpPacket(std::span<const uint8_t> data);
+
+    IsoTpPacket(const IsoTpPacket &) = default;
+    IsoTpPacket & operator=(const IsoTpPacket &) = default;
+    // Leaves `other` empty with its headroom restored
+    IsoTpPacket(IsoTpPacket && other) noexcept;
+    IsoTpPacket & operator=(IsoTpPacket && other) noexcept;
 
     /* Resets packet data to `data` */
     void setData(const uint8_t * data, size_t size);
+    inline void setData(std::span<const uint8_t> data)
+    {
+        setData(data.data(), data.size());
+    }
 
     /* moves the data into the vector */
     void moveInto(std::vector<uint8_t> & data);
 
     /* Appends data to the end of the packet */
     void append(const uint8_t * data, size_t size);
+    inline void append(std::span<const uint8_t> data)
+    {
+        append(data.data(), data.size());
+    }
+
+    /* Inserts a byte in front of the payload. Uses the headroom if any
+     * is left. */
+    void prepend(uint8_t byte);
+
+    /* Reserves room for a payload of `size` bytes plus the headroom */
+    void reserve(std::size_t size);
+
+    /* Resizes the payload. New bytes are zeroed. */
+    void resize(std::size_t size);
+
+    inline std::size_t size() const { return data_.size() - offset_; }
 
-    inline std::vector<uint8_t>::size_type size() const { return data_.size(); }
+    inline uint8_t & operator[](int index) { return data_[offset_ + index]; }
 
-    inline uint8_t & operator[](int index) { return data_[index]; }
+    inline uint8_t operator[](int index) const
+    {
+        return data_[offset_ + index];
+    }
 
-    inline uint8_t operator[](int index) const { return data_[index]; }
+    // Keeps the allocation
+    void clear();
 
-    inline void clear() { data_.clear(); }
+    inline std::span<uint8_t> span() { return {data(), size()}; }
+    inline std::span<const uint8_t> span() const { return {data(), size()}; }
 
-    inline std::vector<uint8_t>::iterator begin() { return data_.begin(); }
-    inline std::vector<uint8_t>::const_iterator begin() const { return data_.begin(); }
-    inline std::vector<uint8_t>::const_iterator cbegin() const { return data_.cbegin(); }
+    inline uint8_t * begin() { return data(); }
+    inline const uint8_t * begin() const { return data(); }
+    inline const uint8_t * cbegin() const { return data(); }
 
-    inline std::vector<uint8_t>::iterator end() { return data_.end(); }
-    inline std::vector<uint8_t>::const_iterator end() const { return data_.end(); }
-    inline std::vector<uint8_t>::const_iterator cend() const { return data_.cend(); }
+    inline uint8_t * end() { return data() + size(); }
+    inline const uint8_t * end() const { return data() + size(); }
+    inline const uint8_t * cend() const { return data() + size(); }
 
-    inline uint8_t * data() { return data_.data(); }
-    inline const uint8_t * data() const { return data_.data(); }
+    inline uint8_t * data() { return data_.data() + offset_; }
+    inline const uint8_t * data() const { return data_.data() + offset_; }
 
-    inline bool empty() const { return data_.empty(); }
+    inline bool empty() const { return size() == 0; }
 
 private:
     std::vector<uint8_t> data_;
+    // Start of the payload in data_
+    std::size_t offset_;
 };
 
 class IsoTpPacketReader
@@ -64,12 +124,13 @@ public:
 
     inline std::size_t remaining() const { return packet_.size() - pointer_; }
 
-    // Returns the next bytes in the packet, stopping at `max` bytes
-    std::vector<uint8_t> next(std::size_t max);
+    // Returns a view of the next bytes in the packet, stopping at `max`
+    // bytes. Valid while the packet is not modified.
+    std::span<const uint8_t> next(std::size_t max);
     // Returns the amount of bytes read
     std::size_t next(uint8_t * dest, std::size_t max);
 
-    std::vector<uint8_t> readRemaining();
+    std::span<const uint8_t> readRemaining();
 
 private:
     const IsoTpPacket & packet_;
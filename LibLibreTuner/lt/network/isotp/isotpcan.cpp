@@ -1,40 +1,11 @@
 #include "isotpcan.h"
 
+#include <algorithm>
 #include <string>
-#include <thread>
 
 namespace lt::network
 {
 
-namespace detail
-{
-uint8_t calculate_st(std::chrono::microseconds time)
-{
-    assert(time.count() >= 0);
-    if (time.count() == 0)
-        return 0;
-
-    if (time >= std::chrono::milliseconds(1))
-    {
-        return static_cast<uint8_t>(std::min<std::chrono::milliseconds::rep>(
-            std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
-            127));
-    }
-    uint8_t count = static_cast<uint8_t>(
-        std::max<std::chrono::milliseconds::rep>(time.count() / 100, 1));
-    return count + 0xF0;
-}
-
-std::chrono::microseconds calculate_time(uint8_t st)
-{
-    if (st <= 127)
-        return std::chrono::milliseconds(st);
-    if (st >= 0xF1 && st <= 0xF9)
-        return std::chrono::microseconds((st - 0xF0) * 100);
-    return std::chrono::microseconds(0);
-}
-} // namespace detail
-
 struct FlowControlFrame
 {
     uint8_t fcFlag, blockSize, st;
@@ -49,9 +20,10 @@ class MultiFrameReceiver
 {
 public:
     MultiFrameReceiver(uint16_t size, IsoTpPacket & packet, Can & can,
-                       IsoTpOptions & options, IsoTpCan & protocol)
+                       IsoTpOptions & options, IsoTpCan & protocol,
+                       IsoTpReceiveStats & stats)
         : packet_(packet), can_(can), options_(options), protocol_(protocol),
-          size_(size)
+          stats_(stats), size_(size)
     {
     }
 
@@ -61,12 +33,15 @@ public:
 
 private:
     void sendFlowControl();
+    // Receives consecutive frames until the block is complete
+    // or the end of the packet is reached
     void recvConsecutiveFrames();
 
     IsoTpPacket & packet_;
     Can & can_;
     IsoTpOptions options_;
     IsoTpCan & protocol_;
+    IsoTpReceiveStats & stats_;
 
     uint8_t consecIndex_{1};
     uint16_t size_;
@@ -76,8 +51,10 @@ class MultiFrameSender
 {
 public:
     MultiFrameSender(const IsoTpPacket & packet, Can & can,
-                     IsoTpOptions & options, IsoTpCan & protocol)
-        : reader_(packet), can_(can), options_(options), protocol_(protocol)
+                     IsoTpOptions & options, IsoTpCan & protocol,
+                     Pacer & pacer)
+        : reader_(packet), can_(can), options_(options), protocol_(protocol),
+          pacer_(pacer)
     {
     }
 
@@ -96,15 +73,41 @@ private:
     Can & can_;
     IsoTpOptions options_;
     IsoTpCan & protocol_;
+    Pacer & pacer_;
 
-    std::chrono::microseconds separationTime_{0};
     uint8_t blockSize_{0};
     uint8_t consecIndex_{1};
 };
 
 IsoTpCan::IsoTpCan(CanPtr && can, IsoTpOptions options)
-    : can_(std::move(can)), options_(std::move(options))
+    : can_(std::move(can)), options_(std::move(options)),
+      rxBlockSize_(options_.rxBlockSize),
+      rxSeparationTime_(options_.rxSeparationTime)
+{
+    updateFilters();
+}
+
+void IsoTpCan::setCan(CanPtr && can)
+{
+    can_ = std::move(can);
+    rxCount_ = rxPosition_ = 0;
+    updateFilters();
+}
+
+void IsoTpCan::setOptions(const IsoTpOptions & options)
+{
+    options_ = options;
+    rxBlockSize_ = options_.rxBlockSize;
+    rxSeparationTime_ = options_.rxSeparationTime;
+    cleanTransfers_ = 0;
+    updateFilters();
+}
+
+void IsoTpCan::updateFilters()
 {
+    if (!can_)
+        return;
+    can_->setFilters({CanFilter{options_.destId}});
 }
 
 IsoTpCan::~IsoTpCan() = default;
@@ -123,9 +126,33 @@ void IsoTpCan::recv(IsoTpPacket & result)
     if (type == typeFirst)
     {
         uint16_t length = ((message[0] & 0x0F) << 8) | message[1];
+        result.clear();
         result.append(message.message() + 2, 6);
-        MultiFrameReceiver receiver(length - 6, result, *can_, options_, *this);
-        receiver.recv();
+
+        // The receiver advertises the current (possibly backed off) values
+        IsoTpOptions options = options_;
+        options.rxBlockSize = rxBlockSize_;
+        options.rxSeparationTime = rxSeparationTime_;
+        std::size_t overruns = can_->overruns();
+
+        MultiFrameReceiver receiver(length - 6, result, *can_, options, *this,
+                                    rxStats_);
+        try
+        {
+            receiver.recv();
+        }
+        catch (const std::runtime_error &)
+        {
+            // Out of order frames and timeouts usually mean frames were lost
+            backOff();
+            throw;
+        }
+        ++rxStats_.transfers;
+
+        if (can_->overruns() != overruns)
+            backOff();
+        else
+            recover();
         return;
     }
     throw std::runtime_error(
@@ -150,11 +177,61 @@ void IsoTpCan::send(const IsoTpPacket & packet)
     }
     else
     {
-        MultiFrameSender sender(packet, *can_, options_, *this);
+        pacer_.clearStats();
+        MultiFrameSender sender(packet, *can_, options_, *this, pacer_);
         sender.send();
     }
 }
 
+void IsoTpCan::backOff()
+{
+    if (!options_.adaptiveFlowControl)
+        return;
+
+    cleanTransfers_ = 0;
+    ++rxStats_.backoffs;
+
+    // A block size of 0 is unlimited
+    if (rxBlockSize_ == 0)
+        rxBlockSize_ = 32;
+    else if (rxBlockSize_ > 1)
+        rxBlockSize_ /= 2;
+
+    // The largest STmin is 127ms; below 1ms it has 100us steps
+    rxSeparationTime_ = std::clamp<std::chrono::microseconds>(
+        rxSeparationTime_ * 2, std::chrono::microseconds(100),
+        std::chrono::milliseconds(127));
+}
+
+void IsoTpCan::recover()
+{
+    constexpr std::size_t cleanRun = 16;
+
+    if (!options_.adaptiveFlowControl || ++cleanTransfers_ < cleanRun)
+        return;
+    cleanTransfers_ = 0;
+
+    rxSeparationTime_ /= 2;
+    if (rxSeparationTime_ < std::chrono::microseconds(100) ||
+        rxSeparationTime_ < options_.rxSeparationTime)
+    {
+        rxSeparationTime_ = options_.rxSeparationTime;
+    }
+
+    if (rxBlockSize_ != options_.rxBlockSize)
+    {
+        if (rxBlockSize_ >= 128 || (options_.rxBlockSize != 0 &&
+                                    rxBlockSize_ * 2 >= options_.rxBlockSize))
+        {
+            rxBlockSize_ = options_.rxBlockSize;
+        }
+        else
+        {
+            rxBlockSize_ *= 2;
+        }
+    }
+}
+
 void IsoTpCan::sendSingleFrame(const uint8_t * data, std::size_t size)
 {
     assert(can_);
@@ -171,12 +248,10 @@ void IsoTpCan::sendSingleFrame(const uint8_t * data, std::size_t size)
     can_->send(message);
 }
 
-std::vector<uint8_t> IsoTpPacketReader::next(std::size_t max)
+std::span<const uint8_t> IsoTpPacketReader::next(std::size_t max)
 {
     std::size_t toRead = std::min(max, remaining());
-
-    std::vector<uint8_t> rem(packet_.cbegin() + pointer_,
-                             packet_.cbegin() + pointer_ + toRead);
+    std::span<const uint8_t> rem = packet_.span().subspan(pointer_, toRead);
     pointer_ += toRead;
     return rem;
 }
@@ -190,9 +265,9 @@ std::size_t IsoTpPacketReader::next(uint8_t * dest, std::size_t max)
     return toRead;
 }
 
-std::vector<uint8_t> IsoTpPacketReader::readRemaining()
+std::span<const uint8_t> IsoTpPacketReader::readRemaining()
 {
-    std::vector<uint8_t> rem(packet_.cbegin() + pointer_, packet_.cend());
+    std::span<const uint8_t> rem = packet_.span().subspan(pointer_);
     pointer_ = packet_.size();
     return rem;
 }
@@ -246,7 +321,9 @@ void MultiFrameSender::waitForFlowControl()
             }
         } while (frame.fcFlag == 1);
 
-        separationTime_ = detail::calculate_time(frame.st);
+        // The first consecutive frame after flow control may be sent
+        // immediately
+        pacer_.reset(detail::calculate_time(frame.st));
         blockSize_ = frame.blockSize;
 
         sendConsecFrames();
@@ -262,9 +339,10 @@ void MultiFrameSender::sendConsecFrames()
         message[0] = (typeConsec << 4) | nextConsec();
         message.setLength(reader_.next(message.message() + 1, 7) + 1);
         message.pad();
-        can_.send(message);
 
-        std::this_thread::sleep_for(separationTime_);
+        pacer_.wait();
+        can_.send(message);
+        pacer_.mark();
     } while (reader_.remaining() != 0 &&
              (blockSize_ == 0 || --blockSize_ != 0));
 }
@@ -273,7 +351,7 @@ CanMessage IsoTpCan::recvNextFrame()
 {
     auto start = std::chrono::steady_clock::now();
     CanMessage message;
-    while (can_->recv(message, options_.timeout) &&
+    while (recvFrame(message, options_.timeout) &&
            (std::chrono::steady_clock::now() - start) < options_.timeout)
     {
         if (message.id() == options_.destId)
@@ -286,6 +364,20 @@ CanMessage IsoTpCan::recvNextFrame()
     throw std::runtime_error("timed out");
 }
 
+bool IsoTpCan::recvFrame(CanMessage & message,
+                         std::chrono::milliseconds timeout)
+{
+    if (rxPosition_ == rxCount_)
+    {
+        rxPosition_ = 0;
+        rxCount_ = can_->recvBatch(rxFrames_.data(), rxFrames_.size(), timeout);
+        if (rxCount_ == 0)
+            return false;
+    }
+    message = rxFrames_[rxPosition_++];
+    return true;
+}
+
 CanMessage IsoTpCan::recvNextFrame(uint8_t expectedType)
 {
     CanMessage message = recvNextFrame();
@@ -311,8 +403,12 @@ uint8_t MultiFrameSender::nextConsec()
 
 void MultiFrameReceiver::recv()
 {
-    sendFlowControl();
-    recvConsecutiveFrames();
+    // With a block size of 0 this is a single round
+    while (size_ != 0)
+    {
+        sendFlowControl();
+        recvConsecutiveFrames();
+    }
 }
 
 uint8_t MultiFrameReceiver::nextConsec()
@@ -331,15 +427,17 @@ void MultiFrameReceiver::sendFlowControl()
     message.setId(options_.sourceId);
     message.setLength(3);
     message[0] = (typeFlow << 4) | 0;
-    message[1] = 0;
-    message[2] = 0;
+    message[1] = options_.rxBlockSize;
+    message[2] = detail::calculate_st(options_.rxSeparationTime);
     message.pad();
     can_.send(message);
+    ++stats_.flowControlRounds;
 }
 
 void MultiFrameReceiver::recvConsecutiveFrames()
 {
-    while (size_ != 0)
+    uint8_t remaining = options_.rxBlockSize;
+    do
     {
         CanMessage frame = protocol_.recvNextFrame(typeConsec);
         uint8_t index = frame[0] & 0x0F;
@@ -353,6 +451,7 @@ void MultiFrameReceiver::recvConsecutiveFrames()
 
         packet_.append(frame.message() + 1, received);
         size_ -= received;
-    }
+        ++stats_.consecutiveFrames;
+    } while (size_ != 0 && (remaining == 0 || --remaining != 0));
 }
 } // namespace lt::network
\ No newline at end of file
@@ -2,10 +2,25 @@
 #define LT_ISOTPCAN_H
 
 #include "isotp.h"
+#include "support/pacer.h"
+
+#include <array>
 
 namespace lt::network
 {
 
+// Receive side flow control counters
+struct IsoTpReceiveStats
+{
+    // Multi-frame packets received
+    std::size_t transfers{0};
+    // Flow control frames sent
+    std::size_t flowControlRounds{0};
+    std::size_t consecutiveFrames{0};
+    // Times the adaptive mode lowered the advertised flow control
+    std::size_t backoffs{0};
+};
+
 // ISO 15765-2 transport layer (ISO-TP) for sending large packets over CAN
 class IsoTpCan : public IsoTp
 {
@@ -22,17 +37,37 @@ public:
 
     void send(const IsoTpPacket & packet) override;
 
-    inline void setCan(CanPtr && can) { can_ = std::move(can); }
+    void setCan(CanPtr && can);
 
     // May return nullptr
     inline Can * can() { return can_.get(); }
 
-    void setOptions(const IsoTpOptions & options) override
+    // Also updates the receive filters of the CAN interface
+    void setOptions(const IsoTpOptions & options) override;
+
+    inline const IsoTpOptions & options() const { return options_; }
+
+    // Requested vs achieved consecutive frame separation of the last
+    // multi-frame send
+    inline const PacingStats & sendPacing() const noexcept
     {
-        options_ = options;
+        return pacer_.stats();
     }
 
-    inline const IsoTpOptions & options() const { return options_; }
+    inline const IsoTpReceiveStats & receiveStats() const noexcept
+    {
+        return rxStats_;
+    }
+
+    inline void clearReceiveStats() noexcept { rxStats_ = IsoTpReceiveStats(); }
+
+    // Block size and separation time currently advertised to the sender.
+    // Equal to the options unless the adaptive mode backed off.
+    inline uint8_t rxBlockSize() const noexcept { return rxBlockSize_; }
+    inline std::chrono::microseconds rxSeparationTime() const noexcept
+    {
+        return rxSeparationTime_;
+    }
 
     // Receives next CAN message with proper id
     CanMessage recvNextFrame();
@@ -41,8 +76,33 @@ public:
 private:
     CanPtr can_;
     IsoTpOptions options_;
+    Pacer pacer_;
+
+    // Frames read from the interface with recvBatch() but not yet handled
+    std::array<CanMessage, 32> rxFrames_;
+    std::size_t rxCount_{0}, rxPosition_{0};
+
+    uint8_t rxBlockSize_{0};
+    std::chrono::microseconds rxSeparationTime_{0};
+    IsoTpReceiveStats rxStats_;
+    // Transfers received without error since the last back off
+    std::size_t cleanTransfers_{0};
 
     void sendSingleFrame(const uint8_t * data, std::size_t size);
+
+    // Returns the next frame of the current batch, reading a new batch
+    // from the interface when it is used up
+    bool recvFrame(CanMessage & message, std::chrono::milliseconds timeout);
+
+    // Restricts the CAN interface to frames from the remote id so the rest
+    // of the bus traffic is dropped before it reaches user space.
+    void updateFilters();
+
+    // Adaptive flow control. backOff() halves the block size and doubles the
+    // separation time; recover() steps back toward the configured values
+    // after a run of clean transfers.
+    void backOff();
+    void recover();
 };
 } // namespace lt::network
 
@@ -0,0 +1,102 @@
+#include "isotpsocketcan.h"
+
+#ifdef WITH_SOCKETCAN
+
+#include <net/if.h>
+#include <sys/socket.h>
+
+#include <linux/can.h>
+#include <linux/can/isotp.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace lt::network
+{
+
+IsoTpSocketCan::IsoTpSocketCan(std::string ifname, IsoTpOptions options)
+    : ifname_(std::move(ifname)), options_(options)
+{
+    open();
+}
+
+IsoTpSocketCan::~IsoTpSocketCan() { socket_.close(); }
+
+void IsoTpSocketCan::open()
+{
+    if (ifname_.size() >= IFNAMSIZ)
+        throw std::runtime_error("interface name '" + ifname_ +
+                                 "' is too long");
+
+    socket_.create(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
+
+    // Pad frames with zeros like IsoTpCan does and make send() wait for the
+    // transfer so flow control errors are reported to the caller
+    can_isotp_options opts{};
+    opts.flags = CAN_ISOTP_TX_PADDING | CAN_ISOTP_WAIT_TX_DONE;
+    opts.txpad_content = 0;
+    socket_.setsockopt(SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &opts, sizeof(opts));
+
+    // Flow control sent when receiving. The kernel has no adaptive mode, so
+    // only the configured values are used.
+    can_isotp_fc_options fc{};
+    fc.bs = options_.rxBlockSize;
+    fc.stmin = detail::calculate_st(options_.rxSeparationTime);
+    fc.wftmax = 0;
+    socket_.setsockopt(SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC, &fc, sizeof(fc));
+
+    ifreq ifr{};
+    std::strcpy(ifr.ifr_name, ifname_.c_str());
+    socket_.ioctl(SIOCGIFINDEX, &ifr);
+
+    sockaddr_can addr{};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    addr.can_addr.tp.tx_id = options_.sourceId;
+    addr.can_addr.tp.rx_id = options_.destId;
+    socket_.bind(reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+
+    auto seconds =
+        std::chrono::duration_cast<std::chrono::seconds>(options_.timeout);
+    timeval tv{};
+    tv.tv_sec = seconds.count();
+    tv.tv_usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                     options_.timeout - seconds)
+                     .count();
+    socket_.setsockopt(SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+void IsoTpSocketCan::setOptions(const IsoTpOptions & options)
+{
+    options_ = options;
+    open();
+}
+
+void IsoTpSocketCan::recv(IsoTpPacket & result)
+{
+    // The kernel delivers one reassembled packet per datagram. Receive
+    // straight into the packet; its allocation is kept between calls.
+    result.resize(isotp_max_size);
+    std::size_t size = socket_.recv(result.data(), result.size(), 0);
+    result.resize(size);
+    if (size == 0)
+        throw std::runtime_error("timed out");
+}
+
+void IsoTpSocketCan::request(const IsoTpPacket & req, IsoTpPacket & result)
+{
+    send(req);
+    recv(result);
+}
+
+void IsoTpSocketCan::send(const IsoTpPacket & packet)
+{
+    if (packet.size() > isotp_max_size)
+        throw std::runtime_error("IsoTp packet exceeds maximum size (" +
+                                 std::to_string(isotp_max_size) + ")");
+    socket_.send(packet.data(), packet.size(), 0);
+}
+
+} // namespace lt::network
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef LT_ISOTPSOCKETCAN_H
+#define LT_ISOTPSOCKETCAN_H
+
+#ifdef WITH_SOCKETCAN
+
+#include "isotp.h"
+#include "os/socket.h"
+
+#include <string>
+
+namespace lt::network
+{
+
+// ISO-TP over the Linux CAN_ISOTP socket. Segmentation, flow control and
+// STmin timing are handled by the kernel (can-isotp module, mainline
+// since 5.10).
+class IsoTpSocketCan : public IsoTp
+{
+public:
+    // Opens a CAN_ISOTP socket on interface `ifname`. Throws an exception
+    // if the interface does not exist or the kernel lacks CAN_ISOTP.
+    explicit IsoTpSocketCan(std::string ifname,
+                            IsoTpOptions options = IsoTpOptions());
+    ~IsoTpSocketCan() override;
+
+    void recv(IsoTpPacket & result) override;
+
+    void request(const IsoTpPacket & req, IsoTpPacket & result) override;
+
+    void send(const IsoTpPacket & packet) override;
+
+    // Rebinds the socket to the new ids
+    void setOptions(const IsoTpOptions & options) override;
+
+    inline const IsoTpOptions & options() const { return options_; }
+
+private:
+    std::string ifname_;
+    IsoTpOptions options_;
+    os::Socket socket_;
+
+    void open();
+};
+
+} // namespace lt::network
+
+#endif
+
+#endif // LT_ISOTPSOCKETCAN_H
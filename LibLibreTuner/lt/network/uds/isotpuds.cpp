@@ -1,26 +1,32 @@
 #include "isotpuds.h"
 
+#include <cassert>
+
 namespace lt::network
 {
 
-UdsPacket IsoTpUds::requestRaw(const UdsPacket & packet)
+IsoTpUds::IsoTpUds(IsoTpPtr && isotp) : isotp_(std::move(isotp))
 {
-    IsoTpPacket isotpPacket;
-    isotpPacket.append(&packet.code, 1);
-    isotpPacket.append(packet.data.data(), packet.data.size());
-    isotp_->send(isotpPacket);
-
-    return receiveRaw();
+    assert(isotp_);
+    request_.reserve(isotp_max_size);
+    response_.reserve(isotp_max_size);
 }
 
-UdsPacket IsoTpUds::receiveRaw()
+std::span<const uint8_t>
+IsoTpUds::requestRawView(uint8_t sid, std::span<const uint8_t> payload)
 {
-    IsoTpPacket res;
-    isotp_->recv(res);
+    // The SID goes into the packet headroom
+    request_.setData(payload);
+    request_.prepend(sid);
+    isotp_->send(request_);
 
-    std::vector<uint8_t> data;
-    res.moveInto(data);
-    return UdsPacket(data.data(), data.size());
+    return receiveRawView();
+}
+
+std::span<const uint8_t> IsoTpUds::receiveRawView()
+{
+    isotp_->recv(response_);
+    return response_.span();
 }
 
 } // namespace lt::network
@@ -13,15 +13,20 @@ class IsoTpUds : public Uds
 {
 public:
     // Takes ownership of an ISO-TP interface
-    IsoTpUds(IsoTpPtr && isotp) : isotp_(std::move(isotp)) { assert(isotp_); }
+    IsoTpUds(IsoTpPtr && isotp);
     ~IsoTpUds() override = default;
 
     // Inherited via Uds
-    virtual UdsPacket requestRaw(const UdsPacket & packet) override;
-    virtual UdsPacket receiveRaw() override;
+    std::span<const uint8_t>
+    requestRawView(uint8_t sid, std::span<const uint8_t> payload) override;
+    std::span<const uint8_t> receiveRawView() override;
 
 private:
     IsoTpPtr isotp_;
+
+    // Reused for every request so transfers do not allocate
+    IsoTpPacket request_;
+    IsoTpPacket response_;
 };
 
 } // namespace network
@@ -1,6 +1,8 @@
 #include "uds.h"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <sstream>
 #include <stdexcept>
 
@@ -11,22 +13,31 @@ namespace network
 
 UdsPacket Uds::request(uint8_t sid, const uint8_t * data, size_t size)
 {
-    // Receive until we get a non-response-pending packet
-
-    // Build request
-    UdsPacket request(sid, data, size);
+    std::span<const uint8_t> response = requestView(sid, {data, size});
+    return UdsPacket(sid + 0x40, response.data(), response.size());
+}
 
-    UdsPacket response = requestRaw(request);
+std::span<const uint8_t> Uds::requestView(uint8_t sid,
+                                          std::span<const uint8_t> data)
+{
+    std::span<const uint8_t> response = requestRawView(sid, data);
 
+    // Receive until we get a non-response-pending packet
     do
     {
-        if (response.negative())
+        if (response.empty())
         {
-            uint8_t code = response.negativeCode();
+            throw std::runtime_error("received empty uds response");
+        }
+
+        if (response[0] == UDS_RES_NEGATIVE)
+        {
+            // 0x7F, request SID, response code
+            uint8_t code = response.size() > 2 ? response[2] : 0;
             if (code == UDS_NRES_RCRRP)
             {
                 // Response pending
-                response = receiveRaw();
+                response = receiveRawView();
                 continue;
             }
             std::stringstream ss;
@@ -36,17 +47,29 @@ UdsPacket Uds::request(uint8_t sid, const uint8_t * data, size_t size)
             throw std::runtime_error(ss.str());
         }
 
-        if (response.code != sid + 0x40)
+        if (response[0] != sid + 0x40)
         {
             throw std::runtime_error("uds response id (" +
-                                     std::to_string(response.code) +
+                                     std::to_string(response[0]) +
                                      ") does not match expected id (" +
                                      std::to_string(sid + 0x40) + ")");
         }
-        return response;
+        return response.subspan(1);
     } while (true);
 }
 
+UdsPacket Uds::requestRaw(const UdsPacket & packet)
+{
+    std::span<const uint8_t> response = requestRawView(packet.code, packet.data);
+    return UdsPacket(response.data(), response.size());
+}
+
+UdsPacket Uds::receiveRaw()
+{
+    std::span<const uint8_t> response = receiveRawView();
+    return UdsPacket(response.data(), response.size());
+}
+
 std::vector<uint8_t> Uds::requestSession(uint8_t type)
 {
     UdsPacket res = request(UDS_REQ_SESSION, &type, 1);
@@ -98,6 +121,17 @@ void Uds::requestSecurityKey(const uint8_t * key, size_t size)
 std::vector<uint8_t> Uds::requestReadMemoryAddress(uint32_t address,
                                                    uint16_t length)
 {
+    std::vector<uint8_t> data(length);
+    data.resize(requestReadMemoryAddress(address, data));
+    return data;
+}
+
+std::size_t Uds::requestReadMemoryAddress(uint32_t address,
+                                          std::span<uint8_t> dest)
+{
+    assert(dest.size() <= 0xFFFF);
+    auto length = static_cast<uint16_t>(dest.size());
+
     std::array<uint8_t, 6> req;
     req[0] = (address & 0xFF000000) >> 24;
     req[1] = (address & 0xFF0000) >> 16;
@@ -107,9 +141,11 @@ std::vector<uint8_t> Uds::requestReadMemoryAddress(uint32_t address,
     req[4] = length >> 8;
     req[5] = length & 0xFF;
 
-    UdsPacket res = request(UDS_REQ_READMEM, req.data(), req.size());
+    std::span<const uint8_t> res = requestView(UDS_REQ_READMEM, req);
 
-    return res.data;
+    std::size_t size = std::min(res.size(), dest.size());
+    std::copy_n(res.begin(), size, dest.begin());
+    return size;
 }
 
 std::vector<uint8_t> Uds::readDataByIdentifier(uint16_t id)
@@ -122,5 +158,25 @@ std::vector<uint8_t> Uds::readDataByIdentifier(uint16_t id)
     return res.data;
 }
 
+std::vector<uint8_t> Uds::startRoutine(uint16_t id,
+                                       std::span<const uint8_t> option)
+{
+    std::vector<uint8_t> req(3 + option.size());
+    req[0] = 1;
+    req[1] = id >> 8;
+    req[2] = id & 0xFF;
+    std::copy(option.begin(), option.end(), req.begin() + 3);
+
+    UdsPacket res = request(UDS_REQ_ROUTINECONTROL, req.data(), req.size());
+    if (res.data.size() < 3 ||
+        !std::equal(req.begin(), req.begin() + 3, res.data.begin()))
+    {
+        throw std::runtime_error("routine control response mismatch");
+    }
+
+    res.data.erase(res.data.begin(), res.data.begin() + 3);
+    return res.data;
+}
+
 } // namespace network
 } // namespace lt
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace lt
@@ -17,6 +18,8 @@ constexpr uint8_t UDS_REQ_READMEM = 0x23;
 constexpr uint8_t UDS_REQ_REQUESTDOWNLOAD = 0x34;
 constexpr uint8_t UDS_REQ_REQUESTUPLOAD = 0x35;
 constexpr uint8_t UDS_REQ_TRANSFERDATA = 0x36;
+constexpr uint8_t UDS_REQ_TRANSFEREXIT = 0x37;
+constexpr uint8_t UDS_REQ_ROUTINECONTROL = 0x31;
 constexpr uint8_t UDS_REQ_READBYID = 0x22;
 
 constexpr uint8_t UDS_RES_NEGATIVE = 0x7F;
@@ -53,7 +56,7 @@ struct UdsPacket
     bool negative() const noexcept { return code == UDS_RES_NEGATIVE; }
     uint8_t negativeCode() const noexcept
     {
-        return data.size() > 1 ? 0 : data[1];
+        return data.size() > 1 ? data[1] : 0;
     }
 };
 
@@ -67,6 +70,12 @@ public:
        including RCRRP). */
     UdsPacket request(uint8_t sid, const uint8_t * data, size_t size);
 
+    /* Same as request() without copying the response. Returns the payload
+       (without the SID). The view points into a buffer owned by the
+       interface and is valid until the next request. */
+    std::span<const uint8_t> requestView(uint8_t sid,
+                                         std::span<const uint8_t> data);
+
     /* All requests may throw an exception */
     /* Sends a DiagnosticSessionControl request. Returns parameter record. */
     std::vector<uint8_t> requestSession(uint8_t type);
@@ -79,13 +88,30 @@ public:
     std::vector<uint8_t> requestReadMemoryAddress(uint32_t address,
                                                   uint16_t length);
 
+    /* ReadMemoryByAddress of dest.size() bytes (at most 0xFFFF) into
+       `dest`. Returns the amount of bytes copied. */
+    std::size_t requestReadMemoryAddress(uint32_t address,
+                                         std::span<uint8_t> dest);
+
     std::vector<uint8_t> readDataByIdentifier(uint16_t id);
 
+    /* RoutineControl startRoutine. Returns the routine status record. */
+    std::vector<uint8_t> startRoutine(uint16_t id,
+                                      std::span<const uint8_t> option);
+
     // Sends a request but does not throw an exception on negative errors.
     // Must not handle RCRRP or other negative responses.
-    virtual UdsPacket requestRaw(const UdsPacket & packet) = 0;
+    UdsPacket requestRaw(const UdsPacket & packet);
+
+    UdsPacket receiveRaw();
+
+    // Non-copying versions of requestRaw() and receiveRaw(). The returned
+    // response starts with the SID, points into a buffer owned by the
+    // interface and is valid until the next request.
+    virtual std::span<const uint8_t>
+    requestRawView(uint8_t sid, std::span<const uint8_t> payload) = 0;
 
-    virtual UdsPacket receiveRaw() = 0;
+    virtual std::span<const uint8_t> receiveRawView() = 0;
 };
 using UdsPtr = std::unique_ptr<Uds>;
 
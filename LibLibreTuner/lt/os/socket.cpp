@@ -65,13 +65,28 @@ std::size_t Socket::recv(void * buffer, int length, int flags)
     return ret;
 }
 
-ssize_t Socket::sendNoExcept(void * buffer, int length, int flags) noexcept
+std::size_t Socket::recvmmsg(mmsghdr * messages, unsigned int vlen, int flags)
+{
+    assert(valid());
+    int ret = ::recvmmsg(socket_, messages, vlen, flags, nullptr);
+    if (ret == -1)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return 0;
+        }
+        throwErrno();
+    }
+    return ret;
+}
+
+ssize_t Socket::sendNoExcept(const void * buffer, int length, int flags) noexcept
 {
     assert(valid());
     return ::send(socket_, buffer, length, flags);
 }
 
-void Socket::send(void * buffer, int length, int flags)
+void Socket::send(const void * buffer, int length, int flags)
 {
     assert(valid());
     ssize_t ret = ::send(socket_, buffer, length, flags);
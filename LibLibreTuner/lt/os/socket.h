@@ -53,9 +53,13 @@ public:
     std::size_t recv(void * buffer, int length, int flags);
     ssize_t recvNoExcept(void * buffer, int length, int flags) noexcept;
 
+    // Receives up to `vlen` datagrams in one call. Returns the amount of
+    // messages received or 0 if the receive timed out.
+    std::size_t recvmmsg(mmsghdr * messages, unsigned int vlen, int flags);
+
     // Throws an exception on failure or if less than `length` bytes are sent
-    void send(void * buffer, int length, int flags);
-    ssize_t sendNoExcept(void * buffer, int length, int flags) noexcept;
+    void send(const void * buffer, int length, int flags);
+    ssize_t sendNoExcept(const void * buffer, int length, int flags) noexcept;
 
     void setsockopt(int level, int option_name, const void * option_value,
                     SocketLen_t option_len);
@@ -0,0 +1,186 @@
+#include "checksumaudit.h"
+#include "project.h"
+
+#include "../support/parallelfor.h"
+
+#include <algorithm>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace lt
+{
+
+namespace
+{
+// Files opened at once. Bounds the mappings and buffers held by an audit.
+constexpr std::size_t batch_size = 64;
+
+// An opened file and the entry its results go to
+struct AuditItem
+{
+    ChecksumAuditEntry * entry{nullptr};
+    const Checksums * checksums{nullptr};
+    // The ROM, or the base of the tune
+    RomPtr rom;
+    // Set when auditing a tune
+    TunePtr tune;
+};
+
+// Tune data is paged, so the region is copied out before computing it
+ChecksumResult verifyTune(const Tune & tune, const Checksum & checksum)
+{
+    ChecksumResult result;
+    result.target = checksum.target();
+    if (checksum.offset() < 0 || checksum.size() < 0 ||
+        static_cast<std::size_t>(checksum.offset()) + checksum.size() > tune.size())
+    {
+        return result;
+    }
+
+    std::vector<uint8_t> bytes(checksum.size());
+    tune.read(checksum.offset(), bytes);
+    result.value = checksum.finish(checksum.partial(bytes.data(), bytes.size()));
+    result.inRange = true;
+    return result;
+}
+
+// Computes every checksum of every item, one task per region
+void verifyItems(std::vector<AuditItem> & items)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> tasks;
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        items[i].entry->results.resize(items[i].checksums->size());
+        for (std::size_t checksum = 0; checksum < items[i].checksums->size(); ++checksum)
+        {
+            tasks.emplace_back(i, checksum);
+            bytes += static_cast<std::size_t>(std::max((*items[i].checksums)[checksum].size(), 0));
+        }
+    }
+
+    parallelFor(tasks.size(), bytes, [&](std::size_t task) {
+        auto [index, checksum] = tasks[task];
+        AuditItem & item = items[index];
+        const Checksum & definition = (*item.checksums)[checksum];
+        if (item.tune)
+        {
+            item.entry->results[checksum] = verifyTune(*item.tune, definition);
+        }
+        else
+        {
+            std::span<const uint8_t> bytes = item.rom->bytes();
+            item.entry->results[checksum] = definition.verify(bytes.data(), static_cast<int>(bytes.size()));
+        }
+    });
+}
+
+// Regular files in `directory` with `extension`, sorted by path
+std::vector<fs::path> listFiles(const fs::path & directory, const std::string & extension)
+{
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const fs::directory_entry & entry : fs::directory_iterator(directory, ec))
+    {
+        if (entry.is_regular_file(ec) && entry.path().extension() == extension)
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+} // namespace
+
+bool ChecksumAuditEntry::ok() const noexcept
+{
+    return error.empty() &&
+           std::all_of(results.begin(), results.end(), [](const ChecksumResult & result) { return result.ok(); });
+}
+
+std::size_t ChecksumAuditReport::failures() const noexcept
+{
+    auto failed = [](const ChecksumAuditEntry & entry) { return !entry.ok(); };
+    return std::count_if(roms.begin(), roms.end(), failed) + std::count_if(tunes.begin(), tunes.end(), failed);
+}
+
+ChecksumAuditReport auditChecksums(const Project & project)
+{
+    ChecksumAuditReport report;
+    // ROM paths by hash, to find the bases of tunes
+    std::unordered_map<std::string, fs::path> romsByHash;
+    for (const fs::path & path : listFiles(project.romsDirectory(), Rom::extension))
+    {
+        report.roms.push_back(ChecksumAuditEntry{path, {}, {}});
+        if (std::string hash = readMetadata<Rom::MetaData>(path).hash; !hash.empty())
+            romsByHash.emplace(std::move(hash), path);
+    }
+    for (const fs::path & path : listFiles(project.tunesDirectory(), Tune::extension))
+        report.tunes.push_back(ChecksumAuditEntry{path, {}, {}});
+
+    // Bases are read once per audit
+    std::map<fs::path, RomPtr> bases;
+    auto findBase = [&](const Tune::MetaData & meta) {
+        // Prefer the ROM with identical data, as Project::loadTune() does
+        fs::path path = project.romsDirectory() / meta.base;
+        if (auto it = romsByHash.find(meta.baseHash); it != romsByHash.end())
+            path = it->second;
+        if (!fs::is_regular_file(path))
+            return RomPtr();
+        RomPtr & rom = bases[path];
+        if (!rom)
+            rom = project.readRom(path);
+        return rom;
+    };
+
+    auto open = [&](ChecksumAuditEntry & entry, bool isTune) {
+        AuditItem item;
+        item.entry = &entry;
+        if (isTune)
+        {
+            item.tune = project.readTune(entry.path, findBase);
+            item.rom = item.tune->base();
+        }
+        else
+        {
+            item.rom = project.readRom(entry.path);
+        }
+
+        if (!item.rom->model())
+            throw std::runtime_error("ROM has no model");
+        item.checksums = &item.rom->model()->checksums;
+        return item;
+    };
+
+    std::vector<std::pair<ChecksumAuditEntry *, bool>> pending;
+    for (ChecksumAuditEntry & entry : report.roms)
+        pending.emplace_back(&entry, false);
+    for (ChecksumAuditEntry & entry : report.tunes)
+        pending.emplace_back(&entry, true);
+
+    for (std::size_t start = 0; start < pending.size(); start += batch_size)
+    {
+        std::vector<AuditItem> items;
+        std::size_t end = std::min(start + batch_size, pending.size());
+        for (std::size_t i = start; i < end; ++i)
+        {
+            auto [entry, isTune] = pending[i];
+            try
+            {
+                items.push_back(open(*entry, isTune));
+            }
+            catch (const std::exception & e)
+            {
+                entry->error = e.what();
+            }
+        }
+        verifyItems(items);
+    }
+    return report;
+}
+
+} // namespace lt
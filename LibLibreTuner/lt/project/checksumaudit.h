@@ -0,0 +1,48 @@
+#ifndef LT_CHECKSUMAUDIT_H
+#define LT_CHECKSUMAUDIT_H
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../definition/checksum.h"
+
+namespace lt
+{
+
+class Project;
+
+// Checksum results of one ROM or tune file
+struct ChecksumAuditEntry
+{
+    std::filesystem::path path;
+    // One per checksum of the model, in definition order
+    std::vector<ChecksumResult> results;
+    // Set if the file could not be loaded
+    std::string error;
+
+    bool ok() const noexcept;
+};
+
+struct ChecksumAuditReport
+{
+    std::vector<ChecksumAuditEntry> roms;
+    std::vector<ChecksumAuditEntry> tunes;
+
+    // Number of files that failed to load or have a bad checksum
+    std::size_t failures() const noexcept;
+};
+
+/* Verifies the checksums of every ROM and tune file in `project` as they
+ * are on disk, so unsaved edits of open tunes do not count. Files are read
+ * independently of the project's caches, so the audit may run on another
+ * thread while the project is in use. Files are opened on the calling
+ * thread, which only maps them; the checksum regions of a batch of files
+ * are then read and computed on one thread per core. A file that cannot
+ * be loaded is reported in its entry instead of throwing. */
+ChecksumAuditReport auditChecksums(const Project & project);
+
+} // namespace lt
+
+#endif // LT_CHECKSUMAUDIT_H
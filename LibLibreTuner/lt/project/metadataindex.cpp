@@ -0,0 +1,217 @@
+#include "metadataindex.h"
+
+#include "../libretuner.h"
+#include "rom/imagefile.h"
+#include "rom/rom.h"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace lt
+{
+
+namespace
+{
+// Bumped when the index file layout or a MetaData layout changes
+constexpr uint32_t index_version = 1;
+
+int64_t modificationTime(const fs::directory_entry & entry, std::error_code & ec)
+{
+    return static_cast<int64_t>(entry.last_write_time(ec).time_since_epoch().count());
+}
+} // namespace
+
+template <typename MetaData> MetaData decodeMetadata(std::span<const uint8_t> encoded)
+{
+    std::istringstream stream(std::string(encoded.begin(), encoded.end()), std::ios::binary | std::ios::in);
+    cereal::BinaryInputArchive archive(stream);
+    MetaData meta;
+    archive(meta);
+    return meta;
+}
+
+template <typename MetaData> MetaData readMetadata(const fs::path & path)
+{
+    MetaData md;
+    try
+    {
+        // Image files are read from their metadata section alone
+        if (auto header = readImageHeader(path))
+        {
+            std::string encoded = readImageMetadata(path, *header);
+            md = decodeMetadata<MetaData>(
+                std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(encoded.data()), encoded.size()));
+        }
+        else
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::in);
+            if (file.is_open())
+            {
+                cereal::BinaryInputArchive ar(file);
+                ar(md);
+            }
+        }
+    }
+    catch (const std::exception & e)
+    {
+        log(LogLevel::Warning, "Failed to read metadata of '" + path.string() + "': " + e.what());
+        md = MetaData();
+    }
+    md.path = path;
+    return md;
+}
+
+template <typename MetaData>
+MetadataIndex<MetaData>::MetadataIndex(fs::path directory, fs::path indexPath)
+    : directory_(std::move(directory)), indexPath_(std::move(indexPath))
+{
+}
+
+template <typename MetaData> std::vector<MetaData> MetadataIndex<MetaData>::query(const std::string & extension)
+{
+    if (!loaded_)
+    {
+        load();
+        loaded_ = true;
+    }
+
+    // Start watching before scanning, so no change falls in between
+    bool watched = watcher_ && watcher_->watching();
+    if (!watched)
+        watcher_ = std::make_unique<DirectoryWatcher>(directory_);
+
+    if ((!watched || watcher_->changed() || !scanned_) && scan())
+        save();
+    scanned_ = true;
+
+    std::vector<MetaData> metadata;
+    metadata.reserve(entries_.size());
+    for (const auto & [filename, entry] : entries_)
+    {
+        fs::path path = directory_ / filename;
+        if (!extension.empty() && path.extension() != extension)
+            continue;
+        metadata.push_back(entry.metadata);
+        metadata.back().path = std::move(path);
+    }
+    return metadata;
+}
+
+template <typename MetaData> void MetadataIndex<MetaData>::invalidate() noexcept
+{
+    entries_.clear();
+    scanned_ = false;
+}
+
+template <typename MetaData> bool MetadataIndex<MetaData>::scan()
+{
+    std::map<std::string, Entry> entries;
+    std::vector<std::pair<fs::path, Entry *>> stale;
+
+    std::error_code ec;
+    for (const auto & file : fs::directory_iterator(directory_, ec))
+    {
+        if (!file.is_regular_file(ec))
+            continue;
+
+        Entry entry;
+        entry.size = file.file_size(ec);
+        entry.modified = modificationTime(file, ec);
+        if (ec)
+            continue;
+
+        std::string filename = file.path().filename().string();
+        auto known = entries_.find(filename);
+        if (known != entries_.end() && known->second.size == entry.size && known->second.modified == entry.modified)
+        {
+            entries.emplace(filename, std::move(known->second));
+            continue;
+        }
+        auto inserted = entries.emplace(filename, std::move(entry)).first;
+        stale.emplace_back(file.path(), &inserted->second);
+    }
+
+    bool changed = !stale.empty() || entries.size() != entries_.size();
+    entries_ = std::move(entries);
+    if (stale.empty())
+        return changed;
+
+    // Decode new and changed files in parallel, e.g. on the first start
+    auto decode = [&stale](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < std::min(end, stale.size()); ++i)
+            stale[i].second->metadata = readMetadata<MetaData>(stale[i].first);
+    };
+
+    unsigned threads = static_cast<unsigned>(std::clamp<std::size_t>(
+        stale.size() / min_files_per_thread, 1, std::max(std::thread::hardware_concurrency(), 1u)));
+    const std::size_t share = (stale.size() + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back(decode, i * share, (i + 1) * share);
+    decode(0, share);
+    for (std::thread & worker : workers)
+        worker.join();
+    return true;
+}
+
+template <typename MetaData> void MetadataIndex<MetaData>::load()
+{
+    std::ifstream file(indexPath_, std::ios::binary | std::ios::in);
+    if (!file.is_open())
+        return;
+
+    try
+    {
+        cereal::BinaryInputArchive archive(file);
+        uint32_t version = 0;
+        archive(version);
+        if (version == index_version)
+            archive(entries_);
+    }
+    catch (const std::exception &)
+    {
+        // A damaged index is rebuilt by the next scan
+        entries_.clear();
+    }
+}
+
+template <typename MetaData> void MetadataIndex<MetaData>::save() const
+{
+    // The index is only a cache. Failing to write it costs the next
+    // start a full scan.
+    std::error_code ec;
+    fs::create_directories(indexPath_.parent_path(), ec);
+
+    fs::path temporary = indexPath_;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            return;
+        cereal::BinaryOutputArchive archive(file);
+        archive(index_version, entries_);
+        if (!file.flush())
+            return;
+    }
+    fs::rename(temporary, indexPath_, ec);
+}
+
+template Rom::MetaData decodeMetadata<Rom::MetaData>(std::span<const uint8_t>);
+template Tune::MetaData decodeMetadata<Tune::MetaData>(std::span<const uint8_t>);
+template Rom::MetaData readMetadata<Rom::MetaData>(const fs::path &);
+template Tune::MetaData readMetadata<Tune::MetaData>(const fs::path &);
+template class MetadataIndex<Rom::MetaData>;
+template class MetadataIndex<Tune::MetaData>;
+
+} // namespace lt
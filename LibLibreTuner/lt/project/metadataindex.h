@@ -0,0 +1,74 @@
+#ifndef LT_METADATAINDEX_H
+#define LT_METADATAINDEX_H
+
+#include "../support/directorywatcher.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lt
+{
+
+/* Decodes the metadata section of an image file. Defined for
+ * Rom::MetaData and Tune::MetaData. */
+template <typename MetaData> MetaData decodeMetadata(std::span<const uint8_t> encoded);
+
+/* Reads the metadata of a ROM or tune file. Returns empty metadata with
+ * only the path set if the file is invalid. */
+template <typename MetaData> MetaData readMetadata(const std::filesystem::path & path);
+
+/* Metadata of every file in a directory, kept in an index file so a
+ * listing only decodes files that were added or changed since it was
+ * last written. Files are matched by path, size and modification time.
+ * The directory is watched for changes, so listing an unchanged
+ * directory touches no files at all. Defined for Rom::MetaData and
+ * Tune::MetaData. */
+template <typename MetaData> class MetadataIndex
+{
+public:
+    // Files at least this many are decoded in parallel
+    static constexpr std::size_t min_files_per_thread = 16;
+
+    MetadataIndex(std::filesystem::path directory, std::filesystem::path indexPath);
+
+    /* Returns the metadata of every regular file in the directory, sorted
+     * by path. If `extension` is not empty, only files with it are
+     * returned. */
+    std::vector<MetaData> query(const std::string & extension = std::string());
+
+    // Forgets everything, e.g. after a file was replaced without
+    // changing its size and time
+    void invalidate() noexcept;
+
+private:
+    struct Entry
+    {
+        uint64_t size{0};
+        int64_t modified{0};
+        MetaData metadata;
+
+        template <class Archive> void serialize(Archive & archive) { archive(size, modified, metadata); }
+    };
+
+    std::filesystem::path directory_;
+    std::filesystem::path indexPath_;
+    // Keyed by filename
+    std::map<std::string, Entry> entries_;
+    std::unique_ptr<DirectoryWatcher> watcher_;
+    bool loaded_{false};
+    bool scanned_{false};
+
+    // Checks every file in the directory. Returns true if any changed.
+    bool scan();
+    void load();
+    void save() const;
+};
+
+} // namespace lt
+
+#endif // LT_METADATAINDEX_H
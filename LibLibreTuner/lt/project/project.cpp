@@ -1,9 +1,12 @@
 #include <utility>
 
 #include "project.h"
+#include "../datalog/datalog.h"
+#include "../libretuner.h"
 
 #include <cassert>
 #include <fstream>
+#include <sstream>
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/string.hpp>
@@ -26,15 +29,41 @@ RomPtr Project::getRom(const std::string & filename)
             return rom;
     }
 
-    std::ifstream file(romsDir_ / filename, std::ios::binary | std::ios::in);
-    if (!file.is_open())
+    fs::path path = romsDir_ / filename;
+    if (!fs::is_regular_file(path))
         return RomPtr();
 
-    // Deserialize ROM with cereal
-    cereal::BinaryInputArchive archive(file);
+    RomPtr rom = loadRom(path, true);
+    rom->setStore(store_);
+    // Insert into cache
+    cache_.emplace(filename, rom);
+    return rom;
+}
+
+RomPtr Project::readRom(const fs::path & path) const { return loadRom(path, false); }
+
+RomPtr Project::loadRom(const fs::path & path, bool shareMappings) const
+{
     Rom::MetaData meta;
     MemoryBuffer data;
-    archive(meta, data);
+    std::optional<MappedImage> mapped;
+    if (readImageHeader(path))
+    {
+        // The data is used from the mapping; nothing is read up front
+        mapped = mapImageFile(path, MappedFile::Mode::ReadOnly);
+        meta = decodeMetadata<Rom::MetaData>(mapped->metadata());
+    }
+    else
+    {
+        // Files from older versions hold everything in a cereal archive.
+        // They are converted the next time they are saved.
+        std::ifstream file(path, std::ios::binary | std::ios::in);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open '" + path.string() + "'");
+
+        cereal::BinaryInputArchive archive(file);
+        archive(meta, data);
+    }
 
     // Find the model
     ModelPtr model =
@@ -44,11 +73,39 @@ RomPtr Project::getRom(const std::string & filename)
                                  meta.platform + "' and '" +
                                  meta.model + "'");
     auto rom = std::make_shared<Rom>(model);
-    rom->setPath(romsDir_ / filename);
+    rom->setPath(path);
     rom->setName(meta.name);
-    rom->setData(std::move(data));
-    // Insert into cache
-    cache_.emplace(filename, rom);
+    if (mapped && mapped->header.imageSize == 0 && !meta.hash.empty())
+    {
+        // The image is in the ROM store
+        if (!store_ || !store_->contains(meta.hash))
+            throw std::runtime_error("the image of '" + path.string() + "' is not in the ROM store" +
+                                     (store_ ? " at '" + store_->directory().string() + "'" : std::string()));
+
+        if (shareMappings)
+        {
+            // A copied project records its own files when they are first
+            // loaded, so the image outlives the originals
+            try
+            {
+                store_->addReference(meta.hash, path);
+            }
+            catch (const std::runtime_error & error)
+            {
+                log(LogLevel::Warning, error.what());
+            }
+        }
+
+        // RomStore::get() shares mappings but is not thread-safe
+        MappedFilePtr file =
+            shareMappings ? store_->get(meta.hash)
+                          : std::make_shared<MappedFile>(store_->path(meta.hash), MappedFile::Mode::ReadOnly);
+        rom->setData(file->bytes(), file, meta.hash);
+    }
+    else if (mapped)
+        rom->setFile(std::move(*mapped), meta.hash);
+    else
+        rom->setData(std::move(data));
     return rom;
 }
 
@@ -62,24 +119,55 @@ TunePtr Project::loadTune(const std::string & filename)
             return tune;
     }
 
-    std::ifstream file(tunesDir_ / filename, std::ios::binary | std::ios::in);
-    if (!file.is_open())
+    fs::path path = tunesDir_ / filename;
+    if (!fs::is_regular_file(path))
         return TunePtr();
 
-    cereal::BinaryInputArchive archive(file);
+    TunePtr tune = readTune(path, [this](const Tune::MetaData & meta) {
+        // Prefer the ROM with identical data, which survives renaming
+        RomPtr rom;
+        if (!meta.baseHash.empty())
+            rom = findRom(meta.baseHash);
+        if (!rom)
+            rom = getRom(meta.base);
+        return rom;
+    });
+    tuneCache_.emplace(filename, tune);
+    return tune;
+}
+
+TunePtr Project::readTune(const fs::path & path, const std::function<RomPtr(const Tune::MetaData &)> & findBase) const
+{
     Tune::MetaData meta;
     MemoryBuffer data;
-    archive(meta, data);
+    std::optional<MappedImage> mapped;
+    if (readImageHeader(path))
+    {
+        mapped = mapImageFile(path, MappedFile::Mode::Private);
+        meta = decodeMetadata<Tune::MetaData>(mapped->metadata());
+    }
+    else
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::in);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open '" + path.string() + "'");
 
-    RomPtr rom = getRom(meta.base);
+        cereal::BinaryInputArchive archive(file);
+        archive(meta, data);
+    }
+
+    RomPtr rom = findBase(meta);
     if (!rom)
         throw std::runtime_error("unable to find ROM with id '" +
                                  meta.base + "'");
 
-    auto tune = std::make_shared<Tune>(rom, std::move(data));
-    tune->setPath(tunesDir_ / filename);
+    TunePtr tune;
+    if (mapped)
+        tune = std::make_shared<Tune>(rom, std::move(*mapped), path);
+    else
+        tune = std::make_shared<Tune>(rom, std::move(data));
+    tune->setPath(path);
     tune->setName(meta.name);
-    tuneCache_.emplace(filename, tune);
     return tune;
 }
 
@@ -89,55 +177,59 @@ const fs::path & Project::romsDirectory() const noexcept { return romsDir_; }
 
 Project::Project(const fs::path& base, const Platforms & platforms)
     : path_(base), tunesDir_(base / "tunes"), romsDir_(base / "roms"),
+      romIndex_(romsDir_, base / "cache" / "roms.index"),
+      tuneIndex_(tunesDir_, base / "cache" / "tunes.index"),
       platforms_(std::move(platforms))
 {
 }
 
-template <typename MetaData>
-std::vector<MetaData> getMetaData(fs::path & dir, bool requiresExtension,
-                                  const std::string & extension)
+void Project::setRomStore(RomStorePtr store)
 {
-    std::vector<MetaData> metadata;
-    for (const auto & entry : fs::directory_iterator(dir))
+    store_ = std::move(store);
+    for (auto & [filename, weak] : cache_)
     {
-        if (!entry.is_regular_file() ||
-            (requiresExtension && entry.path().extension() != extension))
-            continue;
-
-        std::ifstream file(entry.path(), std::ios::binary | std::ios::in);
-        if (!file.is_open())
-            continue; // TODO: Log this
+        if (auto rom = weak.lock())
+            rom->setStore(store_);
+    }
+}
 
-        cereal::BinaryInputArchive ar(file);
-        MetaData md;
-        try
-        {
-            ar(md);
-        }
-        catch (const std::runtime_error & err)
-        {
-            // TODO: Log exception
-        }
-        md.path = entry.path();
-        metadata.emplace_back(std::move(md));
+RomPtr Project::findRom(const std::string & hash)
+{
+    // Loaded ROMs first. Their hash is known unless they were never saved.
+    for (const auto & [filename, weak] : cache_)
+    {
+        if (auto rom = weak.lock(); rom && rom->hash() == hash)
+            return rom;
     }
-    return metadata;
+
+    queryRoms();
+    auto it = romsByHash_.find(hash);
+    if (it == romsByHash_.end())
+        return RomPtr();
+    return getRom(it->second);
 }
 
 std::vector<Rom::MetaData> Project::queryRoms()
 {
+    romsByHash_.clear();
     if (!fs::exists(romsDir_))
         return std::vector<Rom::MetaData>();
-    return getMetaData<Rom::MetaData>(romsDir_, enforceExtensions_,
-                                      Rom::extension);
+
+    std::vector<Rom::MetaData> roms =
+        romIndex_.query(enforceExtensions_ ? Rom::extension : "");
+    for (const Rom::MetaData & rom : roms)
+    {
+        if (!rom.hash.empty())
+            romsByHash_.emplace(rom.hash, rom.path.filename().string());
+    }
+    return roms;
 }
 
 std::vector<Tune::MetaData> Project::queryTunes()
 {
     if (!fs::exists(tunesDir_))
         return std::vector<Tune::MetaData>();
-    return getMetaData<Tune::MetaData>(tunesDir_, enforceExtensions_,
-                                       Tune::extension);
+    return tuneIndex_.query(enforceExtensions_ ? Tune::extension : "");
 }
 
 TunePtr Project::createTune(RomPtr base, const std::string & name)
@@ -156,6 +248,7 @@ void Project::makeDirectories()
     fs::create_directories(romsDirectory());
     fs::create_directories(tunesDirectory());
     fs::create_directories(logsDirectory());
+    fs::create_directories(downloadsDirectory());
 }
 
 std::filesystem::path Project::logsDirectory() const noexcept
@@ -163,6 +256,11 @@ std::filesystem::path Project::logsDirectory() const noexcept
     return path_ / "logs";
 }
 
+std::filesystem::path Project::downloadsDirectory() const noexcept
+{
+    return path_ / "downloads";
+}
+
 inline fs::path generatePath(const fs::path & dir, std::string && id,
                              const std::string & extension)
 {
@@ -191,6 +289,11 @@ fs::path Project::generateTunePath(std::string name)
     return generatePath(tunesDir_, std::move(name), Tune::extension);
 }
 
+fs::path Project::generateLogPath(std::string name)
+{
+    return generatePath(logsDirectory(), std::move(name), DataLog::extension);
+}
+
 void Project::save() const
 {
     fs::path path = path_ / config_filename;
@@ -222,6 +325,7 @@ RomPtr Project::createRom(const std::string & name, lt::ModelPtr model)
     auto rom = std::make_shared<lt::Rom>(model);
     rom->setName(name);
     rom->setPath(generateRomPath(name));
+    rom->setStore(store_);
 
     cache_.emplace(rom->path().string(), rom);
     return rom;
@@ -231,37 +335,46 @@ RomPtr Project::importRom(const std::string & name,
                           const std::filesystem::path & path,
                           lt::PlatformPtr platform)
 {
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open())
-        throw std::runtime_error("failed to open ROM file '" + path.string() +
-                                 "'");
-
-    // Get file size
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    // Allocate buffer
-    std::vector<uint8_t> buffer(size);
-    file.read(reinterpret_cast<char *>(buffer.data()), size);
-    file.close();
+    // Map the file instead of copying it. The ROM uses the mapping until
+    // it is saved.
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Mode::ReadOnly);
 
     // Identify model
-    lt::ModelPtr model = platform->identify(
-        reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size());
+    lt::ModelPtr model =
+        platform ? platform->identify(file->data(), file->size())
+                 : platforms_.identify(file->data(), file->size());
     if (!model)
+    {
+        if (platform)
+            throw std::runtime_error(
+                "failed to identify model from ROM data for platform '" +
+                platform->name + "'");
         throw std::runtime_error(
-            "failed to identify model from ROM data for platform '" +
-            platform->name + "'");
+            "failed to identify model from ROM data for any platform");
+    }
 
     lt::RomPtr rom = createRom(name, model);
-    rom->setData(MemoryBuffer(std::move(buffer)));
+    std::string hash = RomStore::hash(file->bytes());
+    if (store_ && store_->contains(hash))
+    {
+        // Already stored; saving the ROM writes only its metadata
+        MappedFilePtr stored = store_->get(hash);
+        rom->setData(stored->bytes(), stored, std::move(hash));
+    }
+    else
+        rom->setData(file->bytes(), file, std::move(hash));
     return rom;
 }
 
 bool Project::deleteRom(const std::string & filename)
 {
     cache_.erase(filename);
-    return fs::remove(romsDir_ / filename);
+    if (!fs::remove(romsDir_ / filename))
+        return false;
+
+    if (store_)
+        store_->removeUnreferenced();
+    return true;
 }
 
 bool Project::deleteTune(const std::string & filename)
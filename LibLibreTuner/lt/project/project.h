@@ -2,7 +2,9 @@
 #define LIBRETUNER_PROJECT_H
 
 #include "../rom/rom.h"
+#include "metadataindex.h"
 #include <filesystem>
+#include <functional>
 #include <string>
 
 namespace lt
@@ -20,12 +22,29 @@ public:
      * fails, throws an exception. */
     RomPtr getRom(const std::string & filename);
 
+    /* Reads the ROM file at `path` as it is on disk, bypassing the cache.
+     * Uses nothing of the project but the platforms and the ROM store's
+     * files, so it may run alongside other calls. Throws an exception if
+     * the file cannot be read. */
+    RomPtr readRom(const std::filesystem::path & path) const;
+
+    /* Reads the tune file at `path` like readRom(). `findBase` returns
+     * the base ROM named by the tune's metadata, or nullptr if there is
+     * none. */
+    TunePtr readTune(const std::filesystem::path & path,
+                     const std::function<RomPtr(const Tune::MetaData &)> & findBase) const;
+
+    /* Returns the ROM whose data has the RomStore::hash() `hash`, or
+     * RomPtr() if there is none in this project. */
+    RomPtr findRom(const std::string & hash);
+
     /* Creates a new blank ROM from `name`. Sets path. */
     RomPtr createRom(const std::string & name,
                      lt::ModelPtr model = lt::ModelPtr());
 
     /* Deletes ROM by filename. Returns true if the ROM was deleted or
-     * false if it could not be found or there is insufficient permission. */
+     * false if it could not be found or there is insufficient permission.
+     * Removes images from the ROM store that no ROM file uses anymore. */
     bool deleteRom(const std::string & filename);
 
     /* Deletes tune by filename. Returns true if the tune was deleted or
@@ -33,8 +52,11 @@ public:
     bool deleteTune(const std::string & filename);
 
     /* Creates a new ROM from a file containing the raw ROM from an ECU.
+     * If `platform` is null, the models of all platforms are tried.
      * Throws an exception if the file cannot be opened or the model
-     * cannot be determined. */
+     * cannot be determined. If the store already holds an identical image,
+     * the ROM uses that. Otherwise it uses the file in place until it is
+     * saved. */
     RomPtr importRom(const std::string & name,
                      const std::filesystem::path & path,
                      lt::PlatformPtr platform);
@@ -44,14 +66,12 @@ public:
      * cannot be found. */
     TunePtr loadTune(const std::string & filename);
 
-    /* Searches all ROM files and extracts their metadata. Silently ignores
-     * invalid ROMs. This is an expensive operation that should not
-     * be called often. */
+    /* Lists the metadata of all ROM files. Silently ignores invalid ROMs.
+     * Only files that changed since the last call are read. */
     std::vector<Rom::MetaData> queryRoms();
 
-    /* Searches all tune files and extracts their metadata. Silently ignores
-     * invalid tunes. This is an expensive operation that should not
-     * be called often. */
+    /* Lists the metadata of all tune files. Silently ignores invalid
+     * tunes. Only files that changed since the last call are read. */
     std::vector<Tune::MetaData> queryTunes();
 
     const std::filesystem::path & tunesDirectory() const noexcept;
@@ -66,6 +86,12 @@ public:
 
     inline void setName(std::string name) noexcept { name_ = std::move(name); }
 
+    /* ROMs saved from now on keep their image in `store`, which may be
+     * shared with other projects. Without a store, images stay in the ROM
+     * files. ROMs already kept in a store need it to load. */
+    void setRomStore(RomStorePtr store);
+    inline const RomStorePtr & romStore() const noexcept { return store_; }
+
     // Saves project configuration. Does NOT save tunes or ROMs.
     void save() const;
 
@@ -80,9 +106,20 @@ public:
 
     std::filesystem::path logsDirectory() const noexcept;
 
+    /* Generates an unused path in logsDirectory() for a datalog named
+     * `name` */
+    std::filesystem::path generateLogPath(std::string name);
+
+    // Holds the progress of interrupted downloads
+    std::filesystem::path downloadsDirectory() const noexcept;
+
     static constexpr auto config_filename = "config.json";
 
 private:
+    /* If `shareMappings` is set, ROMs kept in the store share mappings
+     * through RomStore::get(), which is not thread-safe */
+    RomPtr loadRom(const std::filesystem::path & path, bool shareMappings) const;
+
     // Project directory
     std::filesystem::path path_;
 
@@ -92,6 +129,12 @@ private:
     // Caches loaded ROMs
     std::unordered_map<std::string, WeakRomPtr> cache_;
     std::unordered_map<std::string, WeakTunePtr> tuneCache_;
+    // Metadata of all ROMs and tunes, kept in '`base`/cache'
+    MetadataIndex<Rom::MetaData> romIndex_;
+    MetadataIndex<Tune::MetaData> tuneIndex_;
+    // ROM filenames by hash, updated by queryRoms()
+    std::unordered_map<std::string, std::string> romsByHash_;
+    RomStorePtr store_;
     const Platforms & platforms_;
 
     /* If true, tunes and ROMs must have the proper extension
@@ -0,0 +1,118 @@
+#include "checksumtracker.h"
+
+#include <algorithm>
+#include <array>
+
+namespace lt
+{
+
+namespace
+{
+constexpr std::size_t block_size = PageOverlay::page_size;
+}
+
+ChecksumTracker::ChecksumTracker(const Checksums & checksums, const PageOverlay & overlay)
+    : overlay_(overlay), snapshot_(overlay.snapshot())
+{
+    regions_.reserve(checksums.size());
+    for (std::size_t i = 0; i < checksums.size(); ++i)
+    {
+        Region region;
+        region.checksum = &checksums[i];
+        region.valid = region.checksum->offset() >= 0 && region.checksum->size() >= 0 &&
+                       static_cast<std::size_t>(region.checksum->offset()) + region.checksum->size() <= overlay_.size();
+        if (region.valid && region.checksum->combine() != Checksum::Combine::None)
+            region.blocks.resize((region.checksum->size() + block_size - 1) / block_size);
+        recompute(region);
+        regions_.push_back(std::move(region));
+    }
+}
+
+void ChecksumTracker::update()
+{
+    std::vector<std::size_t> pages = overlay_.changedPages(snapshot_);
+    if (pages.empty())
+        return;
+
+    for (Region & region : regions_)
+    {
+        if (!region.valid)
+            continue;
+
+        std::size_t begin = region.checksum->offset();
+        std::size_t end = begin + region.checksum->size();
+        Checksum::Combine combine = region.checksum->combine();
+        bool touched = false;
+        for (std::size_t page : pages)
+        {
+            std::size_t pageBegin = std::max(page * PageOverlay::page_size, begin);
+            std::size_t pageEnd = std::min((page + 1) * PageOverlay::page_size, end);
+            if (pageBegin >= pageEnd)
+                continue;
+            touched = true;
+            if (combine == Checksum::Combine::None)
+                break;
+
+            // Blocks are aligned to the region, so a page overlaps at most two
+            std::size_t first = (pageBegin - begin) / block_size;
+            std::size_t last = (pageEnd - 1 - begin) / block_size;
+            for (std::size_t block = first; block <= last; ++block)
+            {
+                uint32_t value = computeBlock(region, block);
+                if (combine == Checksum::Combine::Add)
+                    region.value += value - region.blocks[block];
+                else
+                    region.value ^= value ^ region.blocks[block];
+                region.blocks[block] = value;
+            }
+        }
+
+        if (touched && combine == Checksum::Combine::None)
+            recompute(region);
+    }
+
+    snapshot_ = overlay_.snapshot();
+}
+
+bool ChecksumTracker::ok() const noexcept
+{
+    return std::all_of(regions_.begin(), regions_.end(), [](const Region & region) {
+        return region.valid && region.checksum->finish(region.value) == region.checksum->target();
+    });
+}
+
+uint32_t ChecksumTracker::computeBlock(const Region & region, std::size_t block) const
+{
+    std::size_t offset = block * block_size;
+    std::size_t count = std::min(block_size, static_cast<std::size_t>(region.checksum->size()) - offset);
+
+    std::array<uint8_t, block_size> bytes;
+    overlay_.read(region.checksum->offset() + offset, std::span<uint8_t>(bytes.data(), count));
+    return region.checksum->partial(bytes.data(), count);
+}
+
+void ChecksumTracker::recompute(Region & region) const
+{
+    region.value = 0;
+    if (!region.valid)
+        return;
+
+    if (region.checksum->combine() == Checksum::Combine::None)
+    {
+        std::vector<uint8_t> bytes(region.checksum->size());
+        overlay_.read(region.checksum->offset(), bytes);
+        region.value = region.checksum->partial(bytes.data(), bytes.size());
+        return;
+    }
+
+    for (std::size_t block = 0; block < region.blocks.size(); ++block)
+    {
+        region.blocks[block] = computeBlock(region, block);
+        if (region.checksum->combine() == Checksum::Combine::Add)
+            region.value += region.blocks[block];
+        else
+            region.value ^= region.blocks[block];
+    }
+}
+
+} // namespace lt
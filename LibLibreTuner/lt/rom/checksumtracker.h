@@ -0,0 +1,61 @@
+#ifndef LT_CHECKSUMTRACKER_H
+#define LT_CHECKSUMTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../buffer/pageoverlay.h"
+#include "../definition/checksum.h"
+
+namespace lt
+{
+
+/* Keeps the checksums of a PageOverlay's data current. Each region is
+ * computed in blocks of PageOverlay::page_size bytes; update() recomputes
+ * only the blocks overlapping pages written since the last update.
+ * Checksums whose combine() is None, e.g. CRCs, are recomputed whole when
+ * their region changes.
+ * The checksums and overlay must outlive the tracker. */
+class ChecksumTracker
+{
+public:
+    ChecksumTracker(const Checksums & checksums, const PageOverlay & overlay);
+
+    // Brings the values up to date with the overlay
+    void update();
+
+    // Returns true if every checksum equals its target
+    bool ok() const noexcept;
+
+    inline std::size_t size() const noexcept { return regions_.size(); }
+
+    // Last computed value of checksum `index`
+    inline uint32_t value(std::size_t index) const noexcept
+    {
+        return regions_[index].checksum->finish(regions_[index].value);
+    }
+
+private:
+    struct Region
+    {
+        const Checksum * checksum;
+        // partial() of each block. Empty if blocks cannot be combined.
+        std::vector<uint32_t> blocks;
+        // Combined blocks, before Checksum::finish()
+        uint32_t value{0};
+        // False if the region exceeds the data
+        bool valid{true};
+    };
+
+    const PageOverlay & overlay_;
+    PageOverlay::Snapshot snapshot_;
+    std::vector<Region> regions_;
+
+    uint32_t computeBlock(const Region & region, std::size_t block) const;
+    void recompute(Region & region) const;
+};
+
+} // namespace lt
+
+#endif // LT_CHECKSUMTRACKER_H
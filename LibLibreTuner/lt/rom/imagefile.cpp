@@ -0,0 +1,311 @@
+#include "imagefile.h"
+
+#include "support/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace lt
+{
+
+namespace
+{
+constexpr std::array<uint8_t, 4> image_magic{'L', 'T', 'I', 'F'};
+constexpr uint32_t image_version = 1;
+constexpr std::size_t header_size = 64;
+
+inline void put32(uint32_t value, uint8_t * dest) { SConverter<uint32_t, 4>::writeLE(value, dest); }
+
+inline uint32_t get32(const uint8_t * src) { return SConverter<uint32_t, 4>::readLE(src); }
+
+inline void put64(uint64_t value, uint8_t * dest)
+{
+    put32(static_cast<uint32_t>(value), dest);
+    put32(static_cast<uint32_t>(value >> 32), dest + 4);
+}
+
+inline uint64_t get64(const uint8_t * src)
+{
+    return static_cast<uint64_t>(get32(src)) | (static_cast<uint64_t>(get32(src + 4)) << 32);
+}
+
+inline uint64_t alignUp(uint64_t value) { return (value + image_alignment - 1) / image_alignment * image_alignment; }
+
+std::array<uint8_t, header_size> encodeHeader(const ImageFileHeader & header)
+{
+    std::array<uint8_t, header_size> bytes{};
+    std::copy(image_magic.begin(), image_magic.end(), bytes.begin());
+    put32(image_version, &bytes[4]);
+    put32(static_cast<uint32_t>(header.kind), &bytes[8]);
+    put64(header.metadataOffset, &bytes[16]);
+    put64(header.metadataSize, &bytes[24]);
+    put64(header.pageMapOffset, &bytes[32]);
+    put64(header.pageMapSize, &bytes[40]);
+    put64(header.imageOffset, &bytes[48]);
+    put64(header.imageSize, &bytes[56]);
+    return bytes;
+}
+
+/* Checks that every section lies inside a file of `fileSize` bytes,
+ * including the padding after the image that mappings read whole pages
+ * from */
+void validate(const ImageFileHeader & header, uint64_t fileSize)
+{
+    auto inside = [fileSize](uint64_t offset, uint64_t size) {
+        return offset <= fileSize && size <= fileSize - offset;
+    };
+    if (!inside(header.metadataOffset, header.metadataSize) || !inside(header.pageMapOffset, header.pageMapSize) ||
+        !inside(header.imageOffset, header.imageSize) || header.imageOffset % image_alignment != 0 ||
+        !inside(header.imageOffset, alignUp(header.imageSize)))
+    {
+        throw std::runtime_error("image file is truncated or corrupt");
+    }
+}
+
+// An existing file opened for writing in place
+class PatchFile
+{
+public:
+    explicit PatchFile(const fs::path & path) : path_(path)
+    {
+#ifdef _WIN32
+        // Mappings of the file, including our own, do not hold it open
+        handle_ = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle_ == INVALID_HANDLE_VALUE)
+#else
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd_ < 0)
+#endif
+            throw std::runtime_error("failed to open '" + path.string() + "' for writing");
+    }
+
+    ~PatchFile()
+    {
+#ifdef _WIN32
+        CloseHandle(handle_);
+#else
+        ::close(fd_);
+#endif
+    }
+
+    PatchFile(const PatchFile &) = delete;
+    PatchFile & operator=(const PatchFile &) = delete;
+
+    void write(uint64_t offset, std::span<const uint8_t> data)
+    {
+        while (!data.empty())
+        {
+#ifdef _WIN32
+            OVERLAPPED position{};
+            position.Offset = static_cast<DWORD>(offset);
+            position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD count = static_cast<DWORD>(std::min<std::size_t>(data.size(), 1u << 30));
+            DWORD written = 0;
+            if (!WriteFile(handle_, data.data(), count, &written, &position))
+                fail();
+#else
+            ssize_t written = ::pwrite(fd_, data.data(), data.size(), static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                fail();
+#endif
+            offset += static_cast<uint64_t>(written);
+            data = data.subspan(static_cast<std::size_t>(written));
+        }
+    }
+
+    // Waits until everything written is on disk
+    void sync()
+    {
+#ifdef _WIN32
+        if (!FlushFileBuffers(handle_))
+#else
+        if (::fsync(fd_) != 0)
+#endif
+            fail();
+    }
+
+private:
+    fs::path path_;
+#ifdef _WIN32
+    HANDLE handle_;
+#else
+    int fd_;
+#endif
+
+    [[noreturn]] void fail() { throw std::runtime_error("failed to write '" + path_.string() + "'"); }
+};
+
+void writePadding(std::ofstream & file, uint64_t position)
+{
+    static const std::array<char, image_alignment> zeros{};
+    file.write(zeros.data(), static_cast<std::streamsize>(alignUp(position) - position));
+}
+} // namespace
+
+std::optional<ImageFileHeader> parseImageHeader(std::span<const uint8_t> bytes)
+{
+    if (bytes.size() < header_size || !std::equal(image_magic.begin(), image_magic.end(), bytes.begin()))
+        return std::nullopt;
+
+    if (uint32_t version = get32(&bytes[4]); version != image_version)
+        throw std::runtime_error("unsupported image file version " + std::to_string(version));
+
+    ImageFileHeader header;
+    uint32_t kind = get32(&bytes[8]);
+    if (kind != static_cast<uint32_t>(ImageKind::Rom) && kind != static_cast<uint32_t>(ImageKind::Tune))
+        throw std::runtime_error("invalid image file kind " + std::to_string(kind));
+    header.kind = static_cast<ImageKind>(kind);
+    header.metadataOffset = get64(&bytes[16]);
+    header.metadataSize = get64(&bytes[24]);
+    header.pageMapOffset = get64(&bytes[32]);
+    header.pageMapSize = get64(&bytes[40]);
+    header.imageOffset = get64(&bytes[48]);
+    header.imageSize = get64(&bytes[56]);
+    return header;
+}
+
+std::optional<ImageFileHeader> readImageHeader(const fs::path & path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::in);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "'");
+
+    std::array<uint8_t, header_size> bytes;
+    file.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+    auto header = parseImageHeader(std::span<const uint8_t>(bytes.data(), static_cast<std::size_t>(file.gcount())));
+    if (header)
+        validate(*header, fs::file_size(path));
+    return header;
+}
+
+std::string readImageMetadata(const fs::path & path, const ImageFileHeader & header)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::in);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open '" + path.string() + "'");
+
+    std::string metadata(header.metadataSize, '\0');
+    file.seekg(static_cast<std::streamoff>(header.metadataOffset));
+    if (!file.read(metadata.data(), static_cast<std::streamsize>(metadata.size())))
+        throw std::runtime_error("failed to read metadata of '" + path.string() + "'");
+    return metadata;
+}
+
+ImageFileHeader writeImageFile(const fs::path & path, ImageKind kind, std::string_view metadata,
+                               std::span<const uint8_t> pageMap, std::span<const std::span<const uint8_t>> image)
+{
+    ImageFileHeader header;
+    header.kind = kind;
+    header.metadataOffset = header_size;
+    header.metadataSize = metadata.size();
+    header.pageMapOffset = header.metadataOffset + header.metadataSize;
+    header.pageMapSize = pageMap.size();
+    header.imageOffset = alignUp(header.pageMapOffset + header.pageMapSize);
+    for (std::span<const uint8_t> chunk : image)
+        header.imageSize += chunk.size();
+
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open '" + temporary.string() + "' for writing");
+
+        auto bytes = encodeHeader(header);
+        file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        file.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+        file.write(reinterpret_cast<const char *>(pageMap.data()), static_cast<std::streamsize>(pageMap.size()));
+        writePadding(file, header.pageMapOffset + header.pageMapSize);
+        for (std::span<const uint8_t> chunk : image)
+            file.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        writePadding(file, header.imageOffset + header.imageSize);
+
+        file.flush();
+        if (!file)
+        {
+            file.close();
+            std::error_code ec;
+            fs::remove(temporary, ec);
+            throw std::runtime_error("failed to write '" + temporary.string() + "'");
+        }
+    }
+
+    fs::rename(temporary, path);
+    return header;
+}
+
+std::optional<ImageFileHeader> patchImageFile(const fs::path & path, const ImageFileHeader & header,
+                                              std::string_view metadata, std::span<const uint8_t> pageMap,
+                                              std::span<const ImagePatch> patches)
+{
+    ImageFileHeader patched = header;
+    patched.metadataSize = metadata.size();
+    patched.pageMapOffset = patched.metadataOffset + patched.metadataSize;
+    patched.pageMapSize = pageMap.size();
+    if (patched.pageMapOffset + patched.pageMapSize > header.imageOffset)
+        return std::nullopt;
+
+    for (const ImagePatch & patch : patches)
+    {
+        if (patch.offset > header.imageSize || patch.data.size() > header.imageSize - patch.offset)
+            throw std::runtime_error("patch does not fit the image of '" + path.string() + "'");
+    }
+
+    PatchFile file(path);
+    for (const ImagePatch & patch : patches)
+        file.write(header.imageOffset + patch.offset, patch.data);
+    file.write(patched.metadataOffset,
+               std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(metadata.data()), metadata.size()));
+    file.write(patched.pageMapOffset, pageMap);
+    auto bytes = encodeHeader(patched);
+    file.write(0, bytes);
+    file.sync();
+    return patched;
+}
+
+std::span<const uint8_t> MappedImage::metadata() const noexcept
+{
+    return file->bytes().subspan(header.metadataOffset, header.metadataSize);
+}
+
+std::span<const uint8_t> MappedImage::pageMap() const noexcept
+{
+    return file->bytes().subspan(header.pageMapOffset, header.pageMapSize);
+}
+
+std::span<const uint8_t> MappedImage::image() const noexcept
+{
+    return file->bytes().subspan(header.imageOffset, header.imageSize);
+}
+
+MappedImage mapImageFile(const fs::path & path, MappedFile::Mode mode)
+{
+    MappedImage mapped;
+    mapped.file = std::make_shared<MappedFile>(path, mode);
+
+    auto header = parseImageHeader(mapped.file->bytes());
+    if (!header)
+        throw std::runtime_error("'" + path.string() + "' is not an image file");
+    validate(*header, mapped.file->size());
+    mapped.header = *header;
+    return mapped;
+}
+
+} // namespace lt
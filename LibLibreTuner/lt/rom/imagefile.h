@@ -0,0 +1,97 @@
+#ifndef LT_IMAGEFILE_H
+#define LT_IMAGEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../support/mappedfile.h"
+
+namespace lt
+{
+
+// What an image file holds
+enum class ImageKind : uint32_t
+{
+    Rom = 1,
+    Tune = 2,
+};
+
+/* Layout of a ROM or tune file. All integers are little endian:
+ *   "LTIF" version:u32 kind:u32 reserved:u32
+ *   metadataOffset:u64 metadataSize:u64
+ *   pageMapOffset:u64 pageMapSize:u64
+ *   imageOffset:u64 imageSize:u64
+ *
+ * The metadata is opaque to the container. The page map is a bit per
+ * PageOverlay page, set for pages that differ from the base ROM (tunes
+ * only). The raw image starts on an image_alignment boundary and the file
+ * is padded to the next boundary after it, so the image can be mapped and
+ * whole pages of it read past its end. */
+struct ImageFileHeader
+{
+    ImageKind kind{ImageKind::Rom};
+    uint64_t metadataOffset{0}, metadataSize{0};
+    uint64_t pageMapOffset{0}, pageMapSize{0};
+    uint64_t imageOffset{0}, imageSize{0};
+};
+
+constexpr std::size_t image_alignment = 4096;
+
+/* Parses the header at the start of `bytes`. Returns std::nullopt if it is
+ * not an image file, e.g. a file from an older version. Throws an
+ * exception if the header is corrupt. */
+std::optional<ImageFileHeader> parseImageHeader(std::span<const uint8_t> bytes);
+
+// Same as parseImageHeader for the file at `path`. Reads only the header.
+std::optional<ImageFileHeader> readImageHeader(const std::filesystem::path & path);
+
+// Reads the metadata section of an image file
+std::string readImageMetadata(const std::filesystem::path & path, const ImageFileHeader & header);
+
+/* Writes a complete image file. The image is the concatenation of
+ * `image`. The file is written next to `path` and renamed over it, so
+ * mappings of the previous file keep their contents. Windows refuses the
+ * rename while the previous file is mapped. Returns the header that was
+ * written. */
+ImageFileHeader writeImageFile(const std::filesystem::path & path, ImageKind kind, std::string_view metadata,
+                               std::span<const uint8_t> pageMap, std::span<const std::span<const uint8_t>> image);
+
+// Bytes to write at `offset` from the start of the image section
+struct ImagePatch
+{
+    uint64_t offset;
+    std::span<const uint8_t> data;
+};
+
+/* Rewrites an image file with header `header` in place: replaces its
+ * metadata and page map and writes `patches` into its image. The file is
+ * synced before returning. Returns the new header, or std::nullopt without
+ * writing anything if the metadata and page map no longer fit before the
+ * image. */
+std::optional<ImageFileHeader> patchImageFile(const std::filesystem::path & path, const ImageFileHeader & header,
+                                              std::string_view metadata, std::span<const uint8_t> pageMap,
+                                              std::span<const ImagePatch> patches = {});
+
+// An image file mapped into memory
+struct MappedImage
+{
+    MappedFilePtr file;
+    ImageFileHeader header;
+
+    std::span<const uint8_t> metadata() const noexcept;
+    std::span<const uint8_t> pageMap() const noexcept;
+    std::span<const uint8_t> image() const noexcept;
+};
+
+// Maps an image file. Throws an exception if it is not one.
+MappedImage mapImageFile(const std::filesystem::path & path, MappedFile::Mode mode);
+
+} // namespace lt
+
+#endif // LT_IMAGEFILE_H
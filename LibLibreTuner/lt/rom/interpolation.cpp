@@ -0,0 +1,166 @@
+#include "interpolation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace lt
+{
+
+namespace
+{
+// Samples bracketed per block in the batched functions
+constexpr std::size_t block_size = 256;
+
+// Breakpoints of `axis` for `count` cells. Cells past the end of the axis
+// (or all cells, without an axis) use their index.
+std::vector<double> materialize(const Table::AxisTypePtr & axis, int count)
+{
+    std::vector<double> breakpoints(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i)
+        breakpoints[i] = (axis && i < axis->size()) ? axis->index(i) : static_cast<double>(i);
+    return breakpoints;
+}
+} // namespace
+
+AxisBreakpoints::AxisBreakpoints(std::vector<double> breakpoints) : breakpoints_(std::move(breakpoints))
+{
+    if (breakpoints_.size() < 2)
+        return;
+
+    start_ = breakpoints_.front();
+    step_ = breakpoints_[1] - breakpoints_[0];
+    if (step_ <= 0.0)
+        return;
+
+    // Linear axes and most memory axes with a fixed increment
+    const double tolerance = std::abs(step_) * 1e-9;
+    uniform_ = true;
+    for (std::size_t i = 1; i < breakpoints_.size(); ++i)
+    {
+        if (std::abs(breakpoints_[i] - (start_ + step_ * static_cast<double>(i))) > tolerance)
+        {
+            uniform_ = false;
+            break;
+        }
+    }
+}
+
+AxisBracket AxisBreakpoints::bracket(double value) const noexcept
+{
+    const int last = size() - 1;
+    if (last <= 0 || std::isnan(value))
+        return AxisBracket{0, 0.0};
+
+    int index;
+    if (uniform_)
+    {
+        double position = (value - start_) / step_;
+        index = static_cast<int>(std::clamp(std::floor(position), 0.0, static_cast<double>(last - 1)));
+    }
+    else
+    {
+        // Largest breakpoint <= value. The loop has a fixed trip count for
+        // a given axis and no data-dependent branches.
+        const double * first = breakpoints_.data();
+        std::size_t length = breakpoints_.size();
+        while (length > 1)
+        {
+            std::size_t half = length / 2;
+            first = (first[half] <= value) ? first + half : first;
+            length -= half;
+        }
+        index = std::min(static_cast<int>(first - breakpoints_.data()), last - 1);
+    }
+
+    const double lower = breakpoints_[index];
+    const double span = breakpoints_[index + 1] - lower;
+    double fraction = span > 0.0 ? (value - lower) / span : 0.0;
+    return AxisBracket{index, std::clamp(fraction, 0.0, 1.0)};
+}
+
+TableInterpolator::TableInterpolator(const Table & table)
+    : xAxis_(materialize(table.xAxis(), table.width())), yAxis_(materialize(table.yAxis(), table.height())),
+      values_(table.values().begin(), table.values().end()), width_(table.width()), height_(table.height())
+{
+}
+
+double TableInterpolator::blend(const AxisBracket & x, const AxisBracket & y) const noexcept
+{
+    const int x1 = std::min(x.index + 1, width_ - 1);
+    const int y1 = std::min(y.index + 1, height_ - 1);
+
+    const double * row0 = values_.data() + static_cast<std::size_t>(y.index) * width_;
+    const double * row1 = values_.data() + static_cast<std::size_t>(y1) * width_;
+
+    const double top = row0[x.index] + (row0[x1] - row0[x.index]) * x.fraction;
+    const double bottom = row1[x.index] + (row1[x1] - row1[x.index]) * x.fraction;
+    return top + (bottom - top) * y.fraction;
+}
+
+double TableInterpolator::evaluate(double x, double y) const noexcept
+{
+    if (values_.empty())
+        return 0.0;
+    return blend(xAxis_.bracket(x), yAxis_.bracket(y));
+}
+
+void TableInterpolator::checkSizes(std::size_t xs, std::size_t ys, std::size_t out) const
+{
+    if (xs != out || (ys != 0 && ys != xs))
+        throw std::runtime_error("sample count mismatch (" + std::to_string(xs) + " x, " + std::to_string(ys) +
+                                 " y, " + std::to_string(out) + " out)");
+}
+
+void TableInterpolator::evaluate(std::span<const double> xs, std::span<const double> ys, std::span<double> out) const
+{
+    checkSizes(xs.size(), ys.size(), out.size());
+    if (values_.empty())
+    {
+        std::fill(out.begin(), out.end(), 0.0);
+        return;
+    }
+
+    std::array<AxisBracket, block_size> xb, yb;
+    yb.fill(AxisBracket{0, 0.0});
+
+    for (std::size_t start = 0; start < xs.size(); start += block_size)
+    {
+        const std::size_t count = std::min(block_size, xs.size() - start);
+
+        // Bracket first, then blend, so the blend loop has no searches in it
+        for (std::size_t i = 0; i < count; ++i)
+            xb[i] = xAxis_.bracket(xs[start + i]);
+        if (!ys.empty())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                yb[i] = yAxis_.bracket(ys[start + i]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            out[start + i] = blend(xb[i], yb[i]);
+    }
+}
+
+std::pair<int, int> TableInterpolator::cell(double x, double y) const noexcept
+{
+    AxisBracket xb = xAxis_.bracket(x);
+    AxisBracket yb = yAxis_.bracket(y);
+    int column = std::min(xb.index + (xb.fraction >= 0.5 ? 1 : 0), std::max(width_ - 1, 0));
+    int row = std::min(yb.index + (yb.fraction >= 0.5 ? 1 : 0), std::max(height_ - 1, 0));
+    return {row, column};
+}
+
+void TableInterpolator::cells(std::span<const double> xs, std::span<const double> ys, std::span<int> out) const
+{
+    checkSizes(xs.size(), ys.size(), out.size());
+    for (std::size_t i = 0; i < xs.size(); ++i)
+    {
+        auto [row, column] = cell(xs[i], ys.empty() ? 0.0 : ys[i]);
+        out[i] = row * width_ + column;
+    }
+}
+
+} // namespace lt
@@ -0,0 +1,90 @@
+#ifndef LT_INTERPOLATION_H
+#define LT_INTERPOLATION_H
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "table.h"
+
+namespace lt
+{
+
+// Position of a coordinate between two axis breakpoints
+struct AxisBracket
+{
+    // Lower breakpoint
+    int index;
+    // Distance toward index + 1, from 0 to 1
+    double fraction;
+};
+
+/* Breakpoints of one table dimension. Bracketing uses a branchless binary
+ * search, or plain arithmetic if the breakpoints are evenly spaced.
+ * Breakpoints must be ascending. */
+class AxisBreakpoints
+{
+public:
+    AxisBreakpoints() = default;
+    explicit AxisBreakpoints(std::vector<double> breakpoints);
+
+    /* Brackets `value`. Values outside of the axis are clamped to the first
+     * or last breakpoint. */
+    AxisBracket bracket(double value) const noexcept;
+
+    inline int size() const noexcept { return static_cast<int>(breakpoints_.size()); }
+
+    inline const std::vector<double> & breakpoints() const noexcept { return breakpoints_; }
+
+private:
+    std::vector<double> breakpoints_;
+    bool uniform_{false};
+    double start_{0.0}, step_{0.0};
+};
+
+/* Evaluates a table at arbitrary axis coordinates the way an ECU does: each
+ * coordinate is bracketed between two breakpoints and the four surrounding
+ * cells are blended bilinearly. x follows the columns and y the rows. A
+ * missing axis uses the cell indices as breakpoints.
+ *
+ * The breakpoints and values are copied on construction; rebuild the
+ * interpolator after editing the table. */
+class TableInterpolator
+{
+public:
+    explicit TableInterpolator(const Table & table);
+
+    double evaluate(double x, double y = 0.0) const noexcept;
+
+    /* Evaluates every sample (xs[i], ys[i]) into out[i]. `ys` may be empty
+     * for one-dimensional tables. Samples are processed in blocks so the
+     * blend runs as a vectorizable loop. Throws an exception if the spans
+     * do not have matching sizes. */
+    void evaluate(std::span<const double> xs, std::span<const double> ys, std::span<double> out) const;
+
+    /* Returns the (row, column) of the cell nearest to (x, y), which is the
+     * cell an ECU would report as active */
+    std::pair<int, int> cell(double x, double y = 0.0) const noexcept;
+
+    // Batched cell(). Writes row * width + column for each sample.
+    void cells(std::span<const double> xs, std::span<const double> ys, std::span<int> out) const;
+
+    inline const AxisBreakpoints & xAxis() const noexcept { return xAxis_; }
+    inline const AxisBreakpoints & yAxis() const noexcept { return yAxis_; }
+    inline int width() const noexcept { return width_; }
+    inline int height() const noexcept { return height_; }
+
+private:
+    AxisBreakpoints xAxis_, yAxis_;
+    std::vector<double> values_;
+    int width_, height_;
+
+    inline double blend(const AxisBracket & x, const AxisBracket & y) const noexcept;
+
+    void checkSizes(std::size_t xs, std::size_t ys, std::size_t out) const;
+};
+
+} // namespace lt
+
+#endif // LT_INTERPOLATION_H
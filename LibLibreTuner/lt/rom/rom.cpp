@@ -20,6 +20,7 @@
 #include "table.h"
 
 #include "definition/platform.h"
+#include "libretuner.h"
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/string.hpp>
@@ -27,6 +28,7 @@
 
 #include <cassert>
 #include <fstream>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
@@ -48,18 +50,11 @@ EntriesPtr<double> createEntries(Endianness endianness, DataType dataType, const
 }
 } // namespace detail
 
-bool Tune::dirty() const noexcept
-{
-    for (const auto & [id, table] : tables_)
-    {
-        if (table->dirty())
-            return true;
-    }
-    return false;
-}
+bool Tune::dirty() const noexcept { return data_.revision() != savedRevision_; }
 
 void Tune::clearDirty() noexcept
 {
+    savedRevision_ = data_.revision();
     for (const auto & [id, table] : tables_)
     {
         if (table->dirty())
@@ -67,6 +62,22 @@ void Tune::clearDirty() noexcept
     }
 }
 
+bool Tune::checksumsOk()
+{
+    if (!checksums_)
+        checksums_ = std::make_unique<ChecksumTracker>(base_->model()->checksums, data_);
+    else
+        checksums_->update();
+    return checksums_->ok();
+}
+
+std::vector<uint8_t> Tune::image() const
+{
+    std::vector<uint8_t> image(data_.size());
+    data_.copyTo(image);
+    return image;
+}
+
 Table * Tune::getTable(const std::string & id, bool create)
 {
     if (auto it = tables_.find(id); it != tables_.end())
@@ -75,11 +86,13 @@ Table * Tune::getTable(const std::string & id, bool create)
     // Else, try to create a new table from base calibration
     if (create)
     {
-        const TableDefinition * def = base_->model()->getTable(id);
-        if (def == nullptr)
+        const ModelTable * table = base_->model()->getTable(id);
+        if (table == nullptr)
             return nullptr;
+        const TableDefinition * def = table->definition;
+        const int offset = table->offset;
 
-        if (size() < def->offset.value() + def->byteSize())
+        if (size() < offset + def->byteSize())
             throw std::runtime_error("table '" + id +
                                      "' could not be created because it "
                                      "exceeds the size of the ROM");
@@ -97,8 +110,10 @@ Table * Tune::getTable(const std::string & id, bool create)
         if (!def->axisY.empty())
             builder.setYAxis(getAxis(def->axisY, true));
 
-        builder.setEntries(detail::createEntries(endianness(), def->dataType, data_.view(def->offset.value(), def->byteSize())));
-        builder.setBaseEntries(detail::createEntries(endianness(), def->dataType, base_->view(def->offset.value(), def->byteSize())));
+        builder.setEntries(detail::createEntries(endianness(), def->dataType, data_.view(offset, def->byteSize())));
+        // The overlay's base outlives the ROM rebinding its data
+        builder.setBaseEntries(detail::createEntries(endianness(), def->dataType,
+                                                     View(data_.base(), offset, def->byteSize())));
 
         // Emplace table and use returned iterator to get the inserted table
         return tables_.emplace(id, std::make_unique<Table>(builder.build())).first->second.get();
@@ -170,32 +185,134 @@ Tune::MetaData Tune::metadata() const noexcept
     md.name = name_;
     md.path = path_;
     if (base_)
+    {
         md.base = base_->path().filename().string();
+        md.baseHash = base_->hash();
+    }
     return md;
 }
 
-void Tune::save() const
+std::string Tune::encodeMetadata() const
+{
+    std::ostringstream stream(std::ios::binary | std::ios::out);
+    {
+        cereal::BinaryOutputArchive archive(stream);
+        archive(metadata());
+    }
+    return stream.str();
+}
+
+void Tune::save()
 {
     if (path_.empty())
         throw std::runtime_error("attempt to save ROM without a path");
 
-    std::ofstream file(path_, std::ios::binary | std::ios::out);
-    if (!file.is_open())
-        throw std::runtime_error("failed to open tune file '" + path_.string() + "' for writing");
+    std::string encoded = encodeMetadata();
+    if (file_ && filePath_ == path_ && patchFile(encoded))
+        return;
+    writeFile(std::move(encoded));
+}
+
+void Tune::writeFile(std::string encoded)
+{
+    std::vector<uint8_t> pageMap = data_.pageMap();
+
+    std::vector<std::span<const uint8_t>> chunks;
+    chunks.reserve(data_.pageCount());
+    for (std::size_t index = 0; index < data_.pageCount(); ++index)
+        chunks.push_back(data_.page(index));
+
+    /* Windows cannot replace a file that is still mapped. Pages attached
+     * from it are copied and every reference to the mapping dropped before
+     * the new file is renamed over it. */
+    data_.detachImages();
+    file_.reset();
+    filePages_ = Snapshot();
+    checksums_.reset();
+
+    writeImageFile(path_, ImageKind::Tune, encoded, pageMap, chunks);
+
+    // Map the new file for the next save
+    file_ = mapImageFile(path_, MappedFile::Mode::Private);
+    filePath_ = path_;
+    fileMetadata_ = std::move(encoded);
+    filePages_ = data_.snapshot();
+}
+
+bool Tune::patchFile(const std::string & encoded)
+{
+    assert(file_);
+    std::vector<std::size_t> changed = data_.changedPages(filePages_);
+    if (changed.empty() && encoded == fileMetadata_)
+        return true;
+
+    const ImageFileHeader & header = file_->header;
+    MappedFile & mapped = *file_->file;
+    std::vector<ImagePatch> patches;
+    patches.reserve(changed.size());
+    for (std::size_t index : changed)
+    {
+        // Pages attached from the mapping must keep their old contents
+        uint64_t offset = index * PageOverlay::page_size;
+        mapped.detach(header.imageOffset + offset, PageOverlay::page_size);
+        patches.push_back(ImagePatch{offset, data_.page(index)});
+    }
+
+    std::vector<uint8_t> pageMap = data_.pageMap();
+    std::optional<ImageFileHeader> patched = patchImageFile(path_, header, encoded, pageMap, patches);
+    if (!patched)
+        return false;
+
+    file_->header = *patched;
+    fileMetadata_ = encoded;
+    filePages_ = data_.snapshot();
+    return true;
+}
 
-    cereal::BinaryOutputArchive archive(file);
-    archive(metadata(), data_);
+namespace
+{
+// A new tune's data is the ROM's data. The overlay keeps the data alive,
+// even if the ROM is given new data later.
+PageOverlay overlayRom(const RomPtr & rom)
+{
+    assert(rom);
+    return PageOverlay(rom->bytes(), rom->storage());
 }
+} // namespace
 
-Tune::Tune(RomPtr rom) : Tune(rom, MemoryBuffer(rom->cbegin(), rom->cend())) {}
+Tune::Tune(RomPtr rom) : base_(std::move(rom)), data_(overlayRom(base_)) {}
 
-Tune::Tune(RomPtr rom, MemoryBuffer && data) : base_(std::move(rom)), data_(std::move(data))
+Tune::Tune(RomPtr rom, MemoryBuffer && data) : Tune(std::move(rom))
 {
-    assert(base_);
+    if (base_->size() != data.size())
+        throw std::runtime_error("The base ROM and tune data size do not match (" + std::to_string(base_->size()) +
+                                 " vs " + std::to_string(data.size()) + "). The tune or base ROM is corrupt.");
 
-    if (base_->size() != size())
+    // Keep only the pages that differ from the base
+    data_.assign(std::span<const uint8_t>(data.data(), static_cast<std::size_t>(data.size())));
+}
+
+Tune::Tune(RomPtr rom, MappedImage && image, std::filesystem::path path) : Tune(std::move(rom))
+{
+    if (image.header.kind != ImageKind::Tune)
+        throw std::runtime_error("'" + path.string() + "' is not a tune file");
+    if (image.header.imageSize != data_.size())
         throw std::runtime_error("The base ROM and tune data size do not match (" + std::to_string(base_->size()) +
-                                 " vs " + std::to_string(size()) + "). The tune or base ROM is corrupt.");
+                                 " vs " + std::to_string(image.header.imageSize) +
+                                 "). The tune or base ROM is corrupt.");
+
+    // The file is padded, so the last page can be attached whole
+    static_assert(image_alignment % PageOverlay::page_size == 0);
+    std::span<const uint8_t> pages =
+        image.file->bytes().subspan(image.header.imageOffset, data_.pageCount() * PageOverlay::page_size);
+    data_.attach(pages, image.pageMap(), image.file);
+
+    std::span<const uint8_t> metadata = image.metadata();
+    fileMetadata_.assign(metadata.begin(), metadata.end());
+    filePath_ = std::move(path);
+    filePages_ = data_.snapshot();
+    file_ = std::move(image);
+    savedRevision_ = data_.revision();
 }
 
 Rom::MetaData Rom::metadata() const noexcept
@@ -209,24 +326,92 @@ Rom::MetaData Rom::metadata() const noexcept
         if (auto platform = model_->platform())
             md.platform = platform->id;
     }
+    md.hash = hash();
     return md;
 }
 
-void Rom::save() const
+void Rom::setData(MemoryBuffer && data)
+{
+    auto buffer = std::make_shared<MemoryBuffer>(std::move(data));
+    data_ = std::span<const uint8_t>(buffer->data(), static_cast<std::size_t>(buffer->size()));
+    storage_ = std::move(buffer);
+    hash_.clear();
+    fileHeader_.reset();
+}
+
+void Rom::setData(std::span<const uint8_t> data, std::shared_ptr<const void> storage, std::string hash)
+{
+    data_ = data;
+    storage_ = std::move(storage);
+    hash_ = std::move(hash);
+    fileHeader_.reset();
+}
+
+void Rom::setFile(MappedImage && file, std::string hash)
+{
+    setData(file.image(), file.file, std::move(hash));
+    fileHeader_ = file.header;
+    filePath_ = path_;
+}
+
+const std::string & Rom::hash() const
+{
+    if (hash_.empty())
+        hash_ = RomStore::hash(data_);
+    return hash_;
+}
+
+void Rom::save()
 {
     if (path_.empty())
         throw std::runtime_error("attempt to save ROM without a path");
 
-    std::ofstream file(path_, std::ios::binary | std::ios::out);
-    if (!file.is_open())
-        throw std::runtime_error("failed to open ROM file '" + path_.string() + "' for writing");
+    std::ostringstream metadataStream(std::ios::binary | std::ios::out);
+    {
+        cereal::BinaryOutputArchive archive(metadataStream);
+        archive(metadata());
+    }
+
+    std::string metadata = metadataStream.str();
+    if (fileHeader_ && filePath_ == path_)
+    {
+        // The image is already in the file. Rewriting only the metadata
+        // also leaves the mapping, which tunes may share, untouched.
+        if (auto header = patchImageFile(path_, *fileHeader_, metadata, {}))
+        {
+            fileHeader_ = *header;
+            return;
+        }
+    }
 
-    cereal::BinaryOutputArchive archive(file);
-    archive(metadata(), data_);
+    if (store_)
+    {
+        // Identical images are written once; later ROMs share the blob
+        std::string key = hash();
+        try
+        {
+            store_->put(key, data_);
+            store_->addReference(key, path_);
+            MappedFilePtr file = store_->get(key);
+            setData(file->bytes(), file, std::move(key));
+            writeImageFile(path_, ImageKind::Rom, metadata, {}, {});
+            return;
+        }
+        catch (const std::runtime_error & error)
+        {
+            // The ROM file can hold the image just as well
+            log(LogLevel::Warning, "failed to keep '" + path_.string() +
+                                       "' in the ROM store, saving its image in the file: " + error.what());
+        }
+    }
+
+    std::span<const uint8_t> chunks[] = {data_};
+    writeImageFile(path_, ImageKind::Rom, metadata, {}, chunks);
+
+    // Use the file from now on instead of keeping a copy in memory. Tunes
+    // keep the previous data alive.
+    std::string key = hash();
+    setFile(mapImageFile(path_, MappedFile::Mode::ReadOnly), std::move(key));
 }
 
 } // namespace lt
-
-// Declare cereal versions out of scope
-CEREAL_CLASS_VERSION(lt::Rom::MetaData, 1)
-CEREAL_CLASS_VERSION(lt::Tune::MetaData, 1)
\ No newline at end of file
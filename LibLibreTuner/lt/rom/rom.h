@@ -21,13 +21,21 @@
 
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <cereal/cereal.hpp>
+
 #include "../definition/model.h"
 #include "../definition/platform.h"
 #include "../buffer/memorybuffer.h"
+#include "../buffer/pageoverlay.h"
+#include "checksumtracker.h"
+#include "imagefile.h"
+#include "romstore.h"
 #include "table.h"
 
 namespace lt
@@ -58,44 +66,64 @@ public:
 
     inline const uint8_t * data() const noexcept { return data_.data(); }
     inline int size() const noexcept { return static_cast<int>(data_.size()); }
+    inline std::span<const uint8_t> bytes() const noexcept { return data_; }
 
-    std::vector<uint8_t>::iterator begin() noexcept { return data_.begin(); }
-    std::vector<uint8_t>::iterator end() noexcept { return data_.end(); }
-    std::vector<uint8_t>::const_iterator cbegin() const noexcept
-    {
-        return data_.cbegin();
-    }
-    std::vector<uint8_t>::const_iterator cend() const noexcept
-    {
-        return data_.cend();
-    }
+    /* Keeps the ROM data alive. Tunes hold on to it, so the ROM may be
+     * given new data (e.g. mapped from a new file) while tunes exist. */
+    inline const std::shared_ptr<const void> & storage() const noexcept { return storage_; }
 
     // Sets the ROM data
-    void setData(MemoryBuffer && data) { data_ = std::move(data); }
-    View view(int offset, int size) { return data_.view(offset, size); }
-    View view() { return data_.view(); }
+    void setData(MemoryBuffer && data);
+
+    /* Uses `data` as the ROM data without copying it. `storage` keeps it
+     * alive and unchanged, e.g. a read-only file mapping. If known,
+     * `hash` is the RomStore::hash() of the data. */
+    void setData(std::span<const uint8_t> data, std::shared_ptr<const void> storage, std::string hash = std::string());
+
+    /* Uses the image of `file`, the ROM file at path(), as the data.
+     * save() then only rewrites the metadata of the file. */
+    void setFile(MappedImage && file, std::string hash = std::string());
+
+    // Returns the RomStore::hash() of the data. Computed once.
+    const std::string & hash() const;
+
+    /* If set, save() keeps the data in `store` and writes only metadata
+     * to the ROM file. If the store cannot be written, the image goes in
+     * the file. */
+    void setStore(RomStorePtr store) { store_ = std::move(store); }
+    inline const RomStorePtr & store() const noexcept { return store_; }
+
+    // Read-only views of the data
+    View view(int offset, int size) const { return View(data_, offset, size); }
+    View view() const { return View(data_, 0, size()); }
 
     struct MetaData
     {
         std::string name;
         std::string platform;
         std::string model;
+        // RomStore::hash() of the data. Empty in files from version 1.
+        std::string hash;
 
         // Path is set after loading
         std::filesystem::path path;
 
         template <class Archive>
-        void serialize(Archive & archive, std::uint32_t const /*version*/)
+        void serialize(Archive & archive, std::uint32_t const version)
         {
             archive(name, platform, model);
+            if (version >= 2)
+                archive(hash);
         }
     };
 
     // Constructs ROM metadata
     MetaData metadata() const noexcept;
 
-    // Saves rom to `path_`
-    void save() const;
+    /* Saves the ROM to `path_` as an image file and maps the data from
+     * it afterwards. With a store, the data goes to the store and is
+     * mapped from there. */
+    void save();
 
 private:
     std::string name_;
@@ -103,36 +131,76 @@ private:
 
     std::filesystem::path path_;
 
-    MemoryBuffer data_;
+    std::shared_ptr<const void> storage_;
+    std::span<const uint8_t> data_;
+    mutable std::string hash_;
+    RomStorePtr store_;
+
+    // Set while the data is the image of the file at filePath_
+    std::optional<ImageFileHeader> fileHeader_;
+    std::filesystem::path filePath_;
 };
 using RomPtr = std::shared_ptr<Rom>;
 using WeakRomPtr = std::weak_ptr<Rom>;
 
 using TableMap = std::unordered_map<std::string, std::unique_ptr<Table>>;
 
+/* A set of changes to a base ROM. The tune's data is a copy-on-write
+ * overlay of the ROM's data, so a tune costs memory for the pages it
+ * changed. Table edits are journaled and can be undone. */
 class Tune
 {
 public:
-    using iterator = MemoryBuffer::iterator;
-    using const_iterator = MemoryBuffer::const_iterator;
+    using Snapshot = PageOverlay::Snapshot;
 
     static constexpr auto extension = ".ltt";
 
     explicit Tune(RomPtr rom);
     explicit Tune(RomPtr rom, MemoryBuffer && data);
 
+    /* Opens a tune from an image file mapped from `path` with
+     * MappedFile::Mode::Private. The changed pages are used in place, so
+     * this costs nothing per byte of the image. */
+    Tune(RomPtr rom, MappedImage && image, std::filesystem::path path);
+
     inline const std::string & name() const noexcept { return name_; }
     inline const RomPtr & base() const noexcept { return base_; }
     inline const std::filesystem::path & path() const noexcept { return path_; }
 
-    // Returns true if any table is dirty
+    // Returns true if the data changed since the last clearDirty()
     bool dirty() const noexcept;
 
     // Clears dirty bit of all tables
     void clearDirty() noexcept;
 
+    /* Reverts the last edit. Returns false if there is nothing to undo.
+     * Tables re-read their values; open views should refresh. */
+    inline bool undo() { return data_.undo(); }
+
+    // Reapplies the last undone edit. Returns false if there is none.
+    inline bool redo() { return data_.redo(); }
+
+    inline bool canUndo() const noexcept { return data_.canUndo(); }
+    inline bool canRedo() const noexcept { return data_.canRedo(); }
+
+    // Calls `func` when canUndo() or canRedo() may have changed
+    template <typename Func> Event<>::ConnectionPtr onHistoryChange(Func && func) noexcept
+    {
+        return data_.onHistoryChange(std::forward<Func>(func));
+    }
+
+    // Edits between these are undone as one step, e.g. when applying a
+    // correction to many cells. Calls may nest.
+    inline void beginEdit() noexcept { data_.beginGroup(); }
+    inline void endEdit() noexcept { data_.endGroup(); }
+
+    // Saves the current data. Cheap; pages are shared until written.
+    inline Snapshot snapshot() const { return data_.snapshot(); }
+
+    // Returns to a snapshot of this tune as one undoable edit
+    inline void restore(const Snapshot & snapshot) { data_.restore(snapshot); }
+
     void setName(const std::string & name) { name_ = name; }
-    void setBase(const RomPtr & rom) { base_ = rom; }
     void setPath(std::filesystem::path path) { path_ = std::move(path); }
 
     // Gets table by id. Returns nullptr if the table does not exist
@@ -155,26 +223,44 @@ public:
         std::string name;
         // Base ROM id
         std::string base;
+        // RomStore::hash() of the base ROM. Empty in files from version 1.
+        std::string baseHash;
         std::filesystem::path path;
 
         template <class Archive>
-        void serialize(Archive & archive, std::uint32_t const /*version*/)
+        void serialize(Archive & archive, std::uint32_t const version)
         {
             archive(name, base);
+            if (version >= 2)
+                archive(baseHash);
         }
     };
 
     /* Constructs tune metadata */
     MetaData metadata() const noexcept;
 
-    // Saves tune to `path_`
-    void save() const;
+    /* Saves the tune to `path_`. If the tune was opened from or last saved
+     * to the same image file, writes just the pages that changed since and
+     * the metadata in place, as long as the metadata still fits. Otherwise
+     * writes a new image file. */
+    void save();
+
+    inline std::size_t size() const noexcept { return data_.size(); }
+
+    // Copies dest.size() bytes of tune data starting at `offset`
+    inline void read(std::size_t offset, std::span<uint8_t> dest) const { data_.read(offset, dest); }
 
-    inline iterator begin() { return data_.begin(); }
-    inline const_iterator cbegin() const { return data_.cbegin(); };
-    inline iterator end() { return data_.end(); }
-    inline const_iterator cend() { return data_.cend(); }
-    inline std::vector<uint8_t>::size_type size() const { return data_.size(); }
+    // Returns a full copy of the tune data
+    std::vector<uint8_t> image() const;
+
+    // Raw tune data, e.g. for visitTable()
+    View view(int offset, int size) { return data_.view(offset, size); }
+
+    inline const PageOverlay & data() const noexcept { return data_; }
+
+    /* Returns true if every checksum of the model matches the current
+     * data. Only the pages written since the last call are re-read. */
+    bool checksumsOk();
 
 private:
     std::string name_;
@@ -182,7 +268,24 @@ private:
     RomPtr base_;
     TableMap tables_;
 
-    MemoryBuffer data_;
+    PageOverlay data_;
+    // Revision of data_ at the last clearDirty()
+    std::size_t savedRevision_{0};
+
+    // Image file the tune was opened from or last saved to
+    std::optional<MappedImage> file_;
+    std::filesystem::path filePath_;
+    // Metadata and pages as written to file_
+    std::string fileMetadata_;
+    Snapshot filePages_;
+
+    // Created by the first checksumsOk()
+    std::unique_ptr<ChecksumTracker> checksums_;
+
+    std::string encodeMetadata() const;
+    void writeFile(std::string encoded);
+    // Returns false if the file must be written anew
+    bool patchFile(const std::string & encoded);
 
     std::unordered_map<std::string, AxisPtr> axes_;
 
@@ -192,4 +295,9 @@ using TunePtr = std::shared_ptr<Tune>;
 using WeakTunePtr = std::weak_ptr<Tune>;
 } // namespace lt
 
+// Versions of the serialized metadata, declared with the types so every
+// file that reads or writes metadata uses the same one
+CEREAL_CLASS_VERSION(lt::Rom::MetaData, 2)
+CEREAL_CLASS_VERSION(lt::Tune::MetaData, 2)
+
 #endif // ROM_H
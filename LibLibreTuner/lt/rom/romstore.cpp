@@ -0,0 +1,141 @@
+#include "romstore.h"
+
+#include "support/sha256.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace lt
+{
+
+RomStore::RomStore(fs::path directory) : directory_(std::move(directory)) {}
+
+std::string RomStore::hash(std::span<const uint8_t> data) { return toHex(sha256(data.data(), data.size())); }
+
+bool RomStore::contains(const std::string & hash) const { return fs::is_regular_file(path(hash)); }
+
+std::string RomStore::put(std::span<const uint8_t> data)
+{
+    std::string key = hash(data);
+    put(key, data);
+    return key;
+}
+
+void RomStore::put(const std::string & key, std::span<const uint8_t> data)
+{
+    if (contains(key))
+        return;
+
+    fs::create_directories(directory_);
+    fs::path target = path(key);
+    fs::path temporary = target;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open '" + temporary.string() + "' for writing");
+        file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.flush();
+        if (!file)
+        {
+            file.close();
+            std::error_code ec;
+            fs::remove(temporary, ec);
+            throw std::runtime_error("failed to write '" + temporary.string() + "'");
+        }
+    }
+    // Another process may have stored the same image meanwhile. Both wrote
+    // the same bytes, so either file will do.
+    fs::rename(temporary, target);
+}
+
+MappedFilePtr RomStore::get(const std::string & hash)
+{
+    if (auto it = mappings_.find(hash); it != mappings_.end())
+    {
+        if (auto file = it->second.lock())
+            return file;
+    }
+
+    if (!contains(hash))
+        throw std::runtime_error("ROM image " + hash + " is not in the ROM store at '" + directory_.string() + "'");
+
+    auto file = std::make_shared<MappedFile>(path(hash), MappedFile::Mode::ReadOnly);
+    mappings_[hash] = file;
+    return file;
+}
+
+namespace
+{
+// Absolute path, so the same file is recorded once however it was named
+std::string referenceOf(const fs::path & rom)
+{
+    std::error_code ec;
+    fs::path canonical = fs::weakly_canonical(rom, ec);
+    return (ec ? fs::absolute(rom) : canonical).lexically_normal().string();
+}
+
+std::vector<std::string> readReferences(const fs::path & path)
+{
+    std::vector<std::string> references;
+    std::ifstream file(path);
+    for (std::string line; std::getline(file, line);)
+    {
+        if (!line.empty())
+            references.push_back(std::move(line));
+    }
+    return references;
+}
+} // namespace
+
+void RomStore::addReference(const std::string & hash, const fs::path & rom)
+{
+    std::string reference = referenceOf(rom);
+    fs::path path = referencesPath(hash);
+    std::vector<std::string> references = readReferences(path);
+    if (std::find(references.begin(), references.end(), reference) != references.end())
+        return;
+
+    fs::create_directories(directory_);
+    std::ofstream file(path, std::ios::out | std::ios::app);
+    file << reference << '\n';
+    if (!file)
+        throw std::runtime_error("failed to write '" + path.string() + "'");
+}
+
+void RomStore::removeUnreferenced()
+{
+    std::error_code ec;
+    for (const fs::directory_entry & entry : fs::directory_iterator(directory_, ec))
+    {
+        const fs::path & file = entry.path();
+        if (file.extension() != ".rom")
+            continue;
+
+        std::string hash = file.stem().string();
+        fs::path referencesFile = referencesPath(hash);
+        if (!fs::exists(referencesFile, ec))
+            continue;
+
+        std::vector<std::string> references = readReferences(referencesFile);
+        if (std::any_of(references.begin(), references.end(),
+                        [&ec](const std::string & rom) { return fs::exists(rom, ec); }))
+            continue;
+
+        mappings_.erase(hash);
+        // The record goes last so a failed removal is retried
+        if (fs::remove(file, ec))
+            fs::remove(referencesFile, ec);
+    }
+}
+
+fs::path RomStore::path(const std::string & hash) const { return directory_ / (hash + ".rom"); }
+
+fs::path RomStore::referencesPath(const std::string & hash) const { return directory_ / (hash + ".refs"); }
+
+} // namespace lt
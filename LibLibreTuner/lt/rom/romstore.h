@@ -0,0 +1,68 @@
+#ifndef LT_ROMSTORE_H
+#define LT_ROMSTORE_H
+
+#include "../support/mappedfile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace lt
+{
+
+/* ROM images keyed by the SHA-256 of their contents. Identical images are
+ * stored once, however many ROMs use them, across all projects. Each image
+ * records the ROM files that use it, so it is kept while any of them
+ * exists wherever it lives. */
+class RomStore
+{
+public:
+    explicit RomStore(std::filesystem::path directory);
+
+    // Returns the key of an image: the lowercase hex SHA-256 of `data`
+    static std::string hash(std::span<const uint8_t> data);
+
+    // Returns true if the store holds the image with key `hash`
+    bool contains(const std::string & hash) const;
+
+    /* Adds an image unless an identical one is stored. Returns its key.
+     * Throws an exception if it cannot be written. */
+    std::string put(std::span<const uint8_t> data);
+
+    // Same as put(data) for an image whose key `hash` is already known
+    void put(const std::string & hash, std::span<const uint8_t> data);
+
+    // Records that the ROM file at `rom` uses the image with key `hash`
+    void addReference(const std::string & hash, const std::filesystem::path & rom);
+
+    /* Removes every image whose recorded ROM files are all gone. Images
+     * without a record, e.g. stored by older versions, are kept. Images
+     * that cannot be removed, e.g. because Windows has them mapped, are
+     * left for the next call. */
+    void removeUnreferenced();
+
+    /* Maps the image with key `hash` read-only. Every caller gets the same
+     * mapping while any holds it. Throws an exception if the image is not
+     * stored. */
+    MappedFilePtr get(const std::string & hash);
+
+    // Path of the image with key `hash`, whether or not it exists
+    std::filesystem::path path(const std::string & hash) const;
+
+    inline const std::filesystem::path & directory() const noexcept { return directory_; }
+
+private:
+    std::filesystem::path directory_;
+
+    // Path of the list of ROM files using the image with key `hash`
+    std::filesystem::path referencesPath(const std::string & hash) const;
+    std::unordered_map<std::string, std::weak_ptr<MappedFile>> mappings_;
+};
+using RomStorePtr = std::shared_ptr<RomStore>;
+
+} // namespace lt
+
+#endif // LT_ROMSTORE_H
@@ -1,13 +1,17 @@
 #ifndef LIBRETUNER_TABLE_H
 #define LIBRETUNER_TABLE_H
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "../buffer/view.h"
 #include "../support/types.h"
 #include "../support/util.hpp"
+#include "typedtable.h"
 #include "unit.h"
 
 namespace lt
@@ -22,6 +26,25 @@ public:
     virtual void set(int index, PresentedType value) = 0;
     virtual int size() const noexcept = 0;
 
+    // Changes whenever the entries may have changed, see View::generation()
+    virtual std::size_t generation() const noexcept { return 0; }
+
+    // Decodes the first dest.size() entries in one call
+    virtual void readAll(std::span<PresentedType> dest) const
+    {
+        assert(static_cast<int>(dest.size()) <= size());
+        for (std::size_t i = 0; i < dest.size(); ++i)
+            dest[i] = get(static_cast<int>(i));
+    }
+
+    // Encodes src.size() entries starting at the first one
+    virtual void writeAll(std::span<const PresentedType> src)
+    {
+        assert(static_cast<int>(src.size()) <= size());
+        for (std::size_t i = 0; i < src.size(); ++i)
+            set(static_cast<int>(i), src[i]);
+    }
+
     virtual ~Entries() = default;
 };
 
@@ -39,6 +62,59 @@ public:
     }
     void set(int index, PresentedType value) { view_.set<T, endianness>(static_cast<T>(value), index * sizeof(T)); }
     int size() const noexcept { return view_.size() / sizeof(T); }
+    std::size_t generation() const noexcept override { return view_.generation(); }
+
+    // Straight loops over a TypedTable without bounds checks per entry so
+    // the compiler can vectorize the byte swap and conversion.
+    void readAll(std::span<PresentedType> dest) const override
+    {
+        if (dest.empty())
+            return;
+        if (static_cast<int>(dest.size()) > size())
+            throw std::runtime_error("Entries::readAll(): destination exceeds entries");
+
+        // Paged views are copied out in one read first
+        std::vector<uint8_t> copy;
+        const uint8_t * raw;
+        if (view_.contiguous())
+            raw = &*view_.cbegin();
+        else
+        {
+            copy.resize(dest.size() * sizeof(T));
+            view_.read(copy);
+            raw = copy.data();
+        }
+
+        const TypedTable<const T, endianness> table(raw, static_cast<int>(dest.size()));
+        for (std::size_t i = 0; i < dest.size(); ++i)
+            dest[i] = static_cast<PresentedType>(table.get(static_cast<int>(i)));
+    }
+
+    void writeAll(std::span<const PresentedType> src) override
+    {
+        if (src.empty())
+            return;
+        if (static_cast<int>(src.size()) > size())
+            throw std::runtime_error("Entries::writeAll(): source exceeds entries");
+
+        // Paged views take the encoded entries in one write, which is also
+        // one step in the edit journal
+        std::vector<uint8_t> copy;
+        uint8_t * raw;
+        if (view_.contiguous())
+            raw = &*view_.begin();
+        else
+        {
+            copy.resize(src.size() * sizeof(T));
+            raw = copy.data();
+        }
+
+        TypedTable<T, endianness> table(raw, static_cast<int>(src.size()));
+        for (std::size_t i = 0; i < src.size(); ++i)
+            table.set(static_cast<int>(i), static_cast<T>(src[i]));
+        if (!view_.contiguous())
+            view_.write(copy);
+    }
 
 private:
     View view_;
@@ -190,13 +266,7 @@ public:
 
     /* Returns the entry at position (`row`, `column`). Throws an
      * exception if the point is out-of-bounds. Handles scale and unit conversion. */
-    PresentedType get(int row, int column) const
-    {
-        PresentedType entry = static_cast<PresentedType>(entries_->get(index(row, column)) * scale_);
-        if (!unit_)
-            return entry;
-        return unit_->convert(entry);
-    }
+    PresentedType get(int row, int column) const { return values()[index(row, column)]; }
 
     /* Returns the entry at position (`row`, `column`) of base entries. Throws an
      * exception if the point is out-of-bounds. Handles scale and unit conversion. */
@@ -204,10 +274,37 @@ public:
     {
         if (!baseEntries_)
             return PresentedType{};
-        PresentedType entry = static_cast<PresentedType>(baseEntries_->get(index(row, column)) * scale_);
-        if (!unit_)
-            return entry;
-        return unit_->convert(entry);
+        return baseValues()[index(row, column)];
+    }
+
+    /* Returns all entries in row-major order with scale and unit conversion
+     * applied. Decoded in one pass on first use and again whenever the data
+     * changed by other means than set(), e.g. an overlapping table, undo or
+     * loading an image; set() updates the cached entry in place. The span
+     * is invalidated by any change to the data. Not thread-safe. */
+    std::span<const PresentedType> values() const
+    {
+        if (!valuesCurrent())
+        {
+            decode(*entries_, values_);
+            valuesValid_ = true;
+            valuesGeneration_ = entries_->generation();
+        }
+        return values_;
+    }
+
+    // Same as values() for the base entries. Empty if there are none.
+    std::span<const PresentedType> baseValues() const
+    {
+        if (!baseEntries_)
+            return {};
+        if (!baseValuesValid_ || baseValuesGeneration_ != baseEntries_->generation())
+        {
+            decode(*baseEntries_, baseValues_);
+            baseValuesValid_ = true;
+            baseValuesGeneration_ = baseEntries_->generation();
+        }
+        return baseValues_;
     }
 
     /* Resets cell to base cell if one exists. Returns true if cell was reset. */
@@ -217,7 +314,9 @@ public:
             return false;
 
         int idx = index(row, column);
+        bool current = valuesCurrent();
         entries_->set(idx, baseEntries_->get(idx));
+        refresh(idx, current);
         return true;
     }
 
@@ -225,10 +324,27 @@ public:
      * an exception if the point is out-of-bounds. Handles scale and unit conversion. */
     void set(int row, int column, PresentedType value)
     {
-        double entry = value / scale_;
-        if (unit_)
-            entry = unit_->convert(entry);
-        entries_->set(index(row, column), static_cast<PresentedType>(entry));
+        int idx = index(row, column);
+        bool current = valuesCurrent();
+        entries_->set(idx, encode(value));
+        refresh(idx, current);
+        dirty_ = true;
+    }
+
+    /* Sets all entries from row-major `values`, which must hold
+     * width() * height() entries. Handles scale and unit conversion. */
+    void setAll(std::span<const PresentedType> values)
+    {
+        if (static_cast<int>(values.size()) != width_ * height_)
+            throw std::runtime_error("value count does not match table size (" + std::to_string(values.size()) +
+                                     " != " + std::to_string(width_ * height_) + ")");
+
+        std::vector<PresentedType> raw(values.size());
+        std::transform(values.begin(), values.end(), raw.begin(),
+                       [this](PresentedType value) { return encode(value); });
+        entries_->writeAll(raw);
+        // Re-read so the cache reflects the stored precision
+        valuesValid_ = false;
         dirty_ = true;
     }
 
@@ -273,6 +389,57 @@ private:
     bool dirty_{false};
     std::unique_ptr<UnitGroup> unit_;
 
+    // Decoded entries, see values()
+    mutable std::vector<PresentedType> values_;
+    mutable std::vector<PresentedType> baseValues_;
+    mutable bool valuesValid_{false};
+    mutable bool baseValuesValid_{false};
+    // Entries::generation() when the values were decoded
+    mutable std::size_t valuesGeneration_{0};
+    mutable std::size_t baseValuesGeneration_{0};
+
+    // Applies scale and unit conversion to a raw entry
+    PresentedType present(PresentedType raw) const
+    {
+        PresentedType entry = static_cast<PresentedType>(raw * scale_);
+        if (!unit_)
+            return entry;
+        return unit_->convert(entry);
+    }
+
+    // Inverse of present()
+    PresentedType encode(PresentedType value) const
+    {
+        double entry = value / scale_;
+        if (unit_)
+            entry = unit_->convert(entry);
+        return static_cast<PresentedType>(entry);
+    }
+
+    void decode(const Entries<PresentedType> & entries, std::vector<PresentedType> & out) const
+    {
+        out.resize(static_cast<std::size_t>(width_ * height_));
+        entries.readAll(out);
+        for (PresentedType & value : out)
+            value = present(value);
+    }
+
+    inline bool valuesCurrent() const noexcept
+    {
+        return valuesValid_ && valuesGeneration_ == entries_->generation();
+    }
+
+    /* Re-reads a single cached entry after it was written. `current` is
+     * valuesCurrent() from before the write; the write itself changes the
+     * generation. */
+    void refresh(int idx, bool current)
+    {
+        if (!current)
+            return;
+        values_[idx] = present(entries_->get(idx));
+        valuesGeneration_ = entries_->generation();
+    }
+
     BasicTable(std::string name, std::string description, Bounds<PresentedType> bounds,
                EntriesPtr<PresentedType> && entries, EntriesPtr<PresentedType> && baseEntries, int width, int height,
                AxisTypePtr && xAxis, AxisTypePtr && yAxis, double scale, std::unique_ptr<UnitGroup> && unit)
@@ -0,0 +1,181 @@
+#ifndef LT_TYPEDTABLE_H
+#define LT_TYPEDTABLE_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "../buffer/view.h"
+#include "../support/types.h"
+
+namespace lt
+{
+
+namespace detail
+{
+// Unsigned integer with the size of T, used for swapping
+template <typename T>
+using RawEntry = std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2, uint16_t, uint32_t>>;
+
+// Reads an entry of type T stored with `endianness`
+template <typename T, Endianness endianness> inline T loadEntry(const uint8_t * src) noexcept
+{
+    static_assert(sizeof(RawEntry<T>) == sizeof(T), "unsupported entry size");
+    RawEntry<T> bits;
+    std::memcpy(&bits, src, sizeof(T));
+    if constexpr (endianness != endian::current)
+        bits = endian::byteswap(bits);
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+// Writes an entry of type T with `endianness`
+template <typename T, Endianness endianness> inline void storeEntry(uint8_t * dest, T value) noexcept
+{
+    static_assert(sizeof(RawEntry<T>) == sizeof(T), "unsupported entry size");
+    RawEntry<T> bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    if constexpr (endianness != endian::current)
+        bits = endian::byteswap(bits);
+    std::memcpy(dest, &bits, sizeof(T));
+}
+} // namespace detail
+
+/* Statically typed view of raw table entries of type `T` stored with
+ * `endianness`. Does not own the memory. Every access is inline and
+ * unchecked in release builds, so loops over a TypedTable compile down to
+ * plain (vectorizable) loads, byte swaps and stores. A const `T` gives a
+ * read-only view.
+ *
+ * Get one for a runtime DataType/Endianness pair with visitTable(), which
+ * dispatches once per table instead of once per entry like Entries. */
+template <typename T, Endianness endianness> class TypedTable
+{
+    using Byte = std::conditional_t<std::is_const_v<T>, const uint8_t, uint8_t>;
+
+public:
+    using value_type = std::remove_const_t<T>;
+
+    TypedTable(Byte * data, int size) noexcept : data_(data), size_(size) { assert(size >= 0); }
+
+    // The view must be contiguous and its size a multiple of sizeof(T)
+    explicit TypedTable(View view) noexcept
+        : TypedTable(view.size() == 0 ? nullptr : &*view.begin(), view.size() / static_cast<int>(sizeof(T)))
+    {
+        assert(view.contiguous());
+    }
+
+    inline value_type get(int index) const noexcept
+    {
+        assert(index >= 0 && index < size_);
+        return detail::loadEntry<value_type, endianness>(data_ + index * sizeof(T));
+    }
+
+    inline void set(int index, value_type value) noexcept
+        requires(!std::is_const_v<T>)
+    {
+        assert(index >= 0 && index < size_);
+        detail::storeEntry<value_type, endianness>(data_ + index * sizeof(T), value);
+    }
+
+    // Amount of entries
+    inline int size() const noexcept { return size_; }
+
+private:
+    Byte * data_;
+    int size_;
+};
+
+namespace detail
+{
+template <Endianness endianness>
+using TypedTableAlternatives = std::variant<TypedTable<uint8_t, endianness>, TypedTable<uint16_t, endianness>,
+                                            TypedTable<uint32_t, endianness>, TypedTable<int8_t, endianness>,
+                                            TypedTable<int16_t, endianness>, TypedTable<int32_t, endianness>,
+                                            TypedTable<float, endianness>>;
+
+template <Endianness endianness>
+TypedTableAlternatives<endianness> makeTypedTable(DataType type, uint8_t * data, int byteSize)
+{
+    switch (type)
+    {
+    case DataType::Uint8:
+        return TypedTable<uint8_t, endianness>(data, byteSize);
+    case DataType::Uint16:
+        return TypedTable<uint16_t, endianness>(data, byteSize / 2);
+    case DataType::Uint32:
+        return TypedTable<uint32_t, endianness>(data, byteSize / 4);
+    case DataType::Int8:
+        return TypedTable<int8_t, endianness>(data, byteSize);
+    case DataType::Int16:
+        return TypedTable<int16_t, endianness>(data, byteSize / 2);
+    case DataType::Int32:
+        return TypedTable<int32_t, endianness>(data, byteSize / 4);
+    case DataType::Float:
+        return TypedTable<float, endianness>(data, byteSize / 4);
+    default:
+        throw std::runtime_error("invalid table datatype");
+    }
+}
+} // namespace detail
+
+namespace detail
+{
+template <typename Visitor>
+decltype(auto) visitTypedTable(DataType type, Endianness endianness, uint8_t * data, int byteSize, Visitor && visitor)
+{
+    if (endianness == Endianness::Big)
+        return std::visit(std::forward<Visitor>(visitor), makeTypedTable<Endianness::Big>(type, data, byteSize));
+    return std::visit(std::forward<Visitor>(visitor), makeTypedTable<Endianness::Little>(type, data, byteSize));
+}
+} // namespace detail
+
+/* Calls `visitor` with the TypedTable matching `type` and `endianness` for
+ * the memory of `view`. The visitor is instantiated for every combination,
+ * so it is usually a generic lambda:
+ *
+ *   visitTable(DataType::Uint16, Endianness::Big, view, [](auto table) {
+ *       for (int i = 0; i < table.size(); ++i) ...
+ *   });
+ *
+ * A view of a PageOverlay is not contiguous; the visitor gets a copy, which
+ * is written back as one edit if it changed. Throws an exception for an
+ * invalid datatype. */
+template <typename Visitor> decltype(auto) visitTable(DataType type, Endianness endianness, View view, Visitor && visitor)
+{
+    if (!view.contiguous())
+    {
+        std::vector<uint8_t> copy(static_cast<std::size_t>(view.size()));
+        view.read(copy);
+        const std::vector<uint8_t> original(copy);
+
+        using Result = decltype(detail::visitTypedTable(type, endianness, copy.data(), view.size(), visitor));
+        if constexpr (std::is_void_v<Result>)
+        {
+            detail::visitTypedTable(type, endianness, copy.data(), view.size(), std::forward<Visitor>(visitor));
+            if (copy != original)
+                view.write(copy);
+            return;
+        }
+        else
+        {
+            Result result =
+                detail::visitTypedTable(type, endianness, copy.data(), view.size(), std::forward<Visitor>(visitor));
+            if (copy != original)
+                view.write(copy);
+            return result;
+        }
+    }
+
+    uint8_t * data = view.size() == 0 ? nullptr : &*view.begin();
+    return detail::visitTypedTable(type, endianness, data, view.size(), std::forward<Visitor>(visitor));
+}
+
+} // namespace lt
+
+#endif // LT_TYPEDTABLE_H
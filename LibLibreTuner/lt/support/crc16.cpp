@@ -0,0 +1,56 @@
+#include "crc16.h"
+
+#include <array>
+
+namespace lt
+{
+
+namespace
+{
+constexpr std::array<uint16_t, 256> makeTable() noexcept
+{
+    std::array<uint16_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i << 8;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc << 1) ^ ((crc & 0x8000) ? 0x1021 : 0);
+        table[i] = static_cast<uint16_t>(crc);
+    }
+    return table;
+}
+
+// The low byte of each table entry is unique, so it identifies the index
+constexpr std::array<uint8_t, 256> makeReverse(const std::array<uint16_t, 256> & table) noexcept
+{
+    std::array<uint8_t, 256> reverse{};
+    for (uint32_t i = 0; i < 256; ++i)
+        reverse[table[i] & 0xFF] = static_cast<uint8_t>(i);
+    return reverse;
+}
+
+constexpr std::array<uint16_t, 256> table = makeTable();
+constexpr std::array<uint8_t, 256> reverse = makeReverse(table);
+} // namespace
+
+uint16_t crc16Ccitt(const uint8_t * data, std::size_t size, uint16_t crc) noexcept
+{
+    for (std::size_t i = 0; i < size; ++i)
+        crc = static_cast<uint16_t>((crc << 8) ^ table[(crc >> 8) ^ data[i]]);
+    return crc;
+}
+
+uint16_t crc16CcittRewind(const uint8_t * data, std::size_t size,
+                          uint16_t result) noexcept
+{
+    uint32_t crc = result;
+    while (size > 0)
+    {
+        // Invert crc = (previous << 8) ^ table[(previous >> 8) ^ byte]
+        uint8_t index = reverse[crc & 0xFF];
+        crc = ((crc ^ table[index]) >> 8) | ((index ^ data[--size]) << 8);
+    }
+    return static_cast<uint16_t>(crc);
+}
+
+} // namespace lt
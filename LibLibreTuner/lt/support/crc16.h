@@ -0,0 +1,23 @@
+#ifndef LT_CRC16_H
+#define LT_CRC16_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lt
+{
+
+/* CRC-16/CCITT (polynomial 0x1021, not reflected, no final XOR). The
+ * default `crc` is the usual 0xFFFF initial value. Pass the previous
+ * result as `crc` to continue a running checksum. */
+uint16_t crc16Ccitt(const uint8_t * data, std::size_t size,
+                    uint16_t crc = 0xFFFF) noexcept;
+
+/* Undoes crc16Ccitt(): returns the `crc` for which
+ * crc16Ccitt(data, size, crc) returns `result`. */
+uint16_t crc16CcittRewind(const uint8_t * data, std::size_t size,
+                          uint16_t result) noexcept;
+
+} // namespace lt
+
+#endif // LT_CRC16_H
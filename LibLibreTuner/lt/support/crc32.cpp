@@ -0,0 +1,191 @@
+#include "crc32.h"
+
+#include <array>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define LT_CRC32_CLMUL
+#include <immintrin.h>
+#endif
+
+namespace lt
+{
+
+namespace
+{
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+/* tables[0] is the byte-at-a-time table. tables[k][i] is the CRC of byte
+ * i followed by k zero bytes, which lets eight bytes be folded in with
+ * independent lookups (slicing-by-8). */
+constexpr Tables makeTables() noexcept
+{
+    Tables tables{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        tables[0][i] = crc;
+    }
+    for (std::size_t k = 1; k < tables.size(); ++k)
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t previous = tables[k - 1][i];
+            tables[k][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+        }
+    }
+    return tables;
+}
+
+// The top byte of each table entry is unique, so it identifies the index
+constexpr std::array<uint8_t, 256> makeReverse(const Tables & tables) noexcept
+{
+    std::array<uint8_t, 256> reverse{};
+    for (uint32_t i = 0; i < 256; ++i)
+        reverse[tables[0][i] >> 24] = static_cast<uint8_t>(i);
+    return reverse;
+}
+
+constexpr Tables tables = makeTables();
+constexpr std::array<uint8_t, 256> reverse = makeReverse(tables);
+
+inline uint32_t loadLE32(const uint8_t * data) noexcept
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+} // namespace
+
+namespace
+{
+// Continues the inverted CRC `crc` over `data` eight bytes at a time
+uint32_t sliceBy8(const uint8_t * data, std::size_t size,
+                  uint32_t crc) noexcept
+{
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        uint32_t low = loadLE32(data) ^ crc;
+        uint32_t high = loadLE32(data + 4);
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^
+              tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+              tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^
+              tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+    for (; size > 0; --size, ++data)
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+    return crc;
+}
+
+#ifdef LT_CRC32_CLMUL
+#define LT_CLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+
+LT_CLMUL_TARGET inline __m128i load(const uint8_t * data) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+}
+
+// Multiplies both halves of `x` by `k` and adds the next lane
+LT_CLMUL_TARGET inline __m128i fold(__m128i x, __m128i k,
+                                    __m128i next) noexcept
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                       _mm_clmulepi64_si128(x, k, 0x11)),
+                         next);
+}
+
+/* Continues the inverted CRC `crc` over `size` bytes, at least 64 and a
+ * multiple of 16, by folding 128-bit lanes with carry-less multiplies and
+ * a final Barrett reduction. The constants are powers of x modulo the
+ * reflected polynomial, as in Intel's "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ". */
+LT_CLMUL_TARGET uint32_t foldClmul(const uint8_t * data, std::size_t size,
+                                   uint32_t crc) noexcept
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_xor_si128(load(data),
+                               _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = load(data + 16);
+    __m128i x3 = load(data + 32);
+    __m128i x4 = load(data + 48);
+    data += 64;
+    size -= 64;
+
+    // Four independent lanes hide the multiply latency
+    for (; size >= 64; size -= 64, data += 64)
+    {
+        x1 = fold(x1, k1k2, load(data));
+        x2 = fold(x2, k1k2, load(data + 16));
+        x3 = fold(x3, k1k2, load(data + 32));
+        x4 = fold(x4, k1k2, load(data + 48));
+    }
+
+    x1 = fold(x1, k3k4, x2);
+    x1 = fold(x1, k3k4, x3);
+    x1 = fold(x1, k3k4, x4);
+    for (; size >= 16; size -= 16, data += 16)
+        x1 = fold(x1, k3k4, load(data));
+
+    // 128 to 64 bits
+    __m128i x2r = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+    x2r = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(
+        _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00), x2r);
+
+    // Barrett reduction to 32 bits
+    __m128i t = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+    t = _mm_clmulepi64_si128(_mm_and_si128(t, mask32), poly, 0x00);
+    return static_cast<uint32_t>(_mm_extract_epi32(_mm_xor_si128(x1, t), 1));
+}
+
+bool hasClmul() noexcept
+{
+    static const bool supported = __builtin_cpu_supports("pclmul") &&
+                                  __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+#endif
+} // namespace
+
+uint32_t crc32(const uint8_t * data, std::size_t size, uint32_t crc) noexcept
+{
+    crc = ~crc;
+#ifdef LT_CRC32_CLMUL
+    if (size >= 64 && hasClmul())
+    {
+        std::size_t folded = size & ~static_cast<std::size_t>(15);
+        crc = foldClmul(data, folded, crc);
+        data += folded;
+        size -= folded;
+    }
+#endif
+    return ~sliceBy8(data, size, crc);
+}
+
+uint32_t crc32Slicing(const uint8_t * data, std::size_t size,
+                      uint32_t crc) noexcept
+{
+    return ~sliceBy8(data, size, ~crc);
+}
+
+uint32_t crc32Rewind(const uint8_t * data, std::size_t size,
+                     uint32_t result) noexcept
+{
+    uint32_t crc = ~result;
+    while (size > 0)
+    {
+        // Invert crc = (previous >> 8) ^ table[(previous ^ byte) & 0xFF]
+        uint8_t index = reverse[crc >> 24];
+        crc = ((crc ^ tables[0][index]) << 8) | (index ^ data[--size]);
+    }
+    return ~crc;
+}
+
+} // namespace lt
@@ -0,0 +1,28 @@
+#ifndef LT_CRC32_H
+#define LT_CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lt
+{
+
+/* CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) as used by zlib.
+ * Pass the previous result as `crc` to continue a running checksum. On
+ * x86 CPUs with PCLMULQDQ, blocks of 64 bytes or more are folded with
+ * carry-less multiplies; elsewhere tables are used eight bytes at a time. */
+uint32_t crc32(const uint8_t * data, std::size_t size,
+               uint32_t crc = 0) noexcept;
+
+// Same as crc32() using the tables only, whatever the CPU
+uint32_t crc32Slicing(const uint8_t * data, std::size_t size,
+                      uint32_t crc = 0) noexcept;
+
+/* Undoes crc32(): returns the `crc` for which crc32(data, size, crc)
+ * returns `result`. Used to solve for bytes that give a wanted CRC. */
+uint32_t crc32Rewind(const uint8_t * data, std::size_t size,
+                     uint32_t result) noexcept;
+
+} // namespace lt
+
+#endif // LT_CRC32_H
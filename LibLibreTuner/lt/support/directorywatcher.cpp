@@ -0,0 +1,88 @@
+#include "directorywatcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace lt
+{
+
+#ifdef __linux__
+
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path & directory)
+{
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0)
+        return;
+
+    constexpr uint32_t mask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM |
+                              IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+    if (inotify_add_watch(fd_, directory.c_str(), mask) < 0)
+        close();
+}
+
+DirectoryWatcher::~DirectoryWatcher() { close(); }
+
+bool DirectoryWatcher::changed()
+{
+    if (fd_ < 0)
+        return true;
+
+    bool any = false;
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = ::read(fd_, buffer, sizeof(buffer));
+        if (length < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            // EAGAIN: no more events
+            if (errno != EAGAIN)
+                close();
+            break;
+        }
+        if (length == 0)
+            break;
+
+        any = true;
+        for (ssize_t offset = 0; offset < length;)
+        {
+            inotify_event event;
+            std::memcpy(&event, buffer + offset, sizeof(event));
+            // Events were dropped or the directory itself is gone. The
+            // directory has to be checked from now on.
+            if ((event.mask & (IN_Q_OVERFLOW | IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+                close();
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event.len);
+        }
+        if (fd_ < 0)
+            break;
+    }
+    return any || fd_ < 0;
+}
+
+void DirectoryWatcher::close() noexcept
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+}
+
+#else
+
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path & /*directory*/) {}
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+bool DirectoryWatcher::changed() { return true; }
+
+void DirectoryWatcher::close() noexcept {}
+
+#endif
+
+} // namespace lt
@@ -0,0 +1,37 @@
+#ifndef LT_DIRECTORYWATCHER_H
+#define LT_DIRECTORYWATCHER_H
+
+#include <filesystem>
+
+namespace lt
+{
+
+/* Tells whether the files in a directory may have changed. Uses inotify on
+ * Linux. Elsewhere, or if the directory cannot be watched, every change()
+ * call reports a change, so callers fall back to checking the files. */
+class DirectoryWatcher
+{
+public:
+    explicit DirectoryWatcher(const std::filesystem::path & directory);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher &) = delete;
+    DirectoryWatcher & operator=(const DirectoryWatcher &) = delete;
+
+    /* Returns true if a file was created, removed, renamed or written
+     * since the last call or construction. Never blocks. */
+    bool changed();
+
+    /* Returns false if changes are not being watched, e.g. because the
+     * directory was removed. changed() then always returns true. */
+    inline bool watching() const noexcept { return fd_ >= 0; }
+
+private:
+    int fd_{-1};
+
+    void close() noexcept;
+};
+
+} // namespace lt
+
+#endif // LT_DIRECTORYWATCHER_H
@@ -39,6 +39,20 @@ template <typename T> T swap(T t)
     return *reinterpret_cast<T *>(raw);
 }
 
+// Shift-based swaps for unsigned integers. Compilers turn these into bswap
+// instructions and vectorize them in loops, unlike the byte reversal above.
+inline uint8_t byteswap(uint8_t t) noexcept { return t; }
+
+inline uint16_t byteswap(uint16_t t) noexcept
+{
+    return static_cast<uint16_t>((t >> 8) | (t << 8));
+}
+
+inline uint32_t byteswap(uint32_t t) noexcept
+{
+    return (t >> 24) | ((t >> 8) & 0xFF00) | ((t << 8) & 0xFF0000) | (t << 24);
+}
+
 template <typename T, Endianness from, Endianness to> T convert(T t)
 {
     if constexpr (from == to)
@@ -0,0 +1,148 @@
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lt
+{
+
+namespace
+{
+std::size_t systemPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+[[noreturn]] void mapError(const std::filesystem::path & path, const std::string & what)
+{
+#ifdef _WIN32
+    throw std::runtime_error("failed to " + what + " '" + path.string() + "' (error " +
+                             std::to_string(GetLastError()) + ")");
+#else
+    throw std::runtime_error("failed to " + what + " '" + path.string() + "': " + std::strerror(errno));
+#endif
+}
+} // namespace
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path & path, Mode mode) : mode_(mode)
+{
+    // Others may write the file in place; see detach()
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        mapError(path, "open");
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        mapError(path, "stat");
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ == 0)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    DWORD protect = mode == Mode::Private ? PAGE_WRITECOPY : PAGE_READONLY;
+    mapping_ = CreateFileMappingW(file, nullptr, protect, 0, 0, nullptr);
+    // The mapping holds its own reference to the file. Closing the handle
+    // lets the file be opened for writing while it is mapped.
+    CloseHandle(file);
+    if (mapping_ == nullptr)
+        mapError(path, "map");
+
+    DWORD access = mode == Mode::Private ? FILE_MAP_COPY : FILE_MAP_READ;
+    data_ = static_cast<uint8_t *>(MapViewOfFile(mapping_, access, 0, 0, 0));
+    if (data_ == nullptr)
+    {
+        CloseHandle(mapping_);
+        mapError(path, "map");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle(mapping_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path & path, Mode mode) : mode_(mode)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        mapError(path, "open");
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        mapError(path, "stat");
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    int protect = mode == Mode::Private ? PROT_READ | PROT_WRITE : PROT_READ;
+    int flags = mode == Mode::Private ? MAP_PRIVATE : MAP_SHARED;
+    void * data = ::mmap(nullptr, size_, protect, flags, fd, 0);
+    // The mapping holds its own reference to the file
+    ::close(fd);
+    if (data == MAP_FAILED)
+        mapError(path, "map");
+    data_ = static_cast<uint8_t *>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr)
+        ::munmap(data_, size_);
+}
+
+#endif
+
+void MappedFile::detach(std::size_t offset, std::size_t size)
+{
+    assert(mode_ == Mode::Private);
+    if (offset >= size_ || size == 0)
+        return;
+    size = std::min(size, size_ - offset);
+
+    // Writing one byte of a page is enough to get a private copy of it
+    const std::size_t page = systemPageSize();
+    volatile uint8_t * bytes = data_;
+    for (std::size_t position = offset - offset % page; position < offset + size; position += page)
+        bytes[position] = bytes[position];
+}
+
+} // namespace lt
@@ -0,0 +1,59 @@
+#ifndef LT_MAPPEDFILE_H
+#define LT_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace lt
+{
+
+/* Memory mapping of a whole file. Mapping costs nothing up front; pages
+ * are read from the file as they are touched. */
+class MappedFile
+{
+public:
+    enum class Mode
+    {
+        // Shares pages with the system's file cache. The memory must not
+        // be written.
+        ReadOnly,
+        // Copy-on-write. Writes go to private copies of the pages and
+        // never reach the file.
+        Private,
+    };
+
+    // Throws an exception if the file cannot be opened or mapped
+    MappedFile(const std::filesystem::path & path, Mode mode);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    inline std::span<const uint8_t> bytes() const noexcept { return {data_, size_}; }
+    inline const uint8_t * data() const noexcept { return data_; }
+    inline std::size_t size() const noexcept { return size_; }
+    inline Mode mode() const noexcept { return mode_; }
+
+    /* Private mappings only. Copies the pages holding [offset, offset +
+     * size) into the process, so they keep their current contents when
+     * the file is written later. Without this, whether a private mapping
+     * sees later writes to the file is unspecified. */
+    void detach(std::size_t offset, std::size_t size);
+
+private:
+    uint8_t * data_{nullptr};
+    std::size_t size_{0};
+    Mode mode_;
+
+#ifdef _WIN32
+    void * mapping_{nullptr};
+#endif
+};
+using MappedFilePtr = std::shared_ptr<MappedFile>;
+
+} // namespace lt
+
+#endif // LT_MAPPEDFILE_H
@@ -0,0 +1,85 @@
+#include "pacer.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace lt
+{
+
+namespace
+{
+// Time left to spin after sleeping. Covers typical wakeup latency.
+constexpr std::chrono::microseconds spin_margin{150};
+
+void sleepUntil(Pacer::Clock::time_point deadline)
+{
+#ifdef __linux__
+    // steady_clock is CLOCK_MONOTONIC on Linux
+    auto since = deadline.time_since_epoch();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since);
+    timespec ts{};
+    ts.tv_sec = seconds.count();
+    ts.tv_nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(since - seconds)
+            .count();
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+           EINTR)
+    {
+    }
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+} // namespace
+
+void Pacer::reset(std::chrono::microseconds separation) noexcept
+{
+    separation_ = separation;
+    stats_.requested = separation;
+    hasLast_ = false;
+}
+
+void Pacer::wait() const
+{
+    if (!hasLast_ || separation_.count() <= 0)
+        return;
+
+    const Clock::time_point deadline = last_ + separation_;
+    if (separation_ >= std::chrono::milliseconds(1))
+    {
+        // STmin is a minimum; a little oversleep is cheaper than spinning
+        sleepUntil(deadline);
+        return;
+    }
+
+    // Sub-millisecond separation (STmin 0xF1-0xF9)
+    if (deadline - Clock::now() > spin_margin)
+        sleepUntil(deadline - spin_margin);
+    while (Clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void Pacer::mark() noexcept
+{
+    Clock::time_point now = Clock::now();
+    if (hasLast_)
+    {
+        auto elapsed =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_);
+        ++stats_.count;
+        stats_.total += elapsed;
+        stats_.minimum = std::min(stats_.minimum, elapsed);
+        stats_.maximum = std::max(stats_.maximum, elapsed);
+    }
+    last_ = now;
+    hasLast_ = true;
+}
+
+} // namespace lt
@@ -0,0 +1,62 @@
+#ifndef LT_PACER_H
+#define LT_PACER_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace lt
+{
+
+// Separation between paced events, as requested and as achieved
+struct PacingStats
+{
+    // Most recently requested separation
+    std::chrono::microseconds requested{0};
+    // Amount of measured separations
+    std::size_t count{0};
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds minimum{std::chrono::nanoseconds::max()};
+    std::chrono::nanoseconds maximum{0};
+
+    inline std::chrono::nanoseconds average() const noexcept
+    {
+        if (count == 0)
+            return std::chrono::nanoseconds(0);
+        return total / count;
+    }
+};
+
+/* Enforces a minimum separation between events (e.g. ISO-TP consecutive
+ * frames). Waits target an absolute deadline measured from the previous
+ * event, so time spent between events is not added on top of the
+ * separation. Separations below a millisecond finish with a short spin
+ * because the scheduler cannot wake up that precisely. */
+class Pacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Sets the separation and forgets the previous event, so the next
+    // wait() returns immediately.
+    void reset(std::chrono::microseconds separation) noexcept;
+
+    // Waits until the separation since the previous event has elapsed
+    void wait() const;
+
+    // Records that an event happened now
+    void mark() noexcept;
+
+    inline const PacingStats & stats() const noexcept { return stats_; }
+    inline void clearStats() noexcept { stats_ = PacingStats{}; }
+
+private:
+    std::chrono::microseconds separation_{0};
+    Clock::time_point last_;
+    bool hasLast_{false};
+
+    PacingStats stats_;
+};
+
+} // namespace lt
+
+#endif // LT_PACER_H
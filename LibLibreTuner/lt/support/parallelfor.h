@@ -0,0 +1,73 @@
+#ifndef LT_PARALLELFOR_H
+#define LT_PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lt
+{
+
+/* Runs `task(i)` for every i in [0, count) on up to one thread per core.
+ * Indices are handed out in order. Rethrows the exception of the lowest
+ * failed index, like a loop would. */
+template <typename F> void parallelFor(std::size_t count, F && task)
+{
+    unsigned threads = static_cast<unsigned>(
+        std::clamp<std::size_t>(count, 1, std::max(std::thread::hardware_concurrency(), 1u)));
+
+    std::atomic<std::size_t> next{0};
+    std::vector<std::exception_ptr> errors(count);
+    auto work = [&] {
+        for (std::size_t i = next++; i < count; i = next++)
+        {
+            try
+            {
+                task(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back(work);
+    work();
+    for (std::thread & worker : workers)
+        worker.join();
+
+    for (const std::exception_ptr & error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+/* Below this many bytes of work in total, starting threads costs more
+ * than it saves */
+constexpr std::size_t parallel_min_bytes = 1 << 20;
+
+/* Same as parallelFor(count, task), but runs the tasks in a plain loop if
+ * together they process fewer than parallel_min_bytes `bytes` */
+template <typename F> void parallelFor(std::size_t count, std::size_t bytes, F && task)
+{
+    if (bytes < parallel_min_bytes)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+    parallelFor(count, std::forward<F>(task));
+}
+
+} // namespace lt
+
+#endif // LT_PARALLELFOR_H
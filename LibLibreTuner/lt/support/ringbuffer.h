@@ -0,0 +1,188 @@
+#ifndef LT_RINGBUFFER_H
+#define LT_RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace lt
+{
+
+// What a full ring does with a new element
+enum class RingPolicy
+{
+    // Discards the oldest element to make room
+    OverwriteOldest,
+    // Rejects the element until the consumer catches up
+    Block,
+};
+
+/* Fixed-capacity, lock-free ring for exactly one producer thread and one
+ * consumer thread. The capacity is rounded up to a power of two. Head and
+ * tail live on separate cache lines so the two threads do not contend.
+ *
+ * Each slot carries a sequence number saying whether it is free for the
+ * producer or holds an element for the consumer. An element is owned by
+ * whoever advances the head past it, so with RingPolicy::OverwriteOldest
+ * the producer and the consumer race for the oldest element with a
+ * compare-exchange and the loser never touches the slot. The consumer
+ * copies the element out after claiming it; a producer that needs the
+ * slot meanwhile waits for that copy to finish. */
+template <typename T> class SpscRing
+{
+public:
+    explicit SpscRing(std::size_t capacity,
+                      RingPolicy policy = RingPolicy::OverwriteOldest)
+        : capacity_(roundUp(capacity)), mask_(capacity_ - 1), policy_(policy),
+          slots_(std::make_unique<Slot[]>(capacity_))
+    {
+        for (std::size_t i = 0; i < capacity_; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing & operator=(const SpscRing &) = delete;
+
+    /* Producer only. Returns false if the ring is full and the policy
+     * is Block. A rejected element is not counted as an overrun; call
+     * discard() if it is given up. */
+    bool push(const T & value) noexcept
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        Slot & slot = slots_[tail & mask_];
+        // The slot is free once the element a lap behind has been popped
+        while (slot.sequence.load(std::memory_order_acquire) != tail)
+        {
+            if (policy_ == RingPolicy::Block)
+            {
+                return false;
+            }
+            // Take the oldest element away from the consumer and reuse its
+            // slot. If this fails, the consumer claimed it first and is
+            // still copying it out.
+            std::size_t oldest = tail - capacity_;
+            if (head_.compare_exchange_strong(oldest, oldest + 1,
+                                              std::memory_order_acq_rel))
+            {
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            std::this_thread::yield();
+        }
+
+        slot.value = value;
+        slot.sequence.store(tail + 1, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Producer only. Counts an element rejected by push() that the
+     * producer gives up on as an overrun. */
+    void discard() noexcept
+    {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /* Consumer only. Returns false if the ring is empty. */
+    bool pop(T & value) noexcept
+    {
+        std::size_t head;
+        if (!claim(head))
+        {
+            return false;
+        }
+        Slot & slot = slots_[head & mask_];
+        value = slot.value;
+        slot.sequence.store(head + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer only. Discards all elements. */
+    void clear() noexcept
+    {
+        std::size_t head;
+        while (claim(head))
+        {
+            slots_[head & mask_].sequence.store(head + capacity_,
+                                                std::memory_order_release);
+        }
+    }
+
+    // Returns the amount of elements in the ring. Only a snapshot when
+    // called while the other side is active.
+    inline std::size_t size() const noexcept
+    {
+        return tail_.load(std::memory_order_acquire) -
+               head_.load(std::memory_order_acquire);
+    }
+
+    inline bool empty() const noexcept { return size() == 0; }
+
+    inline std::size_t capacity() const noexcept { return capacity_; }
+
+    inline RingPolicy policy() const noexcept { return policy_; }
+
+    // Returns the amount of elements lost because the ring was full:
+    // dropped by OverwriteOldest or given up with discard().
+    inline std::size_t overruns() const noexcept
+    {
+        return overruns_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t cache_line = 64;
+
+    struct Slot
+    {
+        // Equal to the position the producer writes next when free, one
+        // past the position of the element it holds when full
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static std::size_t roundUp(std::size_t capacity) noexcept
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // Advances the head past the oldest element, making the consumer its
+    // owner. Returns false if the ring is empty.
+    bool claim(std::size_t & head) noexcept
+    {
+        head = head_.load(std::memory_order_acquire);
+        while (head != tail_.load(std::memory_order_acquire))
+        {
+            // Fails if the producer dropped this element
+            if (head_.compare_exchange_weak(head, head + 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    const RingPolicy policy_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Written by the consumer (and the producer when overwriting)
+    alignas(cache_line) std::atomic<std::size_t> head_{0};
+    // Written by the producer
+    alignas(cache_line) std::atomic<std::size_t> tail_{0};
+    std::atomic<std::size_t> overruns_{0};
+};
+
+} // namespace lt
+
+#endif // LT_RINGBUFFER_H
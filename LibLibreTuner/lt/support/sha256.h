@@ -0,0 +1,22 @@
+#ifndef LT_SHA256_H
+#define LT_SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lt
+{
+
+using Sha256Digest = std::array<uint8_t, 32>;
+
+// SHA-256 (FIPS 180-4) of `size` bytes
+Sha256Digest sha256(const uint8_t * data, std::size_t size) noexcept;
+
+// Lowercase hexadecimal form of a digest
+std::string toHex(const Sha256Digest & digest);
+
+} // namespace lt
+
+#endif // LT_SHA256_H
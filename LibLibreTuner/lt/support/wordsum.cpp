@@ -0,0 +1,72 @@
+#include "wordsum.h"
+#include "endianness.h"
+
+#include <cstring>
+
+namespace lt
+{
+
+namespace
+{
+inline uint32_t loadBE32(const uint8_t * data) noexcept
+{
+    uint32_t word;
+    std::memcpy(&word, data, sizeof(word));
+    if constexpr (endian::isLittle)
+        word = endian::byteswap(word);
+    return word;
+}
+
+inline uint32_t loadBE16(const uint8_t * data) noexcept
+{
+    uint16_t word;
+    std::memcpy(&word, data, sizeof(word));
+    if constexpr (endian::isLittle)
+        word = endian::byteswap(word);
+    return word;
+}
+
+/* Folds `words` words with `op`. Independent lanes keep the operations out
+ * of one dependency chain, and the compiler turns the lane loop into
+ * vector byte shuffles and adds or XORs. */
+template <std::size_t width, typename Load, typename Op>
+inline uint32_t fold(const uint8_t * data, std::size_t words, Load load, Op op) noexcept
+{
+    constexpr std::size_t lanes = 8;
+    uint32_t partial[lanes] = {};
+
+    std::size_t i = 0;
+    for (; i + lanes <= words; i += lanes)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+            partial[lane] = op(partial[lane], load(data + (i + lane) * width));
+    }
+
+    uint32_t result = 0;
+    for (uint32_t value : partial)
+        result = op(result, value);
+    for (; i < words; ++i)
+        result = op(result, load(data + i * width));
+    return result;
+}
+
+inline uint32_t add(uint32_t a, uint32_t b) noexcept { return a + b; }
+inline uint32_t exclusiveOr(uint32_t a, uint32_t b) noexcept { return a ^ b; }
+} // namespace
+
+uint32_t sumBE32(const uint8_t * data, std::size_t words) noexcept
+{
+    return fold<4>(data, words, loadBE32, add);
+}
+
+uint32_t sumBE16(const uint8_t * data, std::size_t words) noexcept
+{
+    return fold<2>(data, words, loadBE16, add);
+}
+
+uint32_t xorBE32(const uint8_t * data, std::size_t words) noexcept
+{
+    return fold<4>(data, words, loadBE32, exclusiveOr);
+}
+
+} // namespace lt
@@ -0,0 +1,22 @@
+#ifndef LT_WORDSUM_H
+#define LT_WORDSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lt
+{
+
+/* Returns the sum, modulo 2^32, of `words` big endian 32-bit words
+ * starting at `data`. `data` needs no alignment. */
+uint32_t sumBE32(const uint8_t * data, std::size_t words) noexcept;
+
+// Same as sumBE32 for big endian 16-bit words. The sum is not truncated.
+uint32_t sumBE16(const uint8_t * data, std::size_t words) noexcept;
+
+// Returns the XOR of `words` big endian 32-bit words starting at `data`
+uint32_t xorBE32(const uint8_t * data, std::size_t words) noexcept;
+
+} // namespace lt
+
+#endif // LT_WORDSUM_H
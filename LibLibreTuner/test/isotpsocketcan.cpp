@@ -0,0 +1,223 @@
+#ifdef WITH_SOCKETCAN
+
+#include <catch2/catch.hpp>
+
+#include "link/socketcan.h"
+#include "network/can/socketcan.h"
+#include "network/isotp/isotpcan.h"
+#include "network/isotp/isotpsocketcan.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace lt;
+using namespace lt::network;
+
+namespace
+{
+using Bytes = std::vector<uint8_t>;
+
+std::string interfaceName()
+{
+    const char * name = std::getenv("LT_TEST_CANIF");
+    return name != nullptr ? name : "vcan0";
+}
+
+bool canAvailable(const std::string & ifname)
+{
+    try
+    {
+        SocketCan can(ifname);
+        return true;
+    }
+    catch (const std::runtime_error &)
+    {
+        return false;
+    }
+}
+
+bool kernelIsoTpAvailable(const std::string & ifname)
+{
+    try
+    {
+        IsoTpSocketCan isotp(ifname);
+        return true;
+    }
+    catch (const std::runtime_error &)
+    {
+        return false;
+    }
+}
+
+Bytes pattern(std::size_t size, uint8_t seed)
+{
+    Bytes bytes(size);
+    for (std::size_t i = 0; i < size; ++i)
+        bytes[i] = static_cast<uint8_t>(seed + i * 7);
+    return bytes;
+}
+
+/* An ECU on the CAN interface, speaking through IsoTpCan on the swapped
+ * ids. Answers each request with the next response of the script after
+ * checking the request. */
+class Responder
+{
+public:
+    using Script = std::vector<std::pair<Bytes, Bytes>>;
+
+    Responder(const std::string & ifname, Script script)
+        : script_(std::move(script))
+    {
+        IsoTpOptions options;
+        std::swap(options.sourceId, options.destId);
+        options.timeout = std::chrono::milliseconds(100);
+        isotp_ = std::make_unique<IsoTpCan>(std::make_unique<SocketCan>(ifname),
+                                            options);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~Responder()
+    {
+        stop_ = true;
+        thread_.join();
+    }
+
+    // Requests that did not match the script
+    std::vector<std::string> errors() const
+    {
+        std::lock_guard lock(mutex_);
+        return errors_;
+    }
+
+private:
+    Script script_;
+    std::unique_ptr<IsoTpCan> isotp_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> errors_;
+
+    void run()
+    {
+        IsoTpPacket request;
+        std::size_t next = 0;
+        while (!stop_)
+        {
+            try
+            {
+                isotp_->recv(request);
+            }
+            catch (const std::runtime_error &)
+            {
+                // Timed out; check for stop
+                continue;
+            }
+
+            std::lock_guard lock(mutex_);
+            if (next == script_.size())
+            {
+                errors_.emplace_back("request after the end of the script");
+                continue;
+            }
+            const auto & [expected, response] = script_[next++];
+            if (Bytes(request.begin(), request.end()) != expected)
+                errors_.emplace_back("request " + std::to_string(next) +
+                                     " does not match the script");
+            isotp_->send(IsoTpPacket(response));
+        }
+    }
+};
+
+// Single frames both ways, then segmented requests and responses
+Responder::Script exchangeScript()
+{
+    return {
+        {{0x22, 0xF1, 0x90}, {0x62, 0xF1, 0x90, 0x01}},
+        {pattern(200, 1), {0x76, 0x01}},
+        {{0x23, 0x44}, pattern(1000, 2)},
+        {pattern(4095, 3), pattern(4095, 4)},
+    };
+}
+
+void exchange(IsoTp & isotp)
+{
+    IsoTpPacket response;
+    for (const auto & [request, expected] : exchangeScript())
+    {
+        isotp.request(IsoTpPacket(request), response);
+        REQUIRE(Bytes(response.begin(), response.end()) == expected);
+    }
+}
+
+IsoTpOptions clientOptions()
+{
+    IsoTpOptions options;
+    options.timeout = std::chrono::milliseconds(1000);
+    return options;
+}
+} // namespace
+
+TEST_CASE("IsoTpSocketCan exchanges packets with a vcan responder",
+          "[isotp][vcan]")
+{
+    const std::string ifname = interfaceName();
+    if (!canAvailable(ifname) || !kernelIsoTpAvailable(ifname))
+    {
+        WARN("skipped: " << ifname << " or CAN_ISOTP is not available");
+        return;
+    }
+
+    Responder responder(ifname, exchangeScript());
+    IsoTpSocketCan isotp(ifname, clientOptions());
+    exchange(isotp);
+    CHECK(responder.errors().empty());
+}
+
+TEST_CASE("SocketCanLink falls back to IsoTpCan", "[isotp][vcan]")
+{
+    const std::string ifname = interfaceName();
+    if (!canAvailable(ifname))
+    {
+        WARN("skipped: " << ifname << " is not available");
+        return;
+    }
+
+    SocketCanLink link("vcan", ifname);
+
+    SECTION("with the kernel transport enabled")
+    {
+        // Without can-isotp, creating the kernel transport throws and the
+        // link must still return a working transport
+        IsoTpPtr isotp = link.isotp(clientOptions());
+        REQUIRE(isotp);
+        if (kernelIsoTpAvailable(ifname))
+            CHECK(dynamic_cast<IsoTpSocketCan *>(isotp.get()) != nullptr);
+        else
+            CHECK(dynamic_cast<IsoTpCan *>(isotp.get()) != nullptr);
+
+        Responder responder(ifname, exchangeScript());
+        exchange(*isotp);
+        CHECK(responder.errors().empty());
+    }
+
+    SECTION("when the kernel transport is disabled")
+    {
+        link.setKernelIsoTp(false);
+        IsoTpPtr isotp = link.isotp(clientOptions());
+        REQUIRE(dynamic_cast<IsoTpCan *>(isotp.get()) != nullptr);
+
+        Responder responder(ifname, exchangeScript());
+        exchange(*isotp);
+        CHECK(responder.errors().empty());
+    }
+}
+
+#endif
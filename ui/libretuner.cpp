@@ -26,6 +26,7 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QMessageBox>
+#include <QSettings>
 #include <QStandardPaths>
 #include <QStyledItemDelegate>
 #include <QTextStream>
@@ -57,8 +58,12 @@ LibreTuner::LibreTuner(int & argc, char * argv[])
     setLayoutDirection(Qt::LeftToRight);
 
     // Setup LT context
-    lt::setLogCallback(
-        [](const std::string & message) { Logger::debug(message); });
+    lt::setLogCallback([](lt::LogLevel level, const std::string & message) {
+        if (level == lt::LogLevel::Warning)
+            Logger::warning(message);
+        else
+            Logger::debug(message);
+    });
 
     // intolib rewrite
 
@@ -99,9 +104,16 @@ LibreTuner::LibreTuner(int & argc, char * argv[])
     }
 
     catchCritical(
-        [&]() { platforms_.loadDirectory(definitionPath); },
+        [&]() {
+            platforms_.loadDirectory(definitionPath,
+                                     rootPath_ / "cache" / "definitions.cache");
+        },
         "Error loading definitions");
 
+    // Shared by every project, so identical ROMs are stored once
+    if (QSettings().value("romstore/enabled", true).toBool())
+        romStore_ = std::make_shared<lt::RomStore>(romStorePath());
+
     links_.setPath(rootPath_ / "links.lts");
 
     // Load links
@@ -209,6 +221,35 @@ lt::PlatformLink LibreTuner::platformLink() const
     return lt::PlatformLink(*currentDatalink_, *currentPlatform_);
 }
 
+fs::path LibreTuner::romStorePath() const
+{
+    QString path = QSettings().value("romstore/path").toString();
+    if (path.isEmpty())
+        return rootPath_ / "store";
+    return path.toStdString();
+}
+
+void LibreTuner::setRomStore(bool enabled, const fs::path & path)
+{
+    QSettings settings;
+    settings.setValue("romstore/enabled", enabled);
+    settings.setValue("romstore/path", QString::fromStdString(path.string()));
+
+    if (!enabled)
+        romStore_.reset();
+    else if (!romStore_ || romStore_->directory() != path)
+        romStore_ = std::make_shared<lt::RomStore>(path);
+
+    for (int row = 0; row < projects_.rowCount(QModelIndex()); ++row)
+    {
+        auto project = projects_.index(row, 0, QModelIndex())
+                           .data(Qt::UserRole)
+                           .value<lt::ProjectPtr>();
+        if (project)
+            project->setRomStore(romStore_);
+    }
+}
+
 lt::ProjectPtr LibreTuner::openProject(const std::filesystem::path & path)
 {
     // Check if the project is already open
@@ -220,6 +261,7 @@ lt::ProjectPtr LibreTuner::openProject(const std::filesystem::path & path)
     }
 
     auto project = std::make_shared<lt::Project>(path, platforms_);
+    project->setRomStore(romStore_);
     bool success = false;
     catchCritical(
         [&]() {
@@ -238,6 +280,7 @@ lt::ProjectPtr LibreTuner::createProject(const std::filesystem::path & path,
                                          const std::string & name)
 {
     auto project = std::make_shared<lt::Project>(path, platforms_);
+    project->setRomStore(romStore_);
     project->makeDirectories();
     project->setName(name);
     project->save();
@@ -77,6 +77,20 @@ public:
     /* Creates a new project at path `path`. */
     lt::ProjectPtr createProject(const std::filesystem::path & path, const std::string & name);
 
+    /* Returns the ROM store shared by all projects, or nullptr if it is
+     * disabled */
+    inline const lt::RomStorePtr & romStore() const noexcept
+    {
+        return romStore_;
+    }
+
+    // Directory of the ROM store, whether or not it is enabled
+    std::filesystem::path romStorePath() const;
+
+    /* Sets the ROM store of all projects and saves it in the settings.
+     * Without a store, ROM images are saved in the ROM files. */
+    void setRomStore(bool enabled, const std::filesystem::path & path);
+
     /* Returns the current platform or nullptr if none is selected */
     lt::PlatformPtr platform() const { return currentPlatform_; }
     void setPlatform(lt::PlatformPtr platform);
@@ -91,6 +105,7 @@ private:
     std::filesystem::path rootPath_;
     lt::Platforms platforms_;
     Projects projects_;
+    lt::RomStorePtr romStore_;
 
     Links links_;
 
@@ -39,8 +39,11 @@ QVariant TableModel::data(const QModelIndex & index, int role) const
     if (index.row() < 0 || index.row() >= table_->height() || index.column() < 0 || index.column() >= table_->width())
         return QVariant();
 
+    // Decoded once per edit instead of once per cell and role
+    double value = table_->values()[index.row() * table_->width() + index.column()];
+
     if (role == Qt::DisplayRole)
-        return table_->get(index.row(), index.column());
+        return value;
 
     if (role == Qt::ForegroundRole)
     {
@@ -58,7 +61,7 @@ QVariant TableModel::data(const QModelIndex & index, int role) const
         double diff = table_->maximum() - table_->minimum();
         if (diff == 0.0)
             return QColor::fromHsvF((1.0 / 3.0), 1.0, 1.0);
-        double ratio = static_cast<double>(table_->get(index.row(), index.column()) - table_->minimum()) / diff;
+        double ratio = (value - table_->minimum()) / diff;
         ratio = std::clamp(ratio, 0.0, 1.0);
         return QColor::fromHsvF((1.0 - ratio) * (1.0 / 3.0), 1.0, 1.0);
     }
@@ -18,6 +18,9 @@
 
 #include "dataloggerwindow.h"
 
+#include <QDateTime>
+#include <QFileDialog>
+#include <QFormLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
@@ -31,11 +34,27 @@
 
 #include "backgroundtask.h"
 #include "libretuner.h"
+#include "lt/datalog/datalogfile.h"
 #include "lt/datalog/datalogger.h"
 #include "lt/definition/platform.h"
 #include "lt/link/datalink.h"
 #include "widget/datalogliveview.h"
 #include "widget/datalogview.h"
+#include "widget/projectcombo.h"
+
+#include <fstream>
+
+namespace
+{
+// Returns an unused path for a log started now
+std::filesystem::path newLogPath(lt::Project & project)
+{
+    project.makeDirectories();
+    return project.generateLogPath(
+        "datalog_" +
+        QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss").toStdString());
+}
+} // namespace
 
 DataLoggerWindow::DataLoggerWindow(QWidget * parent)
     : QWidget(parent), log_(std::make_shared<lt::DataLog>())
@@ -46,6 +65,8 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
 
     QLabel * pidLabel = new QLabel("Available PIDs");
 
+    comboProject_ = new ProjectCombo;
+
     pidList_ = new QListWidget;
     pidList_->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
 
@@ -60,6 +81,7 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
 
     buttonLog_ = new QPushButton(tr("Start logging"));
     auto * buttonSave = new QPushButton(tr("Save log"));
+    auto * buttonOpen = new QPushButton(tr("Open log"));
 
     auto * buttonSimulate = new QPushButton(tr("Simulate"));
 
@@ -71,10 +93,16 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
     auto * logLayout = new QVBoxLayout;
     logLayout->addWidget(splitter);
     logLayout->addWidget(buttonLog_);
+    logLayout->addWidget(buttonSave);
+    logLayout->addWidget(buttonOpen);
     logLayout->addWidget(buttonSimulate);
 
+    auto * form = new QFormLayout;
+    form->addRow(tr("Save logs to"), comboProject_);
+
     // PIDs layout
     auto * pidLayout = new QVBoxLayout;
+    pidLayout->addLayout(form);
     pidLayout->addWidget(pidLabel);
     pidLayout->addWidget(pidList_);
 
@@ -90,6 +118,8 @@ DataLoggerWindow::DataLoggerWindow(QWidget * parent)
             &DataLoggerWindow::toggleLogger);
     connect(buttonSave, &QPushButton::clicked, this,
             &DataLoggerWindow::saveLog);
+    connect(buttonOpen, &QPushButton::clicked, this,
+            &DataLoggerWindow::openLog);
     connect(buttonSimulate, &QPushButton::clicked, [this]() { simulate(); });
     reset();
 }
@@ -130,7 +160,85 @@ void DataLoggerWindow::closeEvent(QCloseEvent * event)
     }
 }
 
-void DataLoggerWindow::saveLog() {}
+void DataLoggerWindow::saveLog()
+{
+    if (logger_)
+    {
+        QMessageBox::warning(this, tr("Save log"),
+                             tr("Stop the data logger before saving the log"));
+        return;
+    }
+
+    try
+    {
+        if (logPath_.empty())
+        {
+            lt::ProjectPtr project = comboProject_->selectedProject();
+            if (!project)
+            {
+                QMessageBox::warning(this, tr("Save log"),
+                                     tr("Select a project to save the log to"));
+                return;
+            }
+            std::filesystem::path path = newLogPath(*project);
+            lt::saveDataLog(*log_, path);
+            logPath_ = path;
+        }
+
+        QString csvPath = QFileDialog::getSaveFileName(
+            this, tr("Export log"), QString(), tr("CSV files (*.csv)"));
+        if (csvPath.isEmpty())
+            return;
+
+        lt::DataLogReader reader(logPath_);
+        std::ofstream csv(csvPath.toStdString());
+        if (!csv.is_open())
+            throw std::runtime_error("failed to open '" +
+                                     csvPath.toStdString() + "'");
+        lt::exportCsv(reader, csv);
+    }
+    catch (const std::runtime_error & error)
+    {
+        QMessageBox::critical(this, tr("Save log"), error.what());
+    }
+}
+
+void DataLoggerWindow::openLog()
+{
+    if (logger_)
+    {
+        QMessageBox::warning(this, tr("Open log"),
+                             tr("Stop the data logger before opening a log"));
+        return;
+    }
+
+    QString directory;
+    if (lt::ProjectPtr project = comboProject_->selectedProject())
+        directory = QString::fromStdString(project->logsDirectory().string());
+
+    QString path = QFileDialog::getOpenFileName(
+        this, tr("Open log"), directory,
+        tr("Datalog files (*%1)").arg(lt::DataLog::extension));
+    if (path.isEmpty())
+        return;
+
+    try
+    {
+        lt::DataLogReader reader(path.toStdString());
+        if (!reader.complete())
+            Logger::warning("Datalog '" + path.toStdString() +
+                            "' was not closed; recovered what was written");
+
+        log_ = reader.load();
+        logPath_ = path.toStdString();
+        dataLogView_->setDataLog(log_);
+        dataLogLiveView_->setDataLog(log_);
+    }
+    catch (const std::runtime_error & error)
+    {
+        QMessageBox::critical(this, tr("Open log"), error.what());
+    }
+}
 
 void DataLoggerWindow::simulate()
 {
@@ -138,6 +246,8 @@ void DataLoggerWindow::simulate()
     pid.name = "Test";
     pid.code = 0;
     log_->addPid(pid);
+    // The simulated entries are not in the saved file
+    logPath_.clear();
 
     /*QTimer timer(this);
     timer.setInterval(1);
@@ -191,6 +301,8 @@ void DataLoggerWindow::toggleLogger()
             }
         }
 
+        startRecording();
+
         BackgroundTask<void()> task([&]() { logger_->run(); });
 
         buttonLog_->setText(tr("Stop logging"));
@@ -200,14 +312,53 @@ void DataLoggerWindow::toggleLogger()
         task.future().get();
 
         logger_.reset();
+        stopRecording();
         buttonLog_->setText(tr("Start logging"));
     }
     catch (const std::runtime_error & error)
     {
+        logger_.reset();
+        try
+        {
+            stopRecording();
+        }
+        catch (const std::runtime_error &)
+        {
+            // Report the first error only
+        }
+        buttonLog_->setText(tr("Start logging"));
         QMessageBox::critical(this, "Datalog error", error.what());
     }
 }
 
+void DataLoggerWindow::startRecording()
+{
+    lt::ProjectPtr project = comboProject_->selectedProject();
+    if (!project)
+        return;
+
+    writer_ = std::make_unique<lt::DataLogWriter>(newLogPath(*project),
+                                                  log_->name());
+
+    // Called on the logger thread; the writer is thread-safe
+    lt::DataLogWriter * writer = writer_.get();
+    writerConnection_ = log_->onAdd(
+        [writer](const lt::PidLog & log, const lt::PidLogEntry & entry) {
+            writer->add(log.pid, entry);
+        });
+}
+
+void DataLoggerWindow::stopRecording()
+{
+    writerConnection_.reset();
+    if (!writer_)
+        return;
+
+    std::unique_ptr<lt::DataLogWriter> writer = std::move(writer_);
+    writer->close();
+    logPath_ = writer->path();
+}
+
 void DataLoggerWindow::reset()
 {
     pidList_->clear();
@@ -239,6 +390,7 @@ void DataLoggerWindow::reset()
 void DataLoggerWindow::resetLog()
 {
     log_ = std::make_shared<lt::DataLog>();
+    logPath_.clear();
 
     dataLogView_->setDataLog(log_);
     dataLogLiveView_->setDataLog(log_);
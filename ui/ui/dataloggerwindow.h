@@ -23,6 +23,7 @@
 #include <QTreeWidget>
 #include <QWidget>
 
+#include <filesystem>
 #include <memory>
 #include <unordered_map>
 
@@ -32,6 +33,7 @@ namespace lt
 {
 class DataLogger;
 using DataLoggerPtr = std::unique_ptr<DataLogger>;
+class DataLogWriter;
 } // namespace lt
 
 class QListWidget;
@@ -39,6 +41,7 @@ class QTreeWidgetItem;
 class QListWidgetItem;
 class DataLogView;
 class DataLogLiveView;
+class ProjectCombo;
 
 class DataLoggerWindow : public QWidget
 {
@@ -62,12 +65,23 @@ signals:
 public slots:
     /* Callback for the start/stop button */
     void toggleLogger();
+    /* Saves the log to the selected project if it was not recorded there,
+     * then asks where to export it as CSV */
     void saveLog();
+    // Asks for a saved log file and shows it
+    void openLog();
 
 private:
     lt::DataLogPtr log_;
     lt::DataLoggerPtr logger_;
 
+    // Writes log_ to the selected project while logging
+    std::unique_ptr<lt::DataLogWriter> writer_;
+    lt::DataLog::AddConnectionPtr writerConnection_;
+    // File holding log_. Empty if it has not been saved.
+    std::filesystem::path logPath_;
+
+    ProjectCombo * comboProject_;
     QListWidget * pidList_;
     QPushButton * buttonLog_;
     DataLogView * dataLogView_;
@@ -76,6 +90,12 @@ private:
     std::vector<QListWidgetItem *> pidItems_;
 
     void reset();
+
+    /* Starts writing new entries of log_ to a file in the selected
+     * project. Does nothing if no project is selected. */
+    void startRecording();
+    // Closes the file started by startRecording()
+    void stopRecording();
 };
 
 #endif // DATALOGGERWINDOW_H
@@ -87,9 +87,9 @@ SidebarWidget::SidebarWidget(QWidget * parent) : QWidget(parent)
     fillTableInfo(nullptr);
 }
 
-void SidebarWidget::fillTableInfo(const lt::TableDefinition * table)
+void SidebarWidget::fillTableInfo(const lt::ModelTable * placed)
 {
-    if (table == nullptr)
+    if (placed == nullptr)
     {
         tableName_->setText("N/A");
         tableOffset_->setText("N/A");
@@ -102,9 +102,10 @@ void SidebarWidget::fillTableInfo(const lt::TableDefinition * table)
         return;
     }
 
+    const lt::TableDefinition * table = placed->definition;
     tableName_->setText(QString::fromStdString(table->name));
     tableOffset_->setText(QString("0x") +
-                          QString::number(table->offset.value(), 16));
+                          QString::number(placed->offset, 16));
     tableWidth_->setText(QString::number(table->width));
     tableHeight_->setText(QString::number(table->height));
     tableRange_->setText(
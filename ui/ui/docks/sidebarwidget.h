@@ -5,7 +5,7 @@
 
 namespace lt
 {
-struct TableDefinition;
+struct ModelTable;
 }
 
 class QLabel;
@@ -19,7 +19,7 @@ public:
     explicit SidebarWidget(QWidget * parent = nullptr);
 
 public slots:
-    void fillTableInfo(const lt::TableDefinition * table);
+    void fillTableInfo(const lt::ModelTable * table);
 
 private slots:
     void on_treeToolButton_clicked(bool checked);
@@ -19,7 +19,7 @@ TablesWidget::TablesWidget(QWidget * parent) : QWidget(parent)
     connect(view_, &QTreeWidget::itemActivated,
             [this](const QTreeWidgetItem * item, int /*column*/) {
                 emit activated(item->data(0, Qt::UserRole)
-                                   .value<const lt::TableDefinition *>());
+                                   .value<const lt::ModelTable *>());
             });
 }
 
@@ -28,23 +28,26 @@ void TablesWidget::setModel(const lt::Model & model)
     view_->clear();
     std::vector<std::pair<std::string, QTreeWidgetItem *>> categories_;
 
-    std::vector<std::reference_wrapper<const lt::TableDefinition>> defs;
+    std::vector<std::reference_wrapper<const lt::ModelTable>> defs;
     for (const auto & [id, table] : model.tables)
     {
         defs.emplace_back(std::cref(table));
     }
-    std::sort(defs.begin(), defs.end(), [](const lt::TableDefinition &first, const lt::TableDefinition &second)
+    std::sort(defs.begin(), defs.end(), [](const lt::ModelTable &firstTable, const lt::ModelTable &secondTable)
     {
+        const lt::TableDefinition &first = *firstTable.definition;
+        const lt::TableDefinition &second = *secondTable.definition;
         return (first.category != second.category) ? (first.category < second.category) : first.name < second.name;
     });
 
-    for (const auto & table : defs)
+    for (const auto & placed : defs)
     {
+        const lt::TableDefinition & table = *placed.get().definition;
         QTreeWidgetItem * par = nullptr;
 
         for (auto & cat : categories_)
         {
-            if (cat.first == table.get().category)
+            if (cat.first == table.category)
             {
                 par = cat.second;
                 break;
@@ -54,14 +57,14 @@ void TablesWidget::setModel(const lt::Model & model)
         if (par == nullptr)
         {
             par = new QTreeWidgetItem(view_);
-            par->setText(0, QString::fromStdString(table.get().category));
+            par->setText(0, QString::fromStdString(table.category));
             par->setData(0, Qt::UserRole, QVariant(-1));
 
-            categories_.emplace_back(table.get().category, par);
+            categories_.emplace_back(table.category, par);
         }
 
         auto * item = new QTreeWidgetItem(par);
-        item->setText(0, QString::fromStdString(table.get().name));
-        item->setData(0, Qt::UserRole, QVariant::fromValue(&table.get()));
+        item->setText(0, QString::fromStdString(table.name));
+        item->setData(0, Qt::UserRole, QVariant::fromValue(&placed.get()));
     }
 }
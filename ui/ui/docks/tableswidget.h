@@ -18,7 +18,7 @@ public:
     explicit TablesWidget(QWidget * parent = nullptr);
 
 signals:
-    void activated(const lt::TableDefinition * table);
+    void activated(const lt::ModelTable * table);
 
 public slots:
     void setModel(const lt::Model & model);
@@ -27,6 +27,6 @@ private:
     QTreeWidget * view_;
 };
 
-Q_DECLARE_METATYPE(const lt::TableDefinition *)
+Q_DECLARE_METATYPE(const lt::ModelTable *)
 
 #endif // TABLESWIDGET_H
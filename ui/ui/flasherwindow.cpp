@@ -23,10 +23,14 @@
 #include "fileselectwidget.h"
 #include "libretuner.h"
 #include "logger.h"
+#include "lt/flash/flashmap.h"
 #include "lt/link/platformlink.h"
+#include "lt/rom/rom.h"
 #include "uiutil.h"
 
 #include <cassert>
+#include <stdexcept>
+#include <vector>
 
 #include <QComboBox>
 #include <QFormLayout>
@@ -38,6 +42,24 @@
 #include <QStyledItemDelegate>
 #include <QVBoxLayout>
 
+namespace
+{
+/* Returns a map of the erase sectors whose CRCs differ from those the ECU
+ * reports if the flasher can erase sectors on their own, otherwise a map
+ * of the whole flash region. The ECU is asked since it may not hold the
+ * tune's base ROM. */
+lt::FlashMap createFlashMap(lt::Tune & tune, const lt::Platform & platform,
+                            lt::Flasher & flasher)
+{
+    std::vector<lt::FlashRange> sectors = lt::FlashMap::sectors(platform);
+    if (!flasher.supportsPartial() || sectors.empty())
+        return lt::FlashMap::fromTune(tune);
+
+    std::vector<uint32_t> crcs = flasher.sectorCrcs(sectors);
+    return lt::FlashMap::deltaFromTune(tune, crcs);
+}
+} // namespace
+
 FlasherWindow::FlasherWindow(QWidget * parent)
     : QDialog(parent), linksList_(LT()->links())
 {
@@ -153,7 +175,12 @@ void FlasherWindow::buttonFlashClicked()
 
             // Create task
             BackgroundTask<bool()> task([&]() {
-                return flasher->flash(lt::FlashMap::fromTune(*selectedTune_));
+                lt::FlashMap map =
+                    createFlashMap(*selectedTune_, *platform, *flasher);
+                // The ECU already holds the tune
+                if (map.empty())
+                    return true;
+                return flasher->flash(map);
             });
 
             bool canceled = false;
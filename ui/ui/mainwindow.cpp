@@ -46,6 +46,7 @@
 #include <QAction>
 #include <QDockWidget>
 #include <QFileDialog>
+#include <QLabel>
 #include <QListView>
 #include <QMdiArea>
 #include <QMenu>
@@ -206,10 +207,18 @@ void MainWindow::setTune(const lt::TunePtr & tune)
     }
 
     tune_ = tune;
+    historyConnection_.reset();
+    if (tune_)
+        historyConnection_ = tune_->onHistoryChange([this]() {
+            updateEditActions();
+            updateChecksumStatus();
+        });
     emit tuneChanged(tune_.get());
 
     flashCurrentAction_->setEnabled(!!tune);
     saveCurrentAction_->setEnabled(!!tune);
+    updateEditActions();
+    updateChecksumStatus();
 
     if (tune)
         setWindowTitle(tr("LibreTuner") + " - " + QString::fromStdString(tune->name()));
@@ -283,15 +292,16 @@ QDockWidget * MainWindow::createSidebarDock()
     return dock;
 }
 
-void MainWindow::setTable(const lt::TableDefinition * table)
+void MainWindow::setTable(const lt::ModelTable * placed)
 {
-    if (table == nullptr)
+    if (placed == nullptr)
     {
         // Don't change
         return;
     }
 
-    sidebar_->fillTableInfo(table);
+    sidebar_->fillTableInfo(placed);
+    const lt::TableDefinition * table = placed->definition;
 
     if (auto it = views_.find(table->id); it != views_.end())
     {
@@ -334,6 +344,45 @@ void MainWindow::setTable(const lt::TableDefinition * table)
         tr("Error creating table"));
 }
 
+void MainWindow::refreshViews()
+{
+    if (!tune_)
+        return;
+
+    for (auto & [id, view] : views_)
+    {
+        if (!view)
+            continue;
+
+        lt::Table * table = tune_->getTable(id, false);
+        if (auto * tableView = dynamic_cast<TableView *>(view.data()))
+            tableView->setTable(table);
+        else if (auto * scalarView = dynamic_cast<ScalarView *>(view.data()))
+            scalarView->setTable(table);
+    }
+}
+
+void MainWindow::updateEditActions()
+{
+    undoAction_->setEnabled(tune_ && tune_->canUndo());
+    redoAction_->setEnabled(tune_ && tune_->canRedo());
+}
+
+void MainWindow::updateChecksumStatus()
+{
+    if (!tune_)
+    {
+        labelChecksums_->clear();
+        return;
+    }
+
+    // Only the pages written since the last call are summed again
+    if (tune_->checksumsOk())
+        labelChecksums_->setText(tr("Checksums OK"));
+    else
+        labelChecksums_->setText(tr("Checksums will be corrected when flashing"));
+}
+
 QDockWidget * MainWindow::createTablesDock()
 {
     QDockWidget * dock = new QDockWidget("Tables", this);
@@ -407,6 +456,23 @@ void MainWindow::setupMenu()
     flashCurrentAction_->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_F));
     flashCurrentAction_->setEnabled(false);
 
+    // Edit menu
+    undoAction_ = editMenu->addAction(tr("&Undo"));
+    undoAction_->setShortcut(QKeySequence::Undo);
+    undoAction_->setEnabled(false);
+    connect(undoAction_, &QAction::triggered, [this]() {
+        if (tune_ && tune_->undo())
+            refreshViews();
+    });
+
+    redoAction_ = editMenu->addAction(tr("&Redo"));
+    redoAction_->setShortcut(QKeySequence::Redo);
+    redoAction_->setEnabled(false);
+    connect(redoAction_, &QAction::triggered, [this]() {
+        if (tune_ && tune_->redo())
+            refreshViews();
+    });
+
     // View menu
     auto * openPlatformsAction = viewMenu->addAction(tr("Platforms"));
     connect(openPlatformsAction, &QAction::triggered, [this]() {
@@ -492,6 +558,21 @@ void MainWindow::setupMenu()
     QAction * datalinksAction = toolsMenu->addAction(tr("Setup &Datalinks"));
     connect(datalinksAction, &QAction::triggered, [this]() { datalinksWindow_.show(); });
 
+    // Identical ROM images of all projects are kept once in the store
+    QAction * romStoreAction = toolsMenu->addAction(tr("Share ROM Images"));
+    romStoreAction->setCheckable(true);
+    romStoreAction->setChecked(LT()->romStore() != nullptr);
+    connect(romStoreAction, &QAction::toggled,
+            [](bool enabled) { LT()->setRomStore(enabled, LT()->romStorePath()); });
+
+    QAction * romStorePathAction = toolsMenu->addAction(tr("ROM Store Location..."));
+    connect(romStorePathAction, &QAction::triggered, [this, romStoreAction]() {
+        QString path = QFileDialog::getExistingDirectory(this, tr("ROM Store Location"),
+                                                         QString::fromStdString(LT()->romStorePath().string()));
+        if (!path.isEmpty())
+            LT()->setRomStore(romStoreAction->isChecked(), path.toStdString());
+    });
+
     auto * sessionScanAct = toolsMenu->addAction(tr("Session Scanner"));
     connect(sessionScanAct, &QAction::triggered, [this]() {
         SessionScannerDialog scanner;
@@ -539,6 +620,8 @@ void MainWindow::setupStatusBar()
         comboDatalink_->setCurrentText(QString::fromStdString(LT()->datalink()->name()));
     }
 
+    labelChecksums_ = new QLabel;
+    statusBar()->addPermanentWidget(labelChecksums_);
     statusBar()->addPermanentWidget(comboPlatform);
     statusBar()->addPermanentWidget(comboDatalink_);
 }
@@ -32,6 +32,7 @@
 #include "models/tablemodel.h"
 #include "ui/windows/diagnosticswidget.h"
 
+class QLabel;
 class QListView;
 class QMdiArea;
 
@@ -48,7 +49,7 @@ namespace lt
 {
 class Tune;
 using TunePtr = std::shared_ptr<Tune>;
-struct TableDefinition;
+struct ModelTable;
 } // namespace lt
 
 class MainWindow : public QMainWindow
@@ -66,7 +67,7 @@ public:
     void addRecent(const QString & path);
 
 public slots:
-    void setTable(const lt::TableDefinition * modTable);
+    void setTable(const lt::ModelTable * modTable);
     void openCreateTune();
 
 private slots:
@@ -87,6 +88,7 @@ private:
 
     QComboBox * comboLogVehicles_;
     QComboBox * comboDatalink_;
+    QLabel * labelChecksums_;
     QListView * listLogs_;
     SidebarWidget * sidebar_;
     QMenu * recentMenu_;
@@ -96,6 +98,8 @@ private:
 
     QAction * flashCurrentAction_;
     QAction * saveCurrentAction_;
+    QAction * undoAction_;
+    QAction * redoAction_;
 
     // Docks
     QDockWidget * logDock_;
@@ -118,6 +122,15 @@ private:
 
     void setTune(const lt::TunePtr & tune);
 
+    // Reloads the open table views after the tune changed underneath them
+    void refreshViews();
+
+    // Enables undo and redo to match the tune's history
+    void updateEditActions();
+
+    // Shows whether the tune's checksums match in the status bar
+    void updateChecksumStatus();
+
     QDockWidget * createOverviewDock();
     QDockWidget * createLoggingDock();
     QDockWidget * createLogDock();
@@ -128,6 +141,7 @@ private:
     std::vector<QDockWidget *> docks_;
 
     lt::TunePtr tune_;
+    lt::Event<>::ConnectionPtr historyConnection_;
 
     LinksListModel linksList_;
 
@@ -68,10 +68,11 @@ QCPGraph * DataLogView::getOrCreateGraph(const lt::Pid & pid) noexcept
 void DataLogView::onAdded(const lt::PidLog & log,
                           const lt::PidLogEntry & entry) noexcept
 {
+    // Only the PID is copied; the log itself may hold millions of entries
     QMetaObject::invokeMethod(
         this,
-        [this, log, entry] {
-            QCPGraph * graph = getOrCreateGraph(log.pid);
+        [this, pid = log.pid, entry] {
+            QCPGraph * graph = getOrCreateGraph(pid);
             graph->addData(static_cast<double>(entry.time) / 1000.0,
                            entry.value);
 
@@ -29,6 +29,7 @@
 
 #include "ui/authoptionsview.h"
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QFileDialog>
 #include <QFormLayout>
@@ -42,8 +43,11 @@
 #include <QVBoxLayout>
 
 #include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "../widget/projectcombo.h"
 
@@ -60,11 +64,16 @@ DownloadWindow::DownloadWindow(lt::ProjectPtr project, QWidget * parent) : QDial
 
     lineName_ = new QLineEdit;
 
+    checkCalibration_ = new QCheckBox(tr("Calibration only"));
+    checkCalibration_->setToolTip(tr("Downloads the tables and identifiers only. The result "
+                                     "is saved as a binary file, not as a ROM."));
+
     // Main options
     auto * form = new QFormLayout;
     form->addRow(tr("Project"), comboProject_);
     form->addRow(tr("Platform"), comboPlatform_);
     form->addRow(tr("Name"), lineName_);
+    form->addRow(checkCalibration_);
 
     auto * groupDetails = new QGroupBox(tr("ROM Details"));
     groupDetails->setLayout(form);
@@ -135,6 +144,7 @@ void DownloadWindow::download()
     catchCritical(
         [&]() {
             lt::PlatformLink pLink = getPlatformLink();
+            const bool calibrationOnly = checkCalibration_->isChecked();
 
             // Create progress dialog
             QProgressDialog progress(tr("Downloading ROM..."), tr("Abort"), 0, 100, this);
@@ -143,10 +153,25 @@ void DownloadWindow::download()
             progress.setValue(0);
             progress.show();
 
-            lt::download::DownloaderPtr downloader = pLink.downloader();
+            // Progress is kept in the project so a dropped link does not
+            // restart the download from the beginning. The downloader only
+            // resumes it for the ECU that it came from.
+            std::filesystem::create_directories(project->downloadsDirectory());
+            std::vector<lt::download::AddressRange> ranges;
+            if (calibrationOnly)
+                ranges = lt::download::calibrationRanges(pLink.platform());
+            lt::download::DownloaderPtr downloader = pLink.downloader(
+                project->downloadsDirectory() / (pLink.platform().id + ".partial"), std::move(ranges));
             downloader->setProgressCallback([&](float prog) {
                 QMetaObject::invokeMethod(&progress, "setValue", Qt::QueuedConnection, Q_ARG(int, prog * 100));
             });
+            downloader->setStatsCallback([&](const lt::download::DownloadStats & stats) {
+                QString label = tr("Downloading ROM... (%1 KiB/s, %2 ms per request)")
+                                    .arg(stats.bytesPerSecond() / 1024.0, 0, 'f', 1)
+                                    .arg(std::chrono::duration<double, std::milli>(stats.averageLatency()).count(), 0,
+                                         'f', 1);
+                QMetaObject::invokeMethod(&progress, "setLabelText", Qt::QueuedConnection, Q_ARG(QString, label));
+            });
 
             BackgroundTask<bool()> task([&]() -> bool { return downloader->download(); });
 
@@ -165,6 +190,21 @@ void DownloadWindow::download()
             if (!success)
                 throw std::runtime_error("Unknown error");
             auto data = downloader->data();
+            if (calibrationOnly)
+            {
+                // The rest of the image is zero, so it is no ROM or flash base
+                QString fileName = QFileDialog::getSaveFileName(this, tr("Save calibration"), "",
+                                                                tr("Binary (*.bin);;All Files (*)"));
+                if (fileName.isEmpty())
+                    return;
+
+                QFile file(fileName);
+                if (!file.open(QIODevice::WriteOnly) ||
+                    file.write(reinterpret_cast<const char *>(data.first), static_cast<qint64>(data.second)) !=
+                        static_cast<qint64>(data.second))
+                    throw std::runtime_error("failed to write '" + fileName.toStdString() + "'");
+                return;
+            }
             try
             {
                 lt::ModelPtr model = pLink.platform().identify(data.first, data.second);
@@ -26,6 +26,7 @@
 
 #include "lt/link/platformlink.h"
 
+class QCheckBox;
 class QLineEdit;
 class QComboBox;
 class AuthOptionsView;
@@ -58,6 +59,8 @@ private:
     QComboBox * comboPlatform_;
     ProjectCombo * comboProject_;
     QLineEdit * lineName_;
+    // Downloads only calibrationRanges() and saves a binary, not a ROM
+    QCheckBox * checkCalibration_;
     AuthOptionsView * authOptions_;
 
     lt::PlatformLink getPlatformLink();
@@ -89,11 +89,11 @@ ImportRomDialog::ImportRomDialog(lt::ProjectPtr project, QWidget * parent)
         platformChanged(comboPlatform_->currentIndex());
 
     connect(buttonImport, &QPushButton::clicked, [this]() {
+        // Without a selected platform, every platform is tried
         QVariant var = comboPlatform_->currentData(Qt::UserRole);
-        if (!var.canConvert<lt::PlatformPtr>())
-            return;
-
-        auto platform = var.value<lt::PlatformPtr>();
+        lt::PlatformPtr platform;
+        if (var.canConvert<lt::PlatformPtr>())
+            platform = var.value<lt::PlatformPtr>();
 
         catchWarning(
             [&]() {